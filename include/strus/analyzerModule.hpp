@@ -114,6 +114,17 @@ struct AnalyzerModule
 		const NormalizerConstructor* normalizerConstructors_,
 		const AggregatorConstructor* aggregatorConstructors_);
 
+	/// \brief Analyzer module constructor without segmenter definition declaring flags of the module
+	/// \param[in] tokenizerConstructors_ (0,0) terminated list of tokenizers or 0
+	/// \param[in] normalizerConstructors_ (0,0) terminated list of normalizers or 0
+	/// \param[in] aggregatorConstructors_ (0,0) terminated list of statistic functions or 0
+	/// \param[in] flags_ set of ModuleEntryPoint::Flag values, e.g. ModuleEntryPoint::FlagSortedConstructorTables for lists declared with STRUS_CONSTRUCTOR_TABLE_CHECK
+	AnalyzerModule(
+		const TokenizerConstructor* tokenizerConstructors_,
+		const NormalizerConstructor* normalizerConstructors_,
+		const AggregatorConstructor* aggregatorConstructors_,
+		unsigned int flags_);
+
 	/// \brief Analyzer module constructor for pattern matcher
 	AnalyzerModule(
 		const PatternLexerConstructor& patternLexerConstructor_,
@@ -0,0 +1,94 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Declaration of constructor tables of modules sorted by name and validated at compile time
+/// \file constructorTable.hpp
+#ifndef _STRUS_MODULE_CONSTRUCTOR_TABLE_HPP_INCLUDED
+#define _STRUS_MODULE_CONSTRUCTOR_TABLE_HPP_INCLUDED
+#include <cstddef>
+
+/// \brief Qualifier for declaring a constructor table that can be validated at compile time
+/// \note Usage: static STRUS_CONSTRUCTOR_TABLE strus::NormalizerConstructor normalizers[] = {{"lc",&createLc},{"stem",&createStem},{0,0}};
+#if __cplusplus >= 201103L
+#define STRUS_CONSTRUCTOR_TABLE constexpr
+#else
+#define STRUS_CONSTRUCTOR_TABLE const
+#endif
+
+#if __cplusplus >= 201103L
+/// \brief strus toplevel namespace
+namespace strus {
+/// \brief Compile time functions for validating constructor tables
+namespace constructorTable {
+
+/// \brief Test if a name contains no upper case ASCII character
+constexpr bool isLowerCase( const char* name)
+{
+	return *name == '\0' || ((*name < 'A' || *name > 'Z') && isLowerCase( name+1));
+}
+
+/// \brief Compare two names byte by byte like std::strcmp
+constexpr int compare( const char* aa, const char* bb)
+{
+	return (*aa != *bb || *aa == '\0') ? ((int)(unsigned char)*aa - (int)(unsigned char)*bb) : compare( aa+1, bb+1);
+}
+
+/// \brief Test if a table is terminated by an element with name==0 and create==0 and has no such element before
+template <typename Constructor, std::size_t N>
+constexpr bool isTerminated( const Constructor (&ar)[N], std::size_t idx=0)
+{
+	return idx+1 == N
+		? (ar[ idx].name == 0 && ar[ idx].create == 0)
+		: (ar[ idx].name != 0 && ar[ idx].create != 0 && isTerminated( ar, idx+1));
+}
+
+/// \brief Test if all names of a table are in lower case
+template <typename Constructor, std::size_t N>
+constexpr bool hasLowerCaseNames( const Constructor (&ar)[N], std::size_t idx=0)
+{
+	return idx+1 >= N || (isLowerCase( ar[ idx].name) && hasLowerCaseNames( ar, idx+1));
+}
+
+/// \brief Test if a table sorted by name has no name defined twice
+template <typename Constructor, std::size_t N>
+constexpr bool hasUniqueNames( const Constructor (&ar)[N], std::size_t idx=0)
+{
+	return idx+2 >= N || (compare( ar[ idx].name, ar[ idx+1].name) != 0 && hasUniqueNames( ar, idx+1));
+}
+
+/// \brief Test if the names of a table are in ascending order
+template <typename Constructor, std::size_t N>
+constexpr bool isSorted( const Constructor (&ar)[N], std::size_t idx=0)
+{
+	return idx+2 >= N || (compare( ar[ idx].name, ar[ idx+1].name) <= 0 && isSorted( ar, idx+1));
+}
+
+/// \brief Get the number of constructors of a table without the terminating element
+template <typename Constructor, std::size_t N>
+constexpr std::size_t size( const Constructor (&)[N])
+{
+	return N-1;
+}
+
+}}//namespace
+
+/// \brief Validate a constructor table declared with STRUS_CONSTRUCTOR_TABLE at compile time
+/// \note A module declaring all its tables validated can pass ModuleEntryPoint::FlagSortedConstructorTables to the constructor of its entry point.
+///		The loader then looks up names by binary search in the tables of the module instead of copying them into a map when registering the module.
+/// \remark Without C++11 the validation is done by the loader when registering a table, a table not sorted is registered by name as without the flag
+#define STRUS_CONSTRUCTOR_TABLE_CHECK( TABLE)\
+	static_assert( strus::constructorTable::isTerminated( TABLE), "constructor table " #TABLE " is not terminated by {0,0} or has an element with NULL name or constructor");\
+	static_assert( strus::constructorTable::hasLowerCaseNames( TABLE), "constructor table " #TABLE " has names not in lower case");\
+	static_assert( strus::constructorTable::isSorted( TABLE), "constructor table " #TABLE " is not sorted by name");\
+	static_assert( strus::constructorTable::hasUniqueNames( TABLE), "constructor table " #TABLE " has duplicate names")
+#else
+#define STRUS_CONSTRUCTOR_TABLE_CHECK( TABLE)\
+	typedef int strus_constructorTableCheck_ ## TABLE
+#endif
+
+#endif
+
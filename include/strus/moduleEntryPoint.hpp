@@ -36,6 +36,11 @@ struct ModuleEntryPoint
 		ErrorOpenModule=31,
 		ErrorNoEntryPoint=32
 	};
+	/// \brief Flags declaring properties of a module, stored in the first reserved field, so that modules without flags have none set
+	enum Flag
+	{
+		FlagSortedConstructorTables=0x1	///< all constructor tables of the module are sorted by name with unique lower case names (see constructorTable.hpp)
+	};
 
 	char signature[ 8];			///< signature of the module (string + major version)
 	Type type;				///< type of the module
@@ -62,7 +67,7 @@ struct ModuleEntryPoint
 	struct Status
 	{
 		Status()
-			:errorcode(0)
+			:errorcode(0),openTime(0.0),matchVersionTime(0.0)
 		{
 			errormsg[0] = '\0';
 		}
@@ -71,18 +76,56 @@ struct ModuleEntryPoint
 
 		int errorcode;
 		char errormsg[ 256];
+		double openTime;		///< seconds spent for opening the module and looking up its entry point
+		double matchVersionTime;	///< seconds spent for checking the versions of the module
+	};
+
+	/// \brief Binding of the symbols of a module when opening it
+	enum BindingMode
+	{
+		BindNow,			///< resolve all symbols when opening the module
+		BindLazy			///< resolve function symbols on their first call
 	};
 
 	typedef void* Handle;
 	static void closeHandle( Handle& hnd);
 
+	/// \brief Get the set of flags (ModuleEntryPoint::Flag) declared by the module
+	unsigned int flags() const
+	{
+		return _reserved[ 0];
+	}
+
+protected:
+	/// \brief Declare the flags (ModuleEntryPoint::Flag) of the module, called by constructors of derived classes
+	void setFlags( unsigned int flags_)
+	{
+		_reserved[ 0] = flags_;
+	}
+
 private:
 	ModuleEntryPoint( const ModuleEntryPoint&){}	//< non copyable
 	ModuleEntryPoint(){}				//< no implicit construction without data
 };
 
 typedef bool (*MatchModuleVersionFunc)( const ModuleEntryPoint* entryPoint, int& errorcode);
+/// \brief Open a module and get its entry point
+/// \note A module exports either one entry point with the symbol 'entryPoint' or a NULL terminated table of entry points of any type with the symbol 'entryPoints', e.g.
+///	extern "C" DLL_PUBLIC const strus::ModuleEntryPoint* entryPoints[];
+///	const strus::ModuleEntryPoint* entryPoints[] = {&analyzerEntryPoint, &storageEntryPoint, 0};
+///	For a module with a table, the versions of all entry points are checked and the first one is returned. It represents the module.
 const ModuleEntryPoint* loadModuleEntryPoint( const char* modfilename, ModuleEntryPoint::Status& status, ModuleEntryPoint::Handle& hnd, MatchModuleVersionFunc);
+/// \brief Open a module with a selected binding mode of its symbols and get its entry point
+/// \note Same as loadModuleEntryPoint without binding mode, that uses ModuleEntryPoint::BindNow
+const ModuleEntryPoint* loadModuleEntryPoint( const char* modfilename, ModuleEntryPoint::Status& status, ModuleEntryPoint::Handle& hnd, MatchModuleVersionFunc, ModuleEntryPoint::BindingMode bindingMode);
+/// \brief Get the table of entry points of a module exporting the symbol 'entryPoints' instead of 'entryPoint'
+/// \param[in] hnd handle of the module returned by loadModuleEntryPoint
+/// \return NULL terminated array of entry points starting with the one returned by loadModuleEntryPoint or NULL if the module has a single entry point
+const ModuleEntryPoint* const* getModuleEntryPointTable( ModuleEntryPoint::Handle hnd);
+/// \brief Close a handle returned by loadModuleEntryPoint, unloading the module if the process holds no other handle of it
+/// \note Unlike ModuleEntryPoint::closeHandle, that does nothing, this closes the handle.
+///		The caller has to ensure, that no object created with code of the module is alive anymore.
+void unloadModuleHandle( ModuleEntryPoint::Handle hnd);
 
 }//namespace
 #endif
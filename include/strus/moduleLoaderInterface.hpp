@@ -22,13 +22,97 @@ class AnalyzerObjectBuilderInterface;
 /// \brief Forward declaration
 class TraceObjectBuilderInterface;
 
+/// \brief Metrics of loading a module
+struct ModuleLoadMetrics
+{
+	std::string name;		///< name of the module as passed to the loader
+	std::string path;		///< path of the module file loaded or empty if not found
+	int nofPathsProbed;		///< number of file paths probed
+	double statTime;		///< seconds spent for locating the module file (file status calls and module index lookups)
+	double openTime;		///< seconds spent for opening the module and looking up its entry point, 0 if not opened yet (LoadDeferred)
+	double versionCheckTime;	///< seconds spent for checking the versions of the module
+	long memoryDelta;		///< change of the resident memory of the process in bytes while opening the module, approximate if modules are loaded concurrently
+	bool fromIndex;			///< true if the module file was located by the module index without scanning its directory or checking the file
+
+	ModuleLoadMetrics()
+		:name(),path(),nofPathsProbed(0),statTime(0.0),openTime(0.0),versionCheckTime(0.0),memoryDelta(0),fromIndex(false){}
+	ModuleLoadMetrics( const ModuleLoadMetrics& o)
+		:name(o.name),path(o.path),nofPathsProbed(o.nofPathsProbed),statTime(o.statTime)
+		,openTime(o.openTime),versionCheckTime(o.versionCheckTime),memoryDelta(o.memoryDelta),fromIndex(o.fromIndex){}
+};
+
+/// \brief Metrics of the creation of an object by the object builders of a module loader
+struct ModuleConstructorMetrics
+{
+	std::string kind;		///< kind of the object (e.g. "normalizer")
+	std::string name;		///< name of the object
+	int nofCreated;			///< number of objects created, one per object builder using it
+	double createTime;		///< total seconds spent in the constructor
+	double maxCreateTime;		///< maximum seconds spent in one call of the constructor
+
+	ModuleConstructorMetrics()
+		:kind(),name(),nofCreated(0),createTime(0.0),maxCreateTime(0.0){}
+	ModuleConstructorMetrics( const std::string& kind_, const std::string& name_)
+		:kind(kind_),name(name_),nofCreated(0),createTime(0.0),maxCreateTime(0.0){}
+	ModuleConstructorMetrics( const ModuleConstructorMetrics& o)
+		:kind(o.kind),name(o.name),nofCreated(o.nofCreated),createTime(o.createTime),maxCreateTime(o.maxCreateTime){}
+};
+
 /// \brief Interface providing a mechanism to load modules and to create the objects defined in the modules
+/// \note Concurrency: All methods are thread safe. Loading, reloading and unloading modules publishes a new snapshot of the module set.
+///		The object builders are created from the snapshot published last without waiting for modules being loaded concurrently.
+///		Only the opening of deferred modules (LoadDeferred) and the creation of a cached builder (defineBuilderCaching) are serialized.
+///		The configuration methods (define...) should be called before the loader is shared between threads,
+///		they affect the following calls only.
 class ModuleLoaderInterface
 {
 public:
 	/// \brief Destructor
 	virtual ~ModuleLoaderInterface(){}
 
+	/// \brief Mode of loading modules
+	enum LoadMode
+	{
+		LoadEager,		///< open the module and resolve all its symbols when loading it (default)
+		LoadLazy,		///< open the module when loading it and resolve its function symbols on their first call (in every process, also after prepare)
+		LoadDeferred		///< only locate the module file when loading it, open the module when an object builder of its type is created the first time
+	};
+
+	/// \brief Define the mode of loading modules for the following calls of loadModule or loadModules
+	/// \param[in] mode the load mode to use
+	/// \note In mode LoadDeferred the module type is taken from the module index (see defineModuleIndexFile) if known,
+	///		modules of unknown type are opened with the first object builder created.
+	///		Errors of modules that cannot be opened are reported when creating the object builder.
+	virtual void defineLoadMode( const LoadMode& mode)=0;
+
+	/// \brief Enable or disable the caching of object builders
+	/// \param[in] enable true, if the storage and analyzer object builders created should share one instance built once (default false)
+	/// \note With caching enabled, createStorageObjectBuilder and createAnalyzerObjectBuilder return lightweight handles referencing a builder
+	///		built with the first call. The cached builder is rebuilt on the next call after a module has been added.
+	///		Handles created before keep the builder they reference alive, but do not see the modules added after their creation.
+	virtual void defineBuilderCaching( bool enable)=0;
+
+	/// \brief Enable or disable the discovery of modules by reading the module directories
+	/// \param[in] enable true, if every module directory should be read once and the module files found be kept in a table in memory (default false)
+	/// \note With discovery enabled, the files looked up by loadModule, loadModules and moduleLoadTryPaths are searched in this table
+	///		instead of probing every candidate path with a file status call. Module files added to a directory after it has been read are not found.
+	///		Enabling the discovery again drops the table, so that the directories are read again.
+	virtual void defineModuleDiscovery( bool enable)=0;
+
+	/// \brief Prepare the loader in a parent process for forking worker processes that share the modules loaded copy-on-write
+	/// \return true on success, false on failure
+	/// \note Opens the modules loaded with LoadDeferred with all their symbols resolved.
+	///		With builder caching enabled, the object builders and their tables of constructors are built here, so that they are shared by the workers.
+	/// \remark The dynamic linker does not relocate a module already opened again, so the symbols of modules loaded with LoadLazy
+	///		stay unresolved and are resolved on their first call in every worker. Use LoadEager or LoadDeferred for modules shared by workers.
+	virtual bool prepare()=0;
+
+	/// \brief Activate the loader in a worker process forked after prepare was called in the parent process
+	/// \return true on success, false on failure
+	/// \note Only resets the per process handles: the storage, databases and vector storages created by the cached storage object builder
+	///		are dropped and created again in the worker on their next request. Objects got from the builders before the fork must not be used in the worker.
+	virtual bool activate()=0;
+
 	/// \brief Add the path defined by the system depending on the platform where to seek modules to load
 	/// \note If you do not define any path with 'addSystemModulePath()' or 'addModulePath(const std::string&)' then the system module path is used for loading modules.
 	virtual void addSystemModulePath()=0;
@@ -39,8 +123,62 @@ public:
 
 	/// \brief Load a module with name 'name' seeking in all module paths defined in the order of their definition
 	/// \param[in] name name of the module with or without file extension (default file extension depends on platform)
+	/// \note A module linked statically into the executable (STRUS_MODULE_ENTRY_POINT in strus/staticModule.hpp) is taken without seeking a file
 	virtual bool loadModule( const std::string& name)=0;
 
+	/// \brief Load a list of modules, searching and opening them concurrently
+	/// \param[in] names names of the modules with or without file extension (default file extension depends on platform)
+	/// \return true on success, false if at least one of the modules could not be loaded
+	/// \note The modules found are registered in the order of the list, the result is the same as calling loadModule for each name
+	virtual bool loadModules( const std::vector<std::string>& names)=0;
+
+	/// \brief Write a manifest of the modules loaded to a file, to be read with loadPreloadManifest for loading the same modules without searching them
+	/// \param[in] filename path of the manifest file
+	/// \return true on success, false on failure
+	/// \note The manifest contains the resolved path, the file identity (size, modification time, inode) and the entry point meta data of each module.
+	///		Modules loaded with LoadDeferred and not opened yet are opened for writing it.
+	virtual bool writePreloadManifest( const std::string& filename) const=0;
+
+	/// \brief Load the modules listed in a manifest written with writePreloadManifest in the order of the manifest
+	/// \param[in] filename path of the manifest file
+	/// \return true on success, false if the manifest cannot be read or at least one of the modules could not be loaded
+	/// \note A module with an unchanged file is opened from the path recorded without searching the module paths and with the versions recorded checked instead of the ones of the module opened.
+	///		A module with a file changed in size, modification time or inode, or recorded for another version of the loader, is loaded by name as with loadModule.
+	virtual bool loadPreloadManifest( const std::string& filename)=0;
+
+	/// \brief Enable the watching of the files of the modules loaded, for loading new versions of them side by side without restarting the process
+	/// \param[in] copyDirectory directory where a new version of a module file is copied to for opening it,
+	///		because the dynamic linker returns the module already loaded when opening a file with the same path again
+	/// \return true on success, false on failure
+	/// \note Watches the directories of the modules loaded before and after this call with inotify where available,
+	///		without notifications the module files are checked with a file status call on every call of reloadChangedModules
+	virtual bool enableModuleReload( const std::string& copyDirectory)=0;
+
+	/// \brief Load the new versions of the module files changed since they were loaded or reloaded
+	/// \return the number of modules reloaded or -1 if reloading was not enabled or at least one module failed to reload
+	/// \note Thread safe, meant to be called periodically by the application, while object builders are created and used in other threads.
+	///		Object builders created after the call use the new versions, object builders created before keep the versions they were built with.
+	///		With unloading enabled (defineModuleUnloading), a version replaced is unloaded when the last object builder referencing it is deleted,
+	///		otherwise it stays loaded until the process exits.
+	///		A module failing to reload is kept in its version loaded and tried again only when its file changes again.
+	///		Modules not opened yet (LoadDeferred) are not affected, they are opened from their file when needed.
+	virtual int reloadChangedModules()=0;
+
+	/// \brief Enable or disable the unloading of modules not referenced anymore, for the modules opened after this call
+	/// \param[in] enable true, if a module should be unloaded when neither the loader nor an object builder uses it anymore (default false)
+	/// \note Every object builder holds a reference to the modules it was built with. A module is unloaded (dlclose) with the release
+	///		of the last reference, after it was removed from the loader with unloadModule, replaced by reloadChangedModules or the loader was deleted.
+	///		Objects created with an object builder have to be deleted before the object builder then. This is not guaranteed in all language bindings,
+	///		so unloading is disabled by default. Trace modules are never unloaded, because the trace loggers created are not tracked.
+	///		Modules marked by the system as not unloadable (e.g. defining unique symbols) stay mapped after closing the last handle.
+	virtual void defineModuleUnloading( bool enable)=0;
+
+	/// \brief Remove a module from the loader, so that object builders created after this call do not use it anymore
+	/// \param[in] name name of the module as passed to loadModule or loadModules
+	/// \return true on success, false if no module with this name is loaded or if it is a trace module
+	/// \note The module is unloaded, when the object builders created before release it and unloading was enabled when it was opened
+	virtual bool unloadModule( const std::string& name)=0;
+
 	/// \brief Get the list of files tried to load for module with a given name
 	/// \param[in] name name of the module with or without file extension (default file extension depends on platform)
 	virtual std::vector<std::string> moduleLoadTryPaths( const std::string& name)=0;
@@ -53,6 +191,11 @@ public:
 	/// \param[in] path path to define as root path
 	virtual void defineWorkingDirectory( const std::string& path)=0;
 
+	/// \brief Define a file where an index of the module files found in the module paths is stored, consulted first when searching for a module
+	/// \param[in] filename path of the index file, created if it does not exist yet
+	/// \note The entries of a module path in the index are rebuilt with one directory scan if the modification time of the directory changed
+	virtual void defineModuleIndexFile( const std::string& filename)=0;
+
 	/// \brief Get the paths where to seek modules to load
 	/// \return list of paths in order of their definition
 	virtual std::vector<std::string> modulePaths() const=0;
@@ -79,10 +222,27 @@ public:
 
 	/// \brief Get the builder for call trace proxy objects for analyzer or storage.
 	///		The returned builder is built from components loaded from module or the standard builders defined by name.
-	/// \param[in] config trace object builder config
+	/// \param[in] config trace object builder config, the logger is selected with 'log' (e.g. "log=json;file=trace.json")
+	/// \note The built-in logger "histogram" prints percentiles of the latency of the calls per interface and method on close and every 'interval' seconds if specified, to the file selected with 'file' or to stdout.
+	/// \note The built-in logger "binary" writes a compact binary trace to the file selected with 'file', converted to text offline with the program strusTraceConvert.
+	/// \note The built-in logger "ring" writes the same records into the memory mapped file selected with 'file' used as ring buffer of 'size' bytes (default 16M),
+	///		keeping the most recent calls also after a crash of the process, e.g. "log=ring;file=trace.ring;size=67108864". The file is converted with strusTraceConvert too.
+	///		The built-in logger "async" passes the events in a background thread to the logger selected with 'inner',
+	///		e.g. "log=async;inner=json;file=trace.json;buffer=4096;interval=20". The traced calls only queue their events then,
+	///		'buffer' is the number of events a ring buffer can hold (events that do not fit are dropped), 'interval' the milliseconds between draining them.
+	///		The built-in logger "sample" passes a fraction 'rate' of the top level calls of a thread with all calls nested in them to the logger selected with 'inner',
+	///		e.g. "log=sample;rate=0.001;inner=json;file=trace.json". Wrappers can be combined, e.g. "log=sample;rate=0.01;inner=async;inner=json".
 	/// \return the builder object (with ownership)
 	virtual TraceObjectBuilderInterface* createTraceObjectBuilder( const std::string& config) const=0;
 
+	/// \brief Get the metrics of loading the modules
+	/// \return the metrics of all modules loaded or tried to load in the order of loading
+	virtual std::vector<ModuleLoadMetrics> moduleLoadMetrics() const=0;
+
+	/// \brief Get the metrics of the objects created from constructors by the object builders of this loader
+	/// \return the metrics per object kind and name in the order of their first creation
+	virtual std::vector<ModuleConstructorMetrics> constructorMetrics() const=0;
+
 	/// \brief Get the license texts of loaded 3rdParty components, that need to be visible
 	/// \return the list of license tests
 	virtual std::vector<std::string> get3rdPartyLicenseTexts() const=0;
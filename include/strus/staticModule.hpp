@@ -0,0 +1,67 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Registry of modules linked statically into an executable, found by the module loader by name without opening a shared object
+/// \file staticModule.hpp
+#ifndef _STRUS_STATIC_MODULE_HPP_INCLUDED
+#define _STRUS_STATIC_MODULE_HPP_INCLUDED
+#include "strus/moduleEntryPoint.hpp"
+#include "strus/base/dll_tags.hpp"
+
+/// \brief strus toplevel namespace
+namespace strus {
+
+/// \brief Node of the list of modules linked statically, declared with static storage by STRUS_MODULE_ENTRY_POINT
+/// \note POD with constant initialization, so that the registration does not depend on the order of static initialization
+struct StaticModuleRegistration
+{
+	const char* name;			///< name of the module as passed to the loader (e.g. "normalizer_snowball")
+	const ModuleEntryPoint* entryPoint;	///< entry point of the module
+	StaticModuleRegistration* next;		///< next registration in the list or NULL
+};
+
+/// \brief Register a module linked statically, called by the static initialization of the module
+/// \param[in] reg registration with static storage (not copied)
+void registerStaticModule( StaticModuleRegistration* reg);
+
+/// \brief Get the list of modules linked statically
+/// \return the registration added last or NULL if there is none
+const StaticModuleRegistration* staticModules();
+
+/// \brief Object registering a module linked statically in its constructor
+struct StaticModuleRegistrar
+{
+	explicit StaticModuleRegistrar( StaticModuleRegistration* reg)
+	{
+		registerStaticModule( reg);
+	}
+};
+
+}//namespace
+
+/// \brief Define the entry point of a module
+/// \param[in] TYPE type of the entry point (strus::AnalyzerModule, strus::StorageModule or strus::TraceModule)
+/// \param[in] NAME name of the module as passed to the loader without prefix "modstrus_" (e.g. normalizer_snowball)
+/// \note Usage: STRUS_MODULE_ENTRY_POINT( strus::AnalyzerModule, normalizer_snowball)( 0, normalizers, 0);
+/// \remark With STRUS_STATIC_MODULE defined, the module is compiled for linking it into an executable. The entry point gets a unique name
+///		and is registered for the module loader, that finds it by name without opening a file. The object files of such a module have to be
+///		linked as they are, because a linker picking object files from a static library drops them as they are not referenced.
+///		Without STRUS_STATIC_MODULE defined, the module is compiled as shared object with the exported symbol 'entryPoint'.
+#if defined(STRUS_STATIC_MODULE)
+#define STRUS_MODULE_ENTRY_POINT( TYPE, NAME)\
+	extern TYPE strus_staticModuleEntryPoint_ ## NAME;\
+	static strus::StaticModuleRegistration strus_staticModuleRegistration_ ## NAME = {#NAME, &strus_staticModuleEntryPoint_ ## NAME, 0};\
+	static strus::StaticModuleRegistrar strus_staticModuleRegistrar_ ## NAME( &strus_staticModuleRegistration_ ## NAME);\
+	TYPE strus_staticModuleEntryPoint_ ## NAME
+#else
+#define STRUS_MODULE_ENTRY_POINT( TYPE, NAME)\
+	extern "C" DLL_PUBLIC TYPE entryPoint;\
+	TYPE entryPoint
+#endif
+
+#endif
+
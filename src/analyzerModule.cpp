@@ -36,6 +36,17 @@ DLL_PUBLIC AnalyzerModule::AnalyzerModule(
 	init( 0, 0, tokenizerConstructors_, normalizerConstructors_, aggregatorConstructors_, 0, 0);
 }
 
+DLL_PUBLIC AnalyzerModule::AnalyzerModule(
+		const TokenizerConstructor* tokenizerConstructors_,
+		const NormalizerConstructor* normalizerConstructors_,
+		const AggregatorConstructor* aggregatorConstructors_,
+		unsigned int flags_)
+	:ModuleEntryPoint(ModuleEntryPoint::Analyzer, STRUS_ANALYZER_VERSION_MAJOR, STRUS_ANALYZER_VERSION_MINOR)
+{
+	init( 0, 0, tokenizerConstructors_, normalizerConstructors_, aggregatorConstructors_, 0, 0);
+	setFlags( flags_);
+}
+
 DLL_PUBLIC AnalyzerModule::AnalyzerModule(
 		const PatternLexerConstructor& patternLexerConstructor_,
 		const PatternMatcherConstructor& patternMatcherConstructor_)
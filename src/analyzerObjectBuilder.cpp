@@ -25,6 +25,7 @@
 #include "strus/contentStatisticsInterface.hpp"
 #include "strus/posTaggerInterface.hpp"
 #include "strus/posTaggerInstanceInterface.hpp"
+#include "loadMetrics.hpp"
 #include "internationalization.hpp"
 #include "errorUtils.hpp"
 #include <string>
@@ -33,10 +34,12 @@
 using namespace strus;
 using namespace strus::module;
 
-AnalyzerObjectBuilder::AnalyzerObjectBuilder( const FileLocatorInterface* filelocator_, ErrorBufferInterface* errorhnd_)
-	:m_textproc( strus::createTextProcessor(filelocator_,errorhnd_)),m_errorhnd(errorhnd_),m_filelocator(filelocator_)
+AnalyzerObjectBuilder::AnalyzerObjectBuilder( const FileLocatorInterface* filelocator_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_)
+	:m_moduleHandles(),m_analyzerModules(),m_textproc(),m_metrics(metrics_),m_errorhnd(errorhnd_),m_filelocator(filelocator_)
 {
-	if (!m_textproc.get()) throw std::runtime_error( _TXT("error creating text processor"));
+	TextProcessorInterface* tpi = strus::createTextProcessor( filelocator_, errorhnd_);
+	if (!tpi) throw std::runtime_error( _TXT("error creating text processor"));
+	m_textproc.reset( new LazyTextProcessor( tpi, metrics_, errorhnd_));
 	m_docdetect.reset( strus::createDetector_std( m_textproc.get(), m_errorhnd));
 	if (!m_docdetect.get()) throw std::runtime_error( _TXT("error creating document class detector"));
 }
@@ -55,100 +58,37 @@ void AnalyzerObjectBuilder::addAnalyzerModule( const AnalyzerModule* mod)
 			m_errorhnd->explain(_TXT("cannot add analyzer module with previous unhandled errors: %s"));
 			return;
 		}
+		// ... functions are created by the text processor on the first lookup of their name:
+		bool sorted = 0 != (mod->flags() & ModuleEntryPoint::FlagSortedConstructorTables);
 		if (mod->tokenizerConstructors)
 		{
-			TokenizerConstructor const* ti = mod->tokenizerConstructors;
-			for (; ti->create != 0; ++ti)
-			{
-				TokenizerFunctionInterface* func = ti->create( m_errorhnd);
-				if (!func)
-				{
-					m_errorhnd->explain(_TXT("error creating tokenizer function: %s"));
-					return;
-				}
-				m_textproc->defineTokenizer( ti->name, func);
-				if (m_errorhnd->hasError())
-				{
-					delete func;
-					m_errorhnd->explain(_TXT("error defining tokenizer function '%s'"));
-				}
-			}
+			m_textproc->registerTokenizers( mod->tokenizerConstructors, sorted);
 		}
 		if (mod->normalizerConstructors)
 		{
-			NormalizerConstructor const* ni = mod->normalizerConstructors;
-			for (; ni->create != 0; ++ni)
-			{
-				NormalizerFunctionInterface* func = ni->create( m_errorhnd);
-				if (!func)
-				{
-					m_errorhnd->explain(_TXT("error creating normalizer function: %s"));
-					return;
-				}
-				m_textproc->defineNormalizer( ni->name, func);
-				if (m_errorhnd->hasError())
-				{
-					delete func;
-					m_errorhnd->explain(_TXT("error defining normalizer function: %s"));
-				}
-			}
+			m_textproc->registerNormalizers( mod->normalizerConstructors, sorted);
 		}
 		if (mod->aggregatorConstructors)
 		{
-			AggregatorConstructor const* ni = mod->aggregatorConstructors;
-			for (; ni->create != 0; ++ni)
-			{
-				AggregatorFunctionInterface* func = ni->create( m_errorhnd);
-				if (!func)
-				{
-					m_errorhnd->explain(_TXT("error creating aggregator function: %s"));
-					return;
-				}
-				m_textproc->defineAggregator( ni->name, func);
-				if (m_errorhnd->hasError())
-				{
-					delete func;
-					m_errorhnd->explain(_TXT("error defining aggregator function: %s"));
-				}
-			}
+			m_textproc->registerAggregators( mod->aggregatorConstructors, sorted);
 		}
 		if (mod->segmenterConstructor.name && mod->segmenterConstructor.create)
 		{
+			double starttime = getMonotonicTime();
 			Reference<SegmenterInterface> segref( mod->segmenterConstructor.create( m_errorhnd));
 			if (segref.get())
 			{
+				if (m_metrics) m_metrics->add( "segmenter", mod->segmenterConstructor.name, getMonotonicTime() - starttime);
 				m_textproc->defineSegmenter( mod->segmenterConstructor.name, segref.release());
 			}
 		}
 		if (mod->patternLexerConstructor.name && mod->patternLexerConstructor.create)
 		{
-			PatternLexerInterface* func = mod->patternLexerConstructor.create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->explain(_TXT("error creating pattern lexer: %s"));
-				return;
-			}
-			m_textproc->definePatternLexer( mod->patternLexerConstructor.name, func);
-			if (m_errorhnd->hasError())
-			{
-				delete func;
-				m_errorhnd->explain(_TXT("error defining pattern lexer: %s"));
-			}
+			m_textproc->registerPatternLexer( mod->patternLexerConstructor);
 		}
 		if (mod->patternMatcherConstructor.name && mod->patternMatcherConstructor.create)
 		{
-			PatternMatcherInterface* func = mod->patternMatcherConstructor.create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->explain(_TXT("error creating pattern lexer: %s"));
-				return;
-			}
-			m_textproc->definePatternMatcher( mod->patternLexerConstructor.name, func);
-			if (m_errorhnd->hasError())
-			{
-				delete func;
-				m_errorhnd->explain(_TXT("error defining pattern lexer: %s"));
-			}
+			m_textproc->registerPatternMatcher( mod->patternMatcherConstructor);
 		}
 		m_analyzerModules.push_back( mod);
 	}
@@ -11,6 +11,8 @@
 #include "strus/documentClassDetectorInterface.hpp"
 #include "strus/reference.hpp"
 #include "strus/textProcessorInterface.hpp"
+#include "lazyTextProcessor.hpp"
+#include "moduleHandle.hpp"
 #include <string>
 #include <vector>
 #include <map>
@@ -39,6 +41,8 @@ class SegmenterInterface;
 class ErrorBufferInterface;
 /// \brief Forward declaration
 class FileLocatorInterface;
+/// \brief Forward declaration
+class ConstructorMetricsCollector;
 
 namespace module
 {
@@ -48,7 +52,7 @@ class AnalyzerObjectBuilder
 	:public AnalyzerObjectBuilderInterface
 {
 public:
-	explicit AnalyzerObjectBuilder( const FileLocatorInterface* filelocator_, ErrorBufferInterface* errorhnd_);
+	AnalyzerObjectBuilder( const FileLocatorInterface* filelocator_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_);
 	virtual ~AnalyzerObjectBuilder(){}
 
 	virtual const TextProcessorInterface* getTextProcessor() const;
@@ -66,11 +70,19 @@ public:
 
 public/*ModuleLoader*/:
 	void addAnalyzerModule( const AnalyzerModule* mod);
+	/// \brief Keep a module used alive as long as this builder exists
+	void addModuleHandle( const ModuleHandleReference& hnd)
+	{
+		m_moduleHandles.push_back( hnd);
+	}
 
 private:
+	// ... declared first to be destroyed last, after all objects created with code of the modules:
+	std::vector<ModuleHandleReference> m_moduleHandles;	///< handles of the modules used
 	std::vector<const AnalyzerModule*> m_analyzerModules;	///< analyzer modules loader
-	Reference<TextProcessorInterface> m_textproc;		///< text processor
+	Reference<LazyTextProcessor> m_textproc;		///< text processor, functions are created on first use
 	Reference<DocumentClassDetectorInterface> m_docdetect;	///< document class detector
+	ConstructorMetricsCollector* m_metrics;			///< collector of the time spent in constructors or NULL
 	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
 	const FileLocatorInterface* m_filelocator;		///< resources and file locator interface
 };
@@ -0,0 +1,275 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger passing the events of the calling threads to another trace logger in a background thread
+/// \file asyncTraceLogger.cpp
+#include "asyncTraceLogger.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/debugTraceInterface.hpp"
+#include "strus/base/configParser.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+#include <new>
+#include <unistd.h>
+
+using namespace strus;
+
+#define DefaultBufferSize 4096
+#define MaxBufferSize (1U<<24)
+#define DefaultInterval 20
+
+AsyncTraceLogger::RingBuffer::RingBuffer()
+	:m_slots(0),m_mask(0),m_nofFree(0),m_pushPos(0),m_popPos(0){}
+
+AsyncTraceLogger::RingBuffer::~RingBuffer()
+{
+	if (m_slots) delete [] m_slots;
+}
+
+void AsyncTraceLogger::RingBuffer::init( unsigned int size)
+{
+	m_slots = new Slot[ size];
+	m_mask = size-1;
+	m_nofFree.set( size);
+	for (unsigned int si=0; si < size; ++si)
+	{
+		m_slots[ si].sequence.set( si);
+	}
+}
+
+bool AsyncTraceLogger::RingBuffer::reserve( unsigned int nof)
+{
+	for (;;)
+	{
+		unsigned int nofFree = m_nofFree.value();
+		if (nofFree < nof) return false;
+		if (m_nofFree.test_and_set( nofFree, nofFree - nof)) return true;
+	}
+}
+
+void AsyncTraceLogger::RingBuffer::push( Event& event)
+{
+	// ... the slot has been reserved, so the slot of the position claimed is free or gets free as soon as the consumer has finished popping it
+	unsigned int pos = m_pushPos.allocIncrement();
+	Slot* slot = &m_slots[ pos & m_mask];
+	while (slot->sequence.value() != pos) {}
+	slot->event.assign( event);
+	slot->sequence.set( pos+1);
+}
+
+bool AsyncTraceLogger::RingBuffer::pop( Event& event)
+{
+	Slot* slot = &m_slots[ m_popPos & m_mask];
+	if ((int)(slot->sequence.value() - (m_popPos+1)) < 0) return false;
+	event.assign( slot->event);
+	slot->sequence.set( m_popPos + m_mask + 1);
+	++m_popPos;
+	m_nofFree.increment();
+	return true;
+}
+
+/// \brief Thread function object of the background thread of an asynchronous trace logger
+struct AsyncTraceLoggerWorker
+{
+	explicit AsyncTraceLoggerWorker( AsyncTraceLogger* logger_)
+		:logger(logger_){}
+	AsyncTraceLoggerWorker( const AsyncTraceLoggerWorker& o)
+		:logger(o.logger){}
+
+	void operator()()
+	{
+		logger->run();
+	}
+
+	AsyncTraceLogger* logger;
+};
+
+AsyncTraceLogger::AsyncTraceLogger( TraceLoggerInterface* inner_, unsigned int bufferSize_, unsigned int interval_, ErrorBufferInterface* errorhnd_)
+	:m_inner(inner_),m_handleCounter(1),m_nofDropped(0),m_stopped(false),m_interval(interval_),m_lastError(),m_thread(0),m_closed(false),m_errorhnd(errorhnd_)
+{
+	try
+	{
+		unsigned int size = 1;
+		while (size < bufferSize_ && size < MaxBufferSize) size <<= 1;
+		for (unsigned int ri=0; ri < NofRingBuffers; ++ri)
+		{
+			m_ringBuffers[ ri].init( size);
+		}
+		m_thread = new strus::thread( AsyncTraceLoggerWorker( this));
+	}
+	catch (...)
+	{
+		delete m_inner;
+		throw;
+	}
+}
+
+AsyncTraceLogger::~AsyncTraceLogger()
+{
+	stop();
+	delete m_inner;
+}
+
+// ... index of the calling thread, assigned on its first event, for selecting a ring buffer shared with as few threads as possible
+static __thread unsigned int g_threadIndex = 0;
+static strus::AtomicCounter<unsigned int> g_threadCounter( 0);
+
+TraceLogRecordHandle AsyncTraceLogger::logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId)
+{
+	if (!g_threadIndex) g_threadIndex = g_threadCounter.allocIncrement() + 1;
+	unsigned int ri = (g_threadIndex-1) % NofRingBuffers;
+	// ... a call is only queued with a slot reserved for its termination
+	if (!m_ringBuffers[ ri].reserve( 2))
+	{
+		m_nofDropped.increment();
+		return 0;
+	}
+	Event event;
+	event.handle = (m_handleCounter.allocIncrement() << RingBufferBits) | ri;
+	event.className = className;
+	event.methodName = methodName;
+	event.objId = objId;
+	m_ringBuffers[ ri].push( event);
+	return event.handle;
+}
+
+void AsyncTraceLogger::logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter)
+{
+	// ... the termination of a call dropped is dropped too
+	if (!loghnd) return;
+	// ... the termination is queued in the ring buffer of its call with the slot reserved, also if called by another thread
+	RingBuffer& ringBuffer = m_ringBuffers[ loghnd & (NofRingBuffers-1)];
+	Event event;
+	event.handle = loghnd;
+	try
+	{
+		event.parameter = parameter;
+	}
+	catch (const std::bad_alloc&)
+	{
+		event.aborted = true;
+	}
+	ringBuffer.push( event);
+}
+
+void AsyncTraceLogger::drain( std::map<TraceLogRecordHandle,TraceLogRecordHandle>& handleMap)
+{
+	Event event;
+	for (unsigned int ri=0; ri < NofRingBuffers; ++ri)
+	{
+		while (m_ringBuffers[ ri].pop( event))
+		{
+			if (event.className)
+			{
+				handleMap[ event.handle] = m_inner->logMethodCall( event.className, event.methodName, event.objId);
+			}
+			else
+			{
+				// ... a call and its termination are queued in the same ring buffer, so the call has been popped before
+				std::map<TraceLogRecordHandle,TraceLogRecordHandle>::iterator hi = handleMap.find( event.handle);
+				if (hi != handleMap.end())
+				{
+					if (!event.aborted) m_inner->logMethodTermination( hi->second, event.parameter);
+					handleMap.erase( hi);
+				}
+				event.parameter.clear();
+				event.aborted = false;
+			}
+			if (m_errorhnd->hasError())
+			{
+				m_lastError = m_errorhnd->fetchError();
+			}
+		}
+	}
+}
+
+void AsyncTraceLogger::run()
+{
+	bool hasContext = m_errorhnd->allocContext();
+	std::map<TraceLogRecordHandle,TraceLogRecordHandle> handleMap;
+	for (;;)
+	{
+		// ... the flag is read before draining, so that the events pushed before stopping are all passed
+		bool stopped = m_stopped.test();
+		try
+		{
+			drain( handleMap);
+		}
+		catch (const std::exception& err)
+		{
+			m_lastError = err.what();
+		}
+		if (stopped) break;
+		::usleep( m_interval * 1000);
+	}
+	if (hasContext) m_errorhnd->releaseContext();
+}
+
+void AsyncTraceLogger::stop()
+{
+	if (m_thread)
+	{
+		m_stopped.set( true);
+		m_thread->join();
+		delete m_thread;
+		m_thread = 0;
+	}
+}
+
+bool AsyncTraceLogger::close()
+{
+	try
+	{
+		stop();
+		if (m_closed) return true;
+		m_closed = true;
+		bool rt = m_inner->close();
+		if (!m_lastError.empty())
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error in asynchronous trace logger: %s"), m_lastError.c_str());
+			return false;
+		}
+		DebugTraceInterface* dbg = m_errorhnd->debugTrace();
+		if (dbg && m_nofDropped.value())
+		{
+			strus::local_ptr<DebugTraceContextInterface> dbgctx( dbg->createTraceContext( "module"));
+			if (dbgctx.get()) dbgctx->event( "dropped", "asynchronous trace logger dropped %u calls because its ring buffers were full", m_nofDropped.value());
+		}
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error closing asynchronous trace logger: %s"), *m_errorhnd, false);
+}
+
+TraceLoggerInterface* strus::createTraceLogger_async( std::string& config, const InnerTraceLoggerFactory& inner, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		unsigned int bufferSize = DefaultBufferSize;
+		unsigned int interval = DefaultInterval;
+		if (!extractUIntFromConfigString( bufferSize, config, "buffer", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			bufferSize = DefaultBufferSize;
+		}
+		if (!extractUIntFromConfigString( interval, config, "interval", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			interval = DefaultInterval;
+		}
+		if (bufferSize == 0)
+		{
+			throw std::runtime_error( _TXT("ring buffer size 'buffer' of asynchronous trace logger must not be 0"));
+		}
+		TraceLoggerInterface* innerLogger = inner.create( config);
+		if (!innerLogger) return 0;
+		return new AsyncTraceLogger( innerLogger, bufferSize, interval, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating asynchronous trace logger: %s"), *errorhnd, 0);
+}
+
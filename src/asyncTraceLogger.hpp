@@ -0,0 +1,154 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger passing the events of the calling threads to another trace logger in a background thread
+/// \file asyncTraceLogger.hpp
+#ifndef _STRUS_MODULE_ASYNC_TRACE_LOGGER_HPP_INCLUDED
+#define _STRUS_MODULE_ASYNC_TRACE_LOGGER_HPP_INCLUDED
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/base/atomic.hpp"
+#include "strus/base/thread.hpp"
+#include "traceLoggerWrapper.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Trace logger queueing the events of the calling threads in lock-free ring buffers, drained in batches into another trace logger by a background thread
+/// \note The calling threads never block and never call the inner logger. A call that does not fit into the ring buffer of the calling thread is dropped.
+///		Every call queued reserves a slot for its termination in the same ring buffer, so that a termination is never dropped without its call
+///		and the background thread gets the termination of every call it has passed.
+///		The handles returned by logMethodCall are the ones of this logger with the index of the ring buffer in the lowest bits, or 0 for a call dropped.
+///		The background thread maps them to the handles of the inner logger.
+class AsyncTraceLogger
+	:public TraceLoggerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] inner_ trace logger the events are passed to (ownership passed)
+	/// \param[in] bufferSize_ number of events a ring buffer can hold, rounded up to a power of two
+	/// \param[in] interval_ milliseconds the background thread sleeps after draining the ring buffers
+	/// \param[in] errorhnd_ buffer for reporting errors
+	AsyncTraceLogger( TraceLoggerInterface* inner_, unsigned int bufferSize_, unsigned int interval_, ErrorBufferInterface* errorhnd_);
+	virtual ~AsyncTraceLogger();
+
+	virtual TraceLogRecordHandle logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId);
+	virtual void logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+	/// \brief Stop the background thread after draining all events queued and close the inner logger
+	virtual bool close();
+
+	/// \brief Get the number of calls dropped because the ring buffer of the calling thread was full
+	unsigned int nofDropped() const
+	{
+		return m_nofDropped.value();
+	}
+
+public/*AsyncTraceLoggerWorker*/:
+	/// \brief Main loop of the background thread
+	void run();
+
+private:
+	/// \brief Call or termination of a method traced
+	struct Event
+	{
+		TraceLogRecordHandle handle;		///< handle returned by this logger for the call
+		const char* className;			///< name of the class of a call (static string of the trace object), NULL for a termination
+		const char* methodName;			///< name of the method of a call (static string of the trace object)
+		TraceObjectId objId;			///< object called
+		std::vector<TraceElement> parameter;	///< parameters of a termination
+		bool aborted;				///< true for a termination that could not be passed (out of memory), only releasing the handle of its call
+
+		Event()
+			:handle(0),className(0),methodName(0),objId(0),parameter(),aborted(false){}
+		Event( const Event& o)
+			:handle(o.handle),className(o.className),methodName(o.methodName),objId(o.objId),parameter(o.parameter),aborted(o.aborted){}
+
+		/// \brief Move the contents of an event without copying the parameters
+		void assign( Event& o)
+		{
+			handle = o.handle;
+			className = o.className;
+			methodName = o.methodName;
+			objId = o.objId;
+			parameter.swap( o.parameter);
+			aborted = o.aborted;
+		}
+	};
+
+	/// \brief Bounded queue of events with many producers and one consumer, without locks
+	/// \note Every slot has a sequence number telling if it is free for the producer of a position or filled for the consumer (D. Vyukov's bounded queue)
+	class RingBuffer
+	{
+	public:
+		RingBuffer();
+		~RingBuffer();
+
+		/// \brief Allocate the slots
+		/// \param[in] size number of slots, a power of two
+		void init( unsigned int size);
+		/// \brief Reserve slots for events pushed later
+		/// \param[in] nof number of slots to reserve
+		/// \return false if there are not enough slots left
+		bool reserve( unsigned int nof);
+		/// \brief Move an event into a slot reserved before
+		void push( Event& event);
+		/// \brief Move the next event out of the queue and release its slot, called by the consumer only
+		/// \return false if the queue is empty
+		bool pop( Event& event);
+
+	private:
+		RingBuffer( const RingBuffer&){}	//< non copyable
+		void operator=( const RingBuffer&){}	//< non copyable
+
+		struct Slot
+		{
+			strus::AtomicCounter<unsigned int> sequence;	///< position the slot is free for if equal to it, filled if equal to the position + 1
+			Event event;					///< event stored
+		};
+
+	private:
+		Slot* m_slots;					///< array of slots
+		unsigned int m_mask;				///< number of slots - 1
+		strus::AtomicCounter<unsigned int> m_nofFree;	///< number of slots neither filled nor reserved
+		strus::AtomicCounter<unsigned int> m_pushPos;	///< next position to push
+		unsigned int m_popPos;				///< next position to pop, accessed by the consumer only
+	};
+
+	enum {
+		RingBufferBits=4,			///< number of bits of the index of the ring buffer in the handles
+		NofRingBuffers=(1<<RingBufferBits)	///< number of ring buffers
+	};
+	void drain( std::map<TraceLogRecordHandle,TraceLogRecordHandle>& handleMap);
+	void stop();
+
+private:
+	AsyncTraceLogger( const AsyncTraceLogger&){}	//< non copyable
+	void operator=( const AsyncTraceLogger&){}	//< non copyable
+
+private:
+	TraceLoggerInterface* m_inner;					///< logger the events are passed to
+	RingBuffer m_ringBuffers[ NofRingBuffers];			///< queues of events, selected by the index of the calling thread
+	strus::AtomicCounter<TraceLogRecordHandle> m_handleCounter;	///< counter for the handles returned by logMethodCall
+	strus::AtomicCounter<unsigned int> m_nofDropped;		///< number of calls dropped because a queue was full
+	strus::AtomicFlag m_stopped;					///< set for stopping the background thread
+	unsigned int m_interval;					///< milliseconds to sleep between draining the queues
+	std::string m_lastError;					///< last error of the inner logger reported in the background thread
+	strus::thread* m_thread;					///< background thread or NULL if stopped
+	bool m_closed;							///< true if the inner logger has been closed
+	ErrorBufferInterface* m_errorhnd;				///< buffer for reporting errors
+};
+
+/// \brief Create an asynchronous trace logger, configuration keys 'buffer' (events per ring buffer, default 4096) and 'interval' (milliseconds, default 20)
+TraceLoggerInterface* createTraceLogger_async( std::string& config, const InnerTraceLoggerFactory& inner, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
@@ -0,0 +1,269 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Compact binary format of call traces written by the built-in trace logger "binary"
+/// \file binaryTraceFormat.cpp
+#include "binaryTraceFormat.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <algorithm>
+#include <utility>
+
+using namespace strus;
+using namespace strus::binarytrace;
+
+void binarytrace::packByte( std::string& buf, unsigned char value)
+{
+	buf.push_back( (char)value);
+}
+
+void binarytrace::packVarint( std::string& buf, unsigned long long value)
+{
+	while (value >= 0x80)
+	{
+		buf.push_back( (char)(unsigned char)((value & 0x7F) | 0x80));
+		value >>= 7;
+	}
+	buf.push_back( (char)(unsigned char)value);
+}
+
+void binarytrace::packZigzag( std::string& buf, long long value)
+{
+	packVarint( buf, ((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+}
+
+void binarytrace::packDouble( std::string& buf, double value)
+{
+	unsigned long long bits;
+	std::memcpy( &bits, &value, sizeof(bits));
+	for (int bi=0; bi < 8; ++bi)
+	{
+		buf.push_back( (char)(unsigned char)(bits & 0xFF));
+		bits >>= 8;
+	}
+}
+
+void binarytrace::packString( std::string& buf, const char* str, std::size_t size)
+{
+	packVarint( buf, size);
+	buf.append( str, size);
+}
+
+void binarytrace::packRecord( std::string& buf, const std::string& record)
+{
+	packVarint( buf, record.size());
+	buf.append( record);
+}
+
+bool binarytrace::isRingTrace( const std::string& content)
+{
+	return content.size() >= RingHeaderSize && 0==std::memcmp( content.c_str(), STRUS_RING_TRACE_MAGIC, std::strlen( STRUS_RING_TRACE_MAGIC));
+}
+
+std::string binarytrace::linearizeRingTrace( const std::string& content, unsigned long long& nofDropped)
+{
+	if (!isRingTrace( content)) throw std::runtime_error( _TXT("not a ring trace (magic bytes do not match)"));
+	RingHeader header;
+	std::memcpy( &header, content.c_str(), sizeof(header));
+	if (header.version != STRUS_BINARY_TRACE_VERSION)
+	{
+		throw std::runtime_error( _TXT("unknown version of ring trace format"));
+	}
+	unsigned long long ringSize = (unsigned long long)header.blockSize * header.nofBlocks;
+	if (header.blockSize <= RingBlockHeaderSize || !header.nofBlocks
+		|| content.size() < (unsigned long long)RingHeaderSize + header.nameAreaSize + ringSize
+		|| header.nameAreaUsed > header.nameAreaSize)
+	{
+		throw std::runtime_error( _TXT("corrupt header of ring trace"));
+	}
+	nofDropped = header.nofDropped;
+	std::string rt( STRUS_BINARY_TRACE_MAGIC);
+	packByte( rt, STRUS_BINARY_TRACE_VERSION);
+	rt.append( content.c_str() + RingHeaderSize, header.nameAreaUsed);
+
+	const char* ring = content.c_str() + RingHeaderSize + header.nameAreaSize;
+	// ... the blocks are ordered by their sequence number, the blocks not written yet are skipped
+	std::vector<std::pair<unsigned long long,unsigned int> > blocks;
+	for (unsigned int bi=0; bi < header.nofBlocks; ++bi)
+	{
+		RingBlockHeader blockHeader;
+		std::memcpy( &blockHeader, ring + (std::size_t)bi * header.blockSize, sizeof(blockHeader));
+		if (!blockHeader.sequence) continue;
+		if (blockHeader.fill > header.blockSize - RingBlockHeaderSize)
+		{
+			throw std::runtime_error( _TXT("corrupt block header in ring trace"));
+		}
+		blocks.push_back( std::pair<unsigned long long,unsigned int>( blockHeader.sequence, bi));
+	}
+	std::sort( blocks.begin(), blocks.end());
+	std::vector<std::pair<unsigned long long,unsigned int> >::const_iterator bi = blocks.begin(), be = blocks.end();
+	for (; bi != be; ++bi)
+	{
+		const char* block = ring + (std::size_t)bi->second * header.blockSize;
+		RingBlockHeader blockHeader;
+		std::memcpy( &blockHeader, block, sizeof(blockHeader));
+		rt.append( block + RingBlockHeaderSize, blockHeader.fill);
+	}
+	return rt;
+}
+
+Reader::Reader( const std::string& content_)
+	:m_content(content_),m_pos(0),m_names(),m_truncated(false)
+{
+	std::size_t magicSize = std::strlen( STRUS_BINARY_TRACE_MAGIC);
+	if (m_content.size() < magicSize + 1 || 0!=std::memcmp( m_content.c_str(), STRUS_BINARY_TRACE_MAGIC, magicSize))
+	{
+		throw std::runtime_error( _TXT("not a binary trace (magic bytes do not match)"));
+	}
+	if ((unsigned char)m_content[ magicSize] != STRUS_BINARY_TRACE_VERSION)
+	{
+		throw std::runtime_error( _TXT("unknown version of binary trace format"));
+	}
+	m_pos = magicSize + 1;
+}
+
+unsigned long long Reader::unpackVarint( const char*& itr, const char* end) const
+{
+	unsigned long long rt = 0;
+	int shift = 0;
+	for (;;)
+	{
+		if (itr == end || shift > 63) throw std::runtime_error( _TXT("corrupt varint in binary trace"));
+		unsigned char ch = (unsigned char)*itr++;
+		rt |= (unsigned long long)(ch & 0x7F) << shift;
+		if ((ch & 0x80) == 0) return rt;
+		shift += 7;
+	}
+}
+
+const std::string& Reader::unpackName( const char*& itr, const char* end) const
+{
+	unsigned long long id = unpackVarint( itr, end);
+	if (id >= m_names.size()) throw std::runtime_error( _TXT("reference to undefined name in binary trace"));
+	return m_names[ id];
+}
+
+void Reader::unpackElement( Element& elem, const char*& itr, const char* end) const
+{
+	if (itr == end) throw std::runtime_error( _TXT("missing element in binary trace"));
+	elem.type = (ElementType)(unsigned char)*itr++;
+	switch (elem.type)
+	{
+		case ElementVoid:
+		case ElementClose:
+			break;
+		case ElementBool:
+		case ElementUInt:
+		case ElementObject:
+		case ElementOpenIndex:
+			elem.uintval = unpackVarint( itr, end);
+			break;
+		case ElementInt:
+		{
+			unsigned long long zz = unpackVarint( itr, end);
+			elem.intval = (long long)(zz >> 1) ^ -(long long)(zz & 1);
+			break;
+		}
+		case ElementDouble:
+		{
+			if (end - itr < 8) throw std::runtime_error( _TXT("corrupt double in binary trace"));
+			unsigned long long bits = 0;
+			for (int bi=7; bi >= 0; --bi)
+			{
+				bits = (bits << 8) | (unsigned char)itr[ bi];
+			}
+			itr += 8;
+			std::memcpy( &elem.doubleval, &bits, sizeof(bits));
+			break;
+		}
+		case ElementString:
+		{
+			unsigned long long size = unpackVarint( itr, end);
+			if ((unsigned long long)(end - itr) < size) throw std::runtime_error( _TXT("corrupt string in binary trace"));
+			elem.strval.assign( itr, size);
+			itr += size;
+			break;
+		}
+		case ElementOpenTag:
+			elem.strval = unpackName( itr, end);
+			break;
+		default:
+			throw std::runtime_error( _TXT("unknown element type in binary trace"));
+	}
+}
+
+bool Reader::next( Record& record)
+{
+	while (m_pos < m_content.size())
+	{
+		const char* itr = m_content.c_str() + m_pos;
+		const char* end = m_content.c_str() + m_content.size();
+		unsigned long long size;
+		try
+		{
+			size = unpackVarint( itr, end);
+		}
+		catch (const std::runtime_error&)
+		{
+			m_truncated = true;
+			return false;
+		}
+		if ((unsigned long long)(end - itr) < size || size == 0)
+		{
+			// ... the last record was cut off while writing it
+			m_truncated = true;
+			return false;
+		}
+		end = itr + size;
+		m_pos = end - m_content.c_str();
+
+		RecordType type = (RecordType)*itr++;
+		switch (type)
+		{
+			case RecordName:
+			{
+				unsigned long long id = unpackVarint( itr, end);
+				unsigned long long namesize = unpackVarint( itr, end);
+				if (id != m_names.size() || (unsigned long long)(end - itr) < namesize)
+				{
+					throw std::runtime_error( _TXT("corrupt name definition in binary trace"));
+				}
+				m_names.push_back( std::string( itr, namesize));
+				continue;
+			}
+			case RecordCall:
+				record.type = RecordCall;
+				record.handle = unpackVarint( itr, end);
+				record.className = unpackName( itr, end);
+				record.methodName = unpackName( itr, end);
+				record.objId = unpackVarint( itr, end);
+				record.parameter.clear();
+				return true;
+			case RecordTermination:
+			{
+				record.type = RecordTermination;
+				record.handle = unpackVarint( itr, end);
+				record.className.clear();
+				record.methodName.clear();
+				record.objId = 0;
+				unsigned long long nofElements = unpackVarint( itr, end);
+				record.parameter.clear();
+				for (unsigned long long ei=0; ei < nofElements; ++ei)
+				{
+					record.parameter.push_back( Element());
+					unpackElement( record.parameter.back(), itr, end);
+				}
+				return true;
+			}
+			default:
+				throw std::runtime_error( _TXT("unknown record type in binary trace"));
+		}
+	}
+	return false;
+}
+
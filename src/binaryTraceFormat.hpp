@@ -0,0 +1,170 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Compact binary format of call traces written by the built-in trace logger "binary"
+/// \file binaryTraceFormat.hpp
+#ifndef _STRUS_MODULE_BINARY_TRACE_FORMAT_HPP_INCLUDED
+#define _STRUS_MODULE_BINARY_TRACE_FORMAT_HPP_INCLUDED
+#include <string>
+#include <vector>
+#include <cstddef>
+
+/// \brief Magic bytes at the start of a binary trace
+#define STRUS_BINARY_TRACE_MAGIC "STRUSTRB"
+/// \brief Version of the binary trace format, following the magic bytes as one byte
+#define STRUS_BINARY_TRACE_VERSION 1
+/// \brief Magic bytes at the start of a ring trace file
+#define STRUS_RING_TRACE_MAGIC "STRUSTRR"
+
+namespace strus
+{
+/// \brief Encoding and decoding of binary call traces
+/// \remark A trace is the magic bytes and the version followed by records. A record is its size as varint followed by its contents:
+///		'N' <id> <string>			: definition of an interned name (class, method or tag name), ids are assigned in ascending order starting with 0
+///		'C' <handle> <class> <method> <object>	: call of a method with the ids of the names of class and method
+///		'T' <handle> <nofelements> <element>*	: termination of the call with the handle, with the parameters and the return value as elements
+///		An element is its type as byte followed by its value: varint for unsigned integers, object ids, indices and name ids of tags,
+///		zigzag varint for integers, 8 bytes little endian IEEE 754 for doubles, size as varint followed by the bytes for strings.
+///		A record cut off at the end (e.g. by a crash of the process) is ignored by the reader.
+namespace binarytrace
+{
+
+/// \brief Types of records
+enum RecordType
+{
+	RecordName='N',			///< definition of an interned name
+	RecordCall='C',			///< call of a method
+	RecordTermination='T'		///< termination of a method call
+};
+
+/// \brief Types of elements of the parameters of a termination, independent of the numbering in TraceElement
+enum ElementType
+{
+	ElementVoid=0,			///< no value
+	ElementBool=1,			///< boolean value
+	ElementInt=2,			///< signed integer
+	ElementUInt=3,			///< unsigned integer
+	ElementDouble=4,		///< floating point number
+	ElementString=5,		///< string
+	ElementObject=6,		///< object id
+	ElementOpenIndex=7,		///< start of a substructure with an index
+	ElementOpenTag=8,		///< start of a substructure with a name
+	ElementClose=9			///< end of a substructure
+};
+
+void packByte( std::string& buf, unsigned char value);
+void packVarint( std::string& buf, unsigned long long value);
+void packZigzag( std::string& buf, long long value);
+void packDouble( std::string& buf, double value);
+void packString( std::string& buf, const char* str, std::size_t size);
+
+/// \brief Append a record with its size to a buffer
+void packRecord( std::string& buf, const std::string& record);
+
+/// \brief Element of the parameters of a termination decoded
+struct Element
+{
+	ElementType type;			///< type of the element
+	unsigned long long uintval;		///< value of ElementBool, ElementUInt, ElementObject, ElementOpenIndex
+	long long intval;			///< value of ElementInt
+	double doubleval;			///< value of ElementDouble
+	std::string strval;			///< value of ElementString or name of ElementOpenTag
+
+	Element()
+		:type(ElementVoid),uintval(0),intval(0),doubleval(0.0),strval(){}
+	Element( const Element& o)
+		:type(o.type),uintval(o.uintval),intval(o.intval),doubleval(o.doubleval),strval(o.strval){}
+};
+
+/// \brief Call or termination decoded
+struct Record
+{
+	RecordType type;			///< RecordCall or RecordTermination
+	unsigned long long handle;		///< handle of the call
+	std::string className;			///< class name of a call
+	std::string methodName;			///< method name of a call
+	unsigned long long objId;		///< object id of a call
+	std::vector<Element> parameter;		///< elements of a termination
+
+	Record()
+		:type(RecordCall),handle(0),className(),methodName(),objId(0),parameter(){}
+	Record( const Record& o)
+		:type(o.type),handle(o.handle),className(o.className),methodName(o.methodName),objId(o.objId),parameter(o.parameter){}
+};
+
+/// \brief Header of a ring trace file written by the built-in trace logger "ring", in native byte order
+/// \remark A ring trace file is the header padded to RingHeaderSize bytes, followed by an area of nameAreaSize bytes with the records defining the names
+///		and by the ring of nofBlocks blocks of blockSize bytes with the records of the calls and terminations. Every block starts with a RingBlockHeader.
+///		A record never crosses the end of a block. The blocks are written by one thread at a time, so the records of concurrent threads are ordered by block only.
+struct RingHeader
+{
+	char magic[8];				///< STRUS_RING_TRACE_MAGIC
+	unsigned int version;			///< STRUS_BINARY_TRACE_VERSION
+	unsigned int blockSize;			///< size of a block in bytes
+	unsigned int nofBlocks;			///< number of blocks of the ring
+	unsigned int nameAreaSize;		///< size of the area with the name definitions in bytes
+	unsigned long long nameAreaUsed;	///< number of bytes of the name area written
+	unsigned long long nofBlocksStarted;	///< number of blocks started since the start, the sequence number of the block started last
+	unsigned long long nofDropped;		///< number of records dropped because they were bigger than a block, the name area was full or no block was free
+};
+
+enum {RingHeaderSize=64};
+
+/// \brief Header of a block of the ring of a ring trace file, in native byte order
+struct RingBlockHeader
+{
+	unsigned long long sequence;		///< sequence number of the block in the order the blocks have been started (counting from 1), 0 if not written yet
+	unsigned int fill;			///< number of bytes of the complete records written after the header
+	unsigned int reserved;			///< 0
+};
+
+enum {RingBlockHeaderSize=16};
+
+/// \brief Evaluate if the contents of a file are a ring trace
+bool isRingTrace( const std::string& content);
+
+/// \brief Build a binary trace from the contents of a ring trace with the records still in the ring, from the oldest block to the newest
+/// \param[out] nofDropped number of records dropped by the logger
+/// \remark Throws if the header is corrupt
+std::string linearizeRingTrace( const std::string& content, unsigned long long& nofDropped);
+
+/// \brief Decoder of a binary trace
+class Reader
+{
+public:
+	/// \brief Constructor
+	/// \param[in] content_ contents of the trace file (not copied)
+	/// \remark Throws if the magic bytes or the version do not match
+	explicit Reader( const std::string& content_);
+
+	/// \brief Decode the next call or termination, the definitions of names are consumed internally
+	/// \param[out] record record decoded
+	/// \return false at the end of the trace
+	/// \remark Throws if a record is corrupt
+	bool next( Record& record);
+
+	/// \brief Evaluate if the last record of the trace was cut off
+	bool truncated() const
+	{
+		return m_truncated;
+	}
+
+private:
+	unsigned long long unpackVarint( const char*& itr, const char* end) const;
+	const std::string& unpackName( const char*& itr, const char* end) const;
+	void unpackElement( Element& elem, const char*& itr, const char* end) const;
+
+private:
+	const std::string& m_content;		///< contents of the trace
+	std::size_t m_pos;			///< position of the next record
+	std::vector<std::string> m_names;	///< names defined by their id
+	bool m_truncated;			///< true if the last record was cut off
+};
+
+}}//namespace
+#endif
+
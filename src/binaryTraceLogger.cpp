@@ -0,0 +1,238 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger writing the calls in a compact binary format, converted to text offline with strusTraceConvert
+/// \file binaryTraceLogger.cpp
+#include "binaryTraceLogger.hpp"
+#include "binaryTraceFormat.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/configParser.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+using namespace strus;
+using namespace strus::binarytrace;
+
+#define FlushBufferSize (1<<16)
+
+unsigned int BinaryTraceEncoder::nameId( std::string& definitions, const char* name, std::size_t namesize)
+{
+	if (m_nameTable)
+	{
+		// ... the ids are cached, so that the shared table is only accessed on the first use of a name by this encoder
+		std::string key( name, namesize);
+		std::map<std::string,unsigned int>::const_iterator ni = m_nameMap.find( key);
+		if (ni != m_nameMap.end()) return ni->second;
+		unsigned int rt = m_nameTable->nameId( name, namesize);
+		m_nameMap[ key] = rt;
+		return rt;
+	}
+	std::pair<std::map<std::string,unsigned int>::iterator,bool> ins
+		= m_nameMap.insert( std::pair<std::string,unsigned int>( std::string( name, namesize), m_nameMap.size()));
+	if (ins.second)
+	{
+		std::string definition;
+		packByte( definition, RecordName);
+		packVarint( definition, ins.first->second);
+		packString( definition, name, namesize);
+		packRecord( definitions, definition);
+	}
+	return ins.first->second;
+}
+
+unsigned int BinaryTraceEncoder::staticNameId( std::string& definitions, const char* name)
+{
+	std::map<const char*,unsigned int>::const_iterator ni = m_staticNameMap.find( name);
+	if (ni != m_staticNameMap.end()) return ni->second;
+	unsigned int rt = nameId( definitions, name, std::strlen( name));
+	m_staticNameMap[ name] = rt;
+	return rt;
+}
+
+void BinaryTraceEncoder::packCall( std::string& record, std::string& definitions, const TraceLogRecordHandle& loghnd, const char* className, const char* methodName, const TraceObjectId& objId)
+{
+	unsigned int classId = staticNameId( definitions, className);
+	unsigned int methodId = staticNameId( definitions, methodName);
+	record.clear();
+	packByte( record, RecordCall);
+	packVarint( record, loghnd);
+	packVarint( record, classId);
+	packVarint( record, methodId);
+	packVarint( record, objId);
+}
+
+void BinaryTraceEncoder::packTermination( std::string& record, std::string& definitions, const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter)
+{
+	record.clear();
+	packByte( record, RecordTermination);
+	packVarint( record, loghnd);
+	packVarint( record, parameter.size());
+	std::vector<TraceElement>::const_iterator pi = parameter.begin(), pe = parameter.end();
+	for (; pi != pe; ++pi)
+	{
+		switch (pi->type())
+		{
+			case TraceElement::TypeVoid:
+				packByte( record, ElementVoid);
+				break;
+			case TraceElement::TypeBool:
+				packByte( record, ElementBool);
+				packVarint( record, pi->boolval() ? 1 : 0);
+				break;
+			case TraceElement::TypeInt:
+				packByte( record, ElementInt);
+				packZigzag( record, pi->intval());
+				break;
+			case TraceElement::TypeUInt:
+				packByte( record, ElementUInt);
+				packVarint( record, pi->uintval());
+				break;
+			case TraceElement::TypeDouble:
+				packByte( record, ElementDouble);
+				packDouble( record, pi->doubleval());
+				break;
+			case TraceElement::TypeString:
+				packByte( record, ElementString);
+				packString( record, pi->strval(), pi->strsize());
+				break;
+			case TraceElement::TypeObject:
+				packByte( record, ElementObject);
+				packVarint( record, pi->objid());
+				break;
+			case TraceElement::TypeOpenIndex:
+				packByte( record, ElementOpenIndex);
+				packVarint( record, pi->uintval());
+				break;
+			case TraceElement::TypeOpenTag:
+			{
+				// ... tag names are few and repeated in every termination, so they are interned too
+				unsigned int tagId = nameId( definitions, pi->strval(), pi->strsize());
+				packByte( record, ElementOpenTag);
+				packVarint( record, tagId);
+				break;
+			}
+			case TraceElement::TypeClose:
+				packByte( record, ElementClose);
+				break;
+		}
+	}
+}
+
+BinaryTraceLogger::BinaryTraceLogger( FILE* file_, const std::string& path_, ErrorBufferInterface* errorhnd_)
+	:m_mutex(),m_file(file_),m_path(path_),m_buffer(),m_record(),m_encoder(),m_handleCounter(0),m_errno(0),m_errorhnd(errorhnd_)
+{
+	m_buffer.reserve( FlushBufferSize * 2);
+	m_buffer.append( STRUS_BINARY_TRACE_MAGIC);
+	packByte( m_buffer, STRUS_BINARY_TRACE_VERSION);
+}
+
+BinaryTraceLogger::~BinaryTraceLogger()
+{
+	if (m_file)
+	{
+		(void)flush();
+		std::fclose( m_file);
+	}
+}
+
+void BinaryTraceLogger::writeRecord()
+{
+	packRecord( m_buffer, m_record);
+	if (m_buffer.size() >= FlushBufferSize) (void)flush();
+}
+
+bool BinaryTraceLogger::flush()
+{
+	if (!m_file || m_buffer.empty()) return true;
+	if (m_buffer.size() != std::fwrite( m_buffer.c_str(), 1, m_buffer.size(), m_file))
+	{
+		if (!m_errno) m_errno = errno ? errno : EIO;
+	}
+	m_buffer.clear();
+	return m_errno == 0;
+}
+
+TraceLogRecordHandle BinaryTraceLogger::logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (!m_file) return 0;
+		TraceLogRecordHandle rt = ++m_handleCounter;
+		// ... the definitions of new names are written to the buffer before the record using them
+		m_encoder.packCall( m_record, m_buffer, rt, className, methodName, objId);
+		writeRecord();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error logging method call in binary trace: %s"), *m_errorhnd, 0);
+}
+
+void BinaryTraceLogger::logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (!m_file) return;
+		m_encoder.packTermination( m_record, m_buffer, loghnd, parameter);
+		writeRecord();
+	}
+	CATCH_ERROR_MAP( _TXT("error logging method termination in binary trace: %s"), *m_errorhnd);
+}
+
+bool BinaryTraceLogger::close()
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (!m_file) return m_errno == 0;
+		(void)flush();
+		if (0 != std::fclose( m_file) && !m_errno)
+		{
+			m_errno = errno ? errno : EIO;
+		}
+		m_file = 0;
+		if (m_errno)
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error writing binary trace file '%s': %s"), m_path.c_str(), ::strerror( m_errno));
+			return false;
+		}
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error closing binary trace logger: %s"), *m_errorhnd, false);
+}
+
+TraceLoggerInterface* strus::createTraceLogger_binary( const std::string& config_, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		std::string config( config_);
+		std::string path;
+		if (!extractStringFromConfigString( path, config, "file", errorhnd))
+		{
+			throw strus::runtime_error(_TXT("undefined '%s' in config of binary trace logger"), "file");
+		}
+		FILE* file = std::fopen( path.c_str(), "wb");
+		if (!file)
+		{
+			throw strus::runtime_error(_TXT("failed to open binary trace file '%s' for writing: %s"), path.c_str(), ::strerror( errno));
+		}
+		try
+		{
+			return new BinaryTraceLogger( file, path, errorhnd);
+		}
+		catch (...)
+		{
+			std::fclose( file);
+			throw;
+		}
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating binary trace logger: %s"), *errorhnd, 0);
+}
+
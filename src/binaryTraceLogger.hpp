@@ -0,0 +1,112 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger writing the calls in a compact binary format, converted to text offline with strusTraceConvert
+/// \file binaryTraceLogger.hpp
+#ifndef _STRUS_MODULE_BINARY_TRACE_LOGGER_HPP_INCLUDED
+#define _STRUS_MODULE_BINARY_TRACE_LOGGER_HPP_INCLUDED
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Table of the ids of the names shared by the encoders of several threads, defining every name once
+class BinaryTraceNameTable
+{
+public:
+	virtual ~BinaryTraceNameTable(){}
+
+	/// \brief Get the id of a name, defining it on its first use, thread safe
+	virtual unsigned int nameId( const char* name, std::size_t namesize)=0;
+};
+
+/// \brief Encoder of the calls and terminations of methods into records of the format described in binaryTraceFormat.hpp, not thread safe
+/// \note Class and method names are interned by the address of their static string, so that encoding a call costs a map lookup by pointer and some bytes copied.
+class BinaryTraceEncoder
+{
+public:
+	/// \brief Constructor of an encoder defining the names itself
+	BinaryTraceEncoder()
+		:m_staticNameMap(),m_nameMap(),m_nameTable(0){}
+	/// \brief Constructor of the encoder of one of several threads, getting the ids of the names from a shared table that writes their definitions
+	/// \param[in] nameTable_ table of the names shared (not owned)
+	explicit BinaryTraceEncoder( BinaryTraceNameTable* nameTable_)
+		:m_staticNameMap(),m_nameMap(),m_nameTable(nameTable_){}
+
+	/// \brief Encode a call
+	/// \param[out] record where to write the contents of the record (without size)
+	/// \param[out] definitions where to append the records defining the names used for the first time, to be written before the record
+	void packCall( std::string& record, std::string& definitions, const TraceLogRecordHandle& loghnd, const char* className, const char* methodName, const TraceObjectId& objId);
+
+	/// \brief Encode a termination
+	/// \param[out] record where to write the contents of the record (without size)
+	/// \param[out] definitions where to append the records defining the names used for the first time, to be written before the record
+	void packTermination( std::string& record, std::string& definitions, const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+
+private:
+	/// \brief Get the id of a name, appending its definition on first use
+	unsigned int nameId( std::string& definitions, const char* name, std::size_t namesize);
+	/// \brief Get the id of a static string
+	unsigned int staticNameId( std::string& definitions, const char* name);
+
+private:
+	std::map<const char*,unsigned int> m_staticNameMap;	///< ids of the static strings of class and method names by their address
+	std::map<std::string,unsigned int> m_nameMap;		///< ids of the names by their contents
+	BinaryTraceNameTable* m_nameTable;			///< table of the names shared with other encoders or NULL
+};
+
+/// \brief Trace logger writing the calls in the format described in binaryTraceFormat.hpp
+class BinaryTraceLogger
+	:public TraceLoggerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] file_ file opened for writing (ownership passed)
+	/// \param[in] path_ path of the file for messages
+	/// \param[in] errorhnd_ buffer for reporting errors
+	BinaryTraceLogger( FILE* file_, const std::string& path_, ErrorBufferInterface* errorhnd_);
+	virtual ~BinaryTraceLogger();
+
+	virtual TraceLogRecordHandle logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId);
+	virtual void logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+	virtual bool close();
+
+private:
+	/// \brief Append the record built in m_record to the output buffer, called with the mutex locked
+	void writeRecord();
+	/// \brief Write the output buffer to the file, called with the mutex locked
+	bool flush();
+
+private:
+	BinaryTraceLogger( const BinaryTraceLogger&){}		//< non copyable
+	void operator=( const BinaryTraceLogger&){}		//< non copyable
+
+private:
+	strus::mutex m_mutex;					///< mutex guarding all members
+	FILE* m_file;						///< file written or NULL if closed
+	std::string m_path;					///< path of the file
+	std::string m_buffer;					///< records not written to the file yet
+	std::string m_record;					///< record built
+	BinaryTraceEncoder m_encoder;				///< encoder of the records
+	TraceLogRecordHandle m_handleCounter;			///< counter for the handles returned by logMethodCall
+	int m_errno;						///< error writing the file or 0
+	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
+};
+
+/// \brief Create a binary trace logger, configuration key 'file' (path of the file to write)
+TraceLoggerInterface* createTraceLogger_binary( const std::string& config, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
@@ -0,0 +1,169 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Hash map with case insensitive keys and lookup without memory allocation
+/// \file caseInsensitiveHashMap.hpp
+#ifndef _STRUS_MODULE_CASE_INSENSITIVE_HASH_MAP_HPP_INCLUDED
+#define _STRUS_MODULE_CASE_INSENSITIVE_HASH_MAP_HPP_INCLUDED
+#include <string>
+#include <vector>
+
+namespace strus
+{
+
+/// \brief Hash map with case insensitive ASCII keys
+/// \note Keys are folded to lower case on the fly for hashing and comparison, so a lookup does not create any temporary string.
+///		The map is meant for a small number of names registered once and looked up often.
+template <typename Value>
+class CaseInsensitiveHashMap
+{
+public:
+	CaseInsensitiveHashMap()
+		:m_entries(),m_buckets( InitBucketArraySize, -1){}
+	CaseInsensitiveHashMap( const CaseInsensitiveHashMap& o)
+		:m_entries(o.m_entries),m_buckets(o.m_buckets){}
+
+	/// \brief Insert a value or replace the value of an existing key
+	/// \param[in] key key of the value, stored folded to lower case
+	/// \param[in] value value to insert
+	void insert( const std::string& key, const Value& value)
+	{
+		Value* found = find( key.c_str(), key.size());
+		if (found)
+		{
+			*found = value;
+			return;
+		}
+		if ((m_entries.size()+1) * 2 > m_buckets.size())
+		{
+			rehash( m_buckets.size() * 2);
+		}
+		std::size_t hs = hash( key.c_str(), key.size());
+		int& bucket = m_buckets[ hs & (m_buckets.size()-1)];
+		m_entries.push_back( Entry( foldString( key), hs, value, bucket));
+		bucket = (int)m_entries.size()-1;
+	}
+
+	/// \brief Find the value of a key
+	/// \param[in] key pointer to the key
+	/// \param[in] keylen length of the key in bytes
+	/// \return pointer to the value or NULL if not found
+	Value* find( const char* key, std::size_t keylen)
+	{
+		std::size_t hs = hash( key, keylen);
+		int ei = m_buckets[ hs & (m_buckets.size()-1)];
+		for (; ei >= 0; ei = m_entries[ ei].next)
+		{
+			const Entry& entry = m_entries[ ei];
+			if (entry.hash == hs && entry.key.size() == keylen && equalFolded( entry.key.c_str(), key, keylen))
+			{
+				return &m_entries[ ei].value;
+			}
+		}
+		return NULL;
+	}
+	const Value* find( const char* key, std::size_t keylen) const
+	{
+		return const_cast<CaseInsensitiveHashMap*>(this)->find( key, keylen);
+	}
+	Value* find( const std::string& key)
+	{
+		return find( key.c_str(), key.size());
+	}
+	const Value* find( const std::string& key) const
+	{
+		return find( key.c_str(), key.size());
+	}
+
+	/// \brief Get the number of keys in the map
+	std::size_t size() const
+	{
+		return m_entries.size();
+	}
+
+	/// \brief Get a value by its index in the order of insertion
+	/// \param[in] idx index of the value, 0 <= idx < size()
+	Value& valueAt( std::size_t idx)
+	{
+		return m_entries[ idx].value;
+	}
+
+private:
+	enum {InitBucketArraySize=8};
+
+	struct Entry
+	{
+		std::string key;	///< key folded to lower case
+		std::size_t hash;	///< hash value of the key
+		Value value;		///< value of the key
+		int next;		///< index of the next entry in the same bucket or -1
+
+		Entry( const std::string& key_, std::size_t hash_, const Value& value_, int next_)
+			:key(key_),hash(hash_),value(value_),next(next_){}
+		Entry( const Entry& o)
+			:key(o.key),hash(o.hash),value(o.value),next(o.next){}
+	};
+
+	static unsigned char fold( unsigned char ch)
+	{
+		return (ch >= 'A' && ch <= 'Z') ? (ch - 'A' + 'a') : ch;
+	}
+
+	static std::size_t hash( const char* key, std::size_t keylen)
+	{
+		// ... FNV-1a of the key folded to lower case
+		std::size_t rt = 2166136261U;
+		for (std::size_t ki=0; ki < keylen; ++ki)
+		{
+			rt ^= fold( (unsigned char)key[ ki]);
+			rt *= 16777619U;
+		}
+		return rt;
+	}
+
+	static bool equalFolded( const char* foldedKey, const char* key, std::size_t keylen)
+	{
+		for (std::size_t ki=0; ki < keylen; ++ki)
+		{
+			if ((unsigned char)foldedKey[ ki] != fold( (unsigned char)key[ ki])) return false;
+		}
+		return true;
+	}
+
+	static std::string foldString( const std::string& key)
+	{
+		std::string rt;
+		rt.reserve( key.size());
+		std::string::const_iterator ki = key.begin(), ke = key.end();
+		for (; ki != ke; ++ki)
+		{
+			rt.push_back( (char)fold( (unsigned char)*ki));
+		}
+		return rt;
+	}
+
+	void rehash( std::size_t nofBuckets)
+	{
+		std::vector<int> buckets( nofBuckets, -1);
+		typename std::vector<Entry>::iterator ei = m_entries.begin(), ee = m_entries.end();
+		for (int eidx=0; ei != ee; ++ei,++eidx)
+		{
+			int& bucket = buckets[ ei->hash & (nofBuckets-1)];
+			ei->next = bucket;
+			bucket = eidx;
+		}
+		m_buckets.swap( buckets);
+	}
+
+private:
+	std::vector<Entry> m_entries;		///< entries in order of insertion
+	std::vector<int> m_buckets;		///< index of the first entry of each bucket or -1, size is a power of two
+};
+
+}//namespace
+#endif
+
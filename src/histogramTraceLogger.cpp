@@ -0,0 +1,406 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger measuring the latency of the calls per interface and method in histograms
+/// \file histogramTraceLogger.cpp
+#include "histogramTraceLogger.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/configParser.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+#include <ctime>
+#include <unistd.h>
+
+using namespace strus;
+
+#define TickMilliseconds 100
+
+static unsigned long long getNanoTime()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+unsigned int HistogramTraceLogger::bucketIndex( unsigned long long value)
+{
+	enum {SubBuckets = (1 << SubBucketBits)};
+	if (value >> MaxValueBits)
+	{
+		value = (1ULL << MaxValueBits) - 1;
+	}
+	if (value < (unsigned long long)SubBuckets) return (unsigned int)value;
+	unsigned int msb = 63 - __builtin_clzll( value);
+	unsigned int shift = msb - SubBucketBits;
+	return SubBuckets * (shift + 1) + (unsigned int)((value >> shift) & (SubBuckets - 1));
+}
+
+unsigned long long HistogramTraceLogger::bucketValue( unsigned int bucket)
+{
+	enum {SubBuckets = (1 << SubBucketBits)};
+	unsigned int group = bucket / SubBuckets;
+	unsigned long long sub = bucket % SubBuckets;
+	if (group == 0) return sub;
+	unsigned int shift = group - 1;
+	return ((SubBuckets + sub) << shift) + ((1ULL << shift) - 1);
+}
+
+/// \brief Thread function object of the background thread of a histogram trace logger
+struct HistogramTraceLoggerWorker
+{
+	explicit HistogramTraceLoggerWorker( HistogramTraceLogger* logger_)
+		:logger(logger_){}
+	HistogramTraceLoggerWorker( const HistogramTraceLoggerWorker& o)
+		:logger(o.logger){}
+
+	void operator()()
+	{
+		logger->run();
+	}
+
+	HistogramTraceLogger* logger;
+};
+
+static strus::AtomicCounter<unsigned int> g_loggerCounter( 0);
+
+HistogramTraceLogger::ThreadState::ThreadState()
+	:depth(0)
+{
+	std::memset( histograms, 0, sizeof(histograms));
+}
+
+HistogramTraceLogger::ThreadState::~ThreadState()
+{
+	for (unsigned int mi=0; mi < MaxMethods; ++mi)
+	{
+		if (histograms[ mi]) delete histograms[ mi];
+	}
+}
+
+HistogramTraceLogger::HistogramTraceLogger( FILE* file_, unsigned int interval_, ErrorBufferInterface* errorhnd_)
+	:m_id(g_loggerCounter.allocIncrement() + 1),m_mutex(),m_nofMethods(0),m_threadStates(),m_nofUnmeasured(0)
+	,m_file(file_),m_startTime(getNanoTime()),m_nofPrints(0),m_stopped(false),m_interval(interval_),m_thread(0),m_closed(false),m_errorhnd(errorhnd_)
+{
+	std::memset( m_methods, 0, sizeof(m_methods));
+	try
+	{
+		if (m_interval)
+		{
+			m_thread = new strus::thread( HistogramTraceLoggerWorker( this));
+		}
+	}
+	catch (...)
+	{
+		if (m_file != stdout) std::fclose( m_file);
+		throw;
+	}
+}
+
+HistogramTraceLogger::~HistogramTraceLogger()
+{
+	stop();
+	std::map<unsigned int,ThreadState*>::iterator ti = m_threadStates.begin(), te = m_threadStates.end();
+	for (; ti != te; ++ti)
+	{
+		delete ti->second;
+	}
+	if (m_file && m_file != stdout) std::fclose( m_file);
+}
+
+/// \brief Entry of the cache of the thread states of the histogram loggers used by a thread
+struct HistogramThreadCacheSlot
+{
+	unsigned int loggerId;				///< id of the logger or 0 if the slot is free
+	HistogramTraceLogger::ThreadState* state;	///< state of the thread owned by the logger
+};
+
+// ... the cache is POD for being thread local without C++11, slots of loggers deleted are never matched again because the logger ids are unique:
+#define ThreadCacheSize 4
+static __thread HistogramThreadCacheSlot g_threadCache[ ThreadCacheSize];
+static __thread unsigned int g_threadCacheNext = 0;
+// ... index of the calling thread, assigned on its first call, as key of the thread states of a logger
+static __thread unsigned int g_threadIndex = 0;
+static strus::AtomicCounter<unsigned int> g_threadCounter( 0);
+
+HistogramTraceLogger::ThreadState* HistogramTraceLogger::threadState()
+{
+	for (int si=0; si < ThreadCacheSize; ++si)
+	{
+		if (g_threadCache[ si].loggerId == m_id) return g_threadCache[ si].state;
+	}
+	if (!g_threadIndex) g_threadIndex = g_threadCounter.allocIncrement() + 1;
+	ThreadState* rt;
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::map<unsigned int,ThreadState*>::const_iterator ti = m_threadStates.find( g_threadIndex);
+		if (ti == m_threadStates.end())
+		{
+			rt = new ThreadState();
+			try
+			{
+				m_threadStates[ g_threadIndex] = rt;
+			}
+			catch (...)
+			{
+				delete rt;
+				throw;
+			}
+		}
+		else
+		{
+			rt = ti->second;
+		}
+	}
+	HistogramThreadCacheSlot& slot = g_threadCache[ g_threadCacheNext++ % ThreadCacheSize];
+	slot.loggerId = m_id;
+	slot.state = rt;
+	return rt;
+}
+
+static unsigned int methodHash( const char* className, const char* methodName)
+{
+	// ... the names are static strings of the trace objects, so they are identified by their address
+	return (unsigned int)(((std::size_t)className >> 3) * 2654435761U) ^ (unsigned int)(((std::size_t)methodName >> 3) * 40503U);
+}
+
+unsigned int HistogramTraceLogger::methodIndex( const char* className, const char* methodName)
+{
+	unsigned int hash = methodHash( className, methodName);
+	unsigned int pi = 0;
+	for (; pi < MethodHashSize; ++pi)
+	{
+		unsigned int idx = m_methodHash[ (hash + pi) & (MethodHashSize-1)].value();
+		if (!idx) break;
+		const Method& method = m_methods[ idx-1];
+		if (method.className == className && method.methodName == methodName) return idx-1;
+	}
+	strus::scoped_lock lock( m_mutex);
+	// ... probe again, the method might have been defined by another thread meanwhile
+	for (pi = 0; pi < MethodHashSize; ++pi)
+	{
+		strus::AtomicCounter<unsigned int>& slot = m_methodHash[ (hash + pi) & (MethodHashSize-1)];
+		unsigned int idx = slot.value();
+		if (!idx)
+		{
+			if (m_nofMethods >= MaxMethods) return MaxMethods;
+			m_methods[ m_nofMethods].className = className;
+			m_methods[ m_nofMethods].methodName = methodName;
+			slot.set( ++m_nofMethods);
+			return m_nofMethods-1;
+		}
+		const Method& method = m_methods[ idx-1];
+		if (method.className == className && method.methodName == methodName) return idx-1;
+	}
+	return MaxMethods;
+}
+
+TraceLogRecordHandle HistogramTraceLogger::logMethodCall( const char* className, const char* methodName, const TraceObjectId&)
+{
+	try
+	{
+		ThreadState* state = threadState();
+		unsigned int di = state->depth++;
+		if (di < MaxCallDepth)
+		{
+			unsigned int method = methodIndex( className, methodName);
+			if (method == MaxMethods) m_nofUnmeasured.increment();
+			state->stack[ di].method = method;
+			state->stack[ di].start = getNanoTime();
+		}
+		else
+		{
+			m_nofUnmeasured.increment();
+		}
+		// ... the handle is the depth of the call in the thread, the termination of a call is logged in the thread of the call
+		return di + 1;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error logging method call in histogram trace logger: %s"), *m_errorhnd, 0);
+}
+
+void HistogramTraceLogger::logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>&)
+{
+	if (!loghnd) return;
+	unsigned long long now = getNanoTime();
+	try
+	{
+		ThreadState* state = threadState();
+		unsigned int di = loghnd - 1;
+		// ... calls nested without their termination logged (e.g. left by an exception) are discarded
+		state->depth = di;
+		if (di >= MaxCallDepth) return;
+		const ThreadState::Frame& frame = state->stack[ di];
+		if (frame.method >= MaxMethods) return;
+		Histogram* histogram = state->histograms[ frame.method];
+		if (!histogram)
+		{
+			// ... the histograms of a thread are only written by the thread itself, the lock protects the reading by printPercentiles
+			strus::scoped_lock lock( m_mutex);
+			histogram = state->histograms[ frame.method] = new Histogram();
+		}
+		unsigned long long latency = now > frame.start ? (now - frame.start) : 0;
+		histogram->buckets[ bucketIndex( latency)].increment();
+		histogram->sum.increment( latency);
+	}
+	CATCH_ERROR_MAP( _TXT("error logging method termination in histogram trace logger: %s"), *m_errorhnd);
+}
+
+/// \brief Latencies of a method summed up over all threads
+struct HistogramSum
+{
+	std::vector<unsigned long long> buckets;	///< number of calls per bucket
+	unsigned long long count;			///< number of calls
+	unsigned long long sum;				///< sum of the latencies in nanoseconds
+
+	HistogramSum()
+		:buckets( HistogramTraceLogger::NofBuckets, 0),count(0),sum(0){}
+	HistogramSum( const HistogramSum& o)
+		:buckets(o.buckets),count(o.count),sum(o.sum){}
+
+	/// \brief Get the latency in microseconds not exceeded by a fraction of the calls
+	double percentile( double fraction) const
+	{
+		unsigned long long rank = (unsigned long long)(fraction * (double)count + 0.999999);
+		if (rank == 0) rank = 1;
+		unsigned long long cumulated = 0;
+		for (unsigned int bi=0; bi < buckets.size(); ++bi)
+		{
+			cumulated += buckets[ bi];
+			if (cumulated >= rank) return (double)HistogramTraceLogger::bucketValue( bi) / 1000.0;
+		}
+		return 0.0;
+	}
+};
+
+void HistogramTraceLogger::printPercentiles()
+{
+	strus::scoped_lock lock( m_mutex);
+	// ... methods with the same names defined in different shared objects have different addresses, they are summed up by name here
+	std::map<std::string,HistogramSum> sums;
+	std::map<unsigned int,ThreadState*>::const_iterator ti = m_threadStates.begin(), te = m_threadStates.end();
+	for (; ti != te; ++ti)
+	{
+		for (unsigned int mi=0; mi < m_nofMethods; ++mi)
+		{
+			const Histogram* histogram = ti->second->histograms[ mi];
+			if (!histogram) continue;
+			std::string name( m_methods[ mi].className);
+			name.append( "::");
+			name.append( m_methods[ mi].methodName);
+			HistogramSum& hsum = sums[ name];
+			for (unsigned int bi=0; bi < NofBuckets; ++bi)
+			{
+				unsigned int cnt = histogram->buckets[ bi].value();
+				hsum.buckets[ bi] += cnt;
+				hsum.count += cnt;
+			}
+			hsum.sum += histogram->sum.value();
+		}
+	}
+	double elapsed = (double)(getNanoTime() - m_startTime) / 1e9;
+	std::fprintf( m_file, "# latency in microseconds after %.3f seconds (print %u)\n", elapsed, ++m_nofPrints);
+	std::fprintf( m_file, "# method\tcalls\tmean\tp50\tp90\tp99\tp99.9\tmax\n");
+	std::map<std::string,HistogramSum>::const_iterator si = sums.begin(), se = sums.end();
+	for (; si != se; ++si)
+	{
+		const HistogramSum& hsum = si->second;
+		if (!hsum.count) continue;
+		std::fprintf( m_file, "%s\t%llu\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\t%.3f\n",
+				si->first.c_str(), hsum.count, (double)hsum.sum / (double)hsum.count / 1000.0,
+				hsum.percentile( 0.5), hsum.percentile( 0.9), hsum.percentile( 0.99), hsum.percentile( 0.999), hsum.percentile( 1.0));
+	}
+	if (m_nofUnmeasured.value())
+	{
+		std::fprintf( m_file, "# %u calls not measured (more than %u methods or calls nested deeper than %u)\n", m_nofUnmeasured.value(), (unsigned int)MaxMethods, (unsigned int)MaxCallDepth);
+	}
+	std::fflush( m_file);
+}
+
+void HistogramTraceLogger::run()
+{
+	unsigned int elapsed = 0;
+	while (!m_stopped.test())
+	{
+		::usleep( TickMilliseconds * 1000);
+		elapsed += TickMilliseconds;
+		if (elapsed >= m_interval * 1000)
+		{
+			elapsed = 0;
+			try
+			{
+				printPercentiles();
+			}
+			catch (const std::bad_alloc&)
+			{
+				// ... skip this print, the final one on close reports the error
+			}
+		}
+	}
+}
+
+void HistogramTraceLogger::stop()
+{
+	if (m_thread)
+	{
+		m_stopped.set( true);
+		m_thread->join();
+		delete m_thread;
+		m_thread = 0;
+	}
+}
+
+bool HistogramTraceLogger::close()
+{
+	try
+	{
+		stop();
+		if (m_closed) return true;
+		m_closed = true;
+		printPercentiles();
+		if (std::ferror( m_file))
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error writing percentiles of histogram trace logger: %s"), ::strerror( errno ? errno : EIO));
+			return false;
+		}
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error closing histogram trace logger: %s"), *m_errorhnd, false);
+}
+
+TraceLoggerInterface* strus::createTraceLogger_histogram( const std::string& config_, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		std::string config( config_);
+		std::string path;
+		unsigned int interval = 0;
+		if (!extractStringFromConfigString( path, config, "file", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			path.clear();
+		}
+		if (!extractUIntFromConfigString( interval, config, "interval", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			interval = 0;
+		}
+		FILE* file = stdout;
+		if (!path.empty())
+		{
+			file = std::fopen( path.c_str(), "w");
+			if (!file)
+			{
+				throw strus::runtime_error(_TXT("failed to open file '%s' of histogram trace logger for writing: %s"), path.c_str(), ::strerror( errno));
+			}
+		}
+		return new HistogramTraceLogger( file, interval, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating histogram trace logger: %s"), *errorhnd, 0);
+}
+
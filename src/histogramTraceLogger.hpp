@@ -0,0 +1,140 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger measuring the latency of the calls per interface and method in histograms
+/// \file histogramTraceLogger.hpp
+#ifndef _STRUS_MODULE_HISTOGRAM_TRACE_LOGGER_HPP_INCLUDED
+#define _STRUS_MODULE_HISTOGRAM_TRACE_LOGGER_HPP_INCLUDED
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/base/atomic.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdio>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Trace logger recording the latency of every call into a histogram per interface and method and per thread, printing percentiles on close and optionally at an interval
+/// \note The histograms have buckets of logarithmic size with 16 linear sub-buckets each (HDR histogram style), so that a latency is recorded with a relative error below 6.25%.
+///		A call costs two reads of the monotonic clock and an uncontended atomic increment in the histogram of the calling thread, the calling threads never block
+///		except for the first call of a method in a thread, that allocates the histogram.
+class HistogramTraceLogger
+	:public TraceLoggerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] file_ file the percentiles are printed to (ownership passed, not closed if stdout)
+	/// \param[in] interval_ seconds between printing the percentiles in a background thread, 0 for printing them on close only
+	/// \param[in] errorhnd_ buffer for reporting errors
+	HistogramTraceLogger( FILE* file_, unsigned int interval_, ErrorBufferInterface* errorhnd_);
+	virtual ~HistogramTraceLogger();
+
+	virtual TraceLogRecordHandle logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId);
+	virtual void logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+	/// \brief Stop the background thread and print the percentiles of all calls measured
+	virtual bool close();
+
+public/*HistogramTraceLoggerWorker*/:
+	/// \brief Main loop of the background thread
+	void run();
+
+public:
+	enum {
+		SubBucketBits=4,						///< number of bits of the latency recorded exactly in a bucket
+		MaxValueBits=40,						///< latencies in nanoseconds above 2^40 (about 18 minutes) are recorded as 2^40-1
+		NofBuckets=(1<<SubBucketBits) * (MaxValueBits - SubBucketBits + 1),
+		MaxMethods=1024,						///< maximum number of different interface methods measured
+		MethodHashSize=2048,						///< size of the hash table of the methods, a power of two
+		MaxCallDepth=64							///< maximum depth of nested calls measured in a thread
+	};
+
+	/// \brief Get the bucket of a latency, the first 16 buckets hold the values 0..15, then every power of two is split into 16 buckets of equal width
+	static unsigned int bucketIndex( unsigned long long value);
+	/// \brief Get the highest latency recorded in a bucket, exceeding the latencies recorded in it by less than 6.25%
+	static unsigned long long bucketValue( unsigned int bucket);
+
+	/// \brief Histogram of the latencies of the calls of a method in one thread
+	struct Histogram
+	{
+		strus::AtomicCounter<unsigned int> buckets[ NofBuckets];	///< number of calls per latency bucket
+		strus::AtomicCounter<unsigned long long> sum;			///< sum of the latencies in nanoseconds
+
+		Histogram()
+			:sum(0){}
+	};
+
+	/// \brief Calls running and histograms of one thread
+	struct ThreadState
+	{
+		/// \brief Call running
+		struct Frame
+		{
+			unsigned int method;		///< index of the method or MaxMethods if not measured
+			unsigned long long start;	///< start time in nanoseconds
+		};
+
+		Histogram* histograms[ MaxMethods];	///< histograms by method index, allocated with m_mutex locked
+		Frame stack[ MaxCallDepth];		///< calls running
+		unsigned int depth;			///< number of calls running
+
+		ThreadState();
+		~ThreadState();
+
+	private:
+		ThreadState( const ThreadState&){}	//< non copyable
+		void operator=( const ThreadState&){}	//< non copyable
+	};
+
+private:
+	/// \brief Get the state of the calling thread, created on its first call
+	ThreadState* threadState();
+	/// \brief Get the index of a method, defined on its first call
+	/// \return the index or MaxMethods if there are too many methods
+	unsigned int methodIndex( const char* className, const char* methodName);
+	/// \brief Print the percentiles of all calls measured so far
+	void printPercentiles();
+	void stop();
+
+private:
+	HistogramTraceLogger( const HistogramTraceLogger&){}		//< non copyable
+	void operator=( const HistogramTraceLogger&){}			//< non copyable
+
+private:
+	/// \brief Interface method measured
+	struct Method
+	{
+		const char* className;		///< name of the interface (static string of the trace object)
+		const char* methodName;		///< name of the method (static string of the trace object)
+	};
+
+	unsigned int m_id;							///< unique id of this logger for the thread local cache of thread states
+	strus::mutex m_mutex;							///< mutex for defining methods, creating thread states and histograms and for printing
+	Method m_methods[ MaxMethods];						///< methods by index, written with m_mutex locked before being published in m_methodHash
+	unsigned int m_nofMethods;						///< number of methods defined, accessed with m_mutex locked
+	strus::AtomicCounter<unsigned int> m_methodHash[ MethodHashSize];	///< hash of class and method name pointers to the index of the method + 1, 0 if free
+	std::map<unsigned int,ThreadState*> m_threadStates;			///< thread states by thread index, accessed with m_mutex locked
+	strus::AtomicCounter<unsigned int> m_nofUnmeasured;			///< number of calls not measured because there were too many methods or too deeply nested calls
+	FILE* m_file;								///< file the percentiles are printed to
+	unsigned long long m_startTime;						///< creation time of this logger in nanoseconds
+	unsigned int m_nofPrints;						///< number of times the percentiles have been printed
+	strus::AtomicFlag m_stopped;						///< set for stopping the background thread
+	unsigned int m_interval;						///< seconds between printing the percentiles in the background thread
+	strus::thread* m_thread;						///< background thread or NULL if none
+	bool m_closed;								///< true if the final percentiles have been printed
+	ErrorBufferInterface* m_errorhnd;					///< buffer for reporting errors
+};
+
+/// \brief Create a latency histogram trace logger, configuration keys 'file' (file the percentiles are printed to, default stdout) and 'interval' (seconds between printing them, default 0 for printing them on close only)
+TraceLoggerInterface* createTraceLogger_histogram( const std::string& config, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
@@ -0,0 +1,376 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Query processor creating the functions defined by storage modules on first use
+/// \file lazyQueryProcessor.cpp
+#include "lazyQueryProcessor.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/postingJoinOperatorInterface.hpp"
+#include "strus/weightingFunctionInterface.hpp"
+#include "strus/summarizerFunctionInterface.hpp"
+#include "strus/scalarFunctionParserInterface.hpp"
+#include "strus/base/string_conv.hpp"
+#include "loadMetrics.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <algorithm>
+
+using namespace strus;
+using namespace strus::module;
+
+LazyQueryProcessor::LazyQueryProcessor( QueryProcessorInterface* impl_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_)
+	:m_impl(impl_),m_mutex()
+	,m_postingJoinOperatorMap(),m_weightingFunctionMap(),m_summarizerFunctionMap(),m_scalarFunctionParserMap()
+	,m_postingJoinOperators(),m_weightingFunctions(),m_summarizerFunctions(),m_scalarFunctionParsers()
+	,m_metrics(metrics_),m_errorhnd(errorhnd_){}
+
+void LazyQueryProcessor::definePostingJoinOperator( const std::string& name, PostingJoinOperatorInterface* op)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::string key( string_conv::tolower( name));
+		m_postingJoinOperatorMap.erase( key);
+		m_postingJoinOperators.erase( key);
+		m_impl->definePostingJoinOperator( name, op);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining posting join operator: %s"), *m_errorhnd);
+}
+
+const PostingJoinOperatorInterface* LazyQueryProcessor::getPostingJoinOperator( const std::string& name) const
+{
+	try
+	{
+		std::string key( string_conv::tolower( name));
+		const PostingJoinOperatorInterface* rt = m_postingJoinOperators.find( key);
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have published it meanwhile
+		rt = m_postingJoinOperators.find( key);
+		if (rt) return rt;
+		if (!m_postingJoinOperatorMap.empty() && !createPostingJoinOperator( key)) return 0;
+		rt = m_impl->getPostingJoinOperator( name);
+		if (rt) m_postingJoinOperators.insert( key, rt);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting posting join operator: %s"), *m_errorhnd, 0);
+}
+
+void LazyQueryProcessor::defineWeightingFunction( const std::string& name, WeightingFunctionInterface* func)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::string key( string_conv::tolower( name));
+		m_weightingFunctionMap.erase( key);
+		m_weightingFunctions.erase( key);
+		m_impl->defineWeightingFunction( name, func);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining weighting function: %s"), *m_errorhnd);
+}
+
+const WeightingFunctionInterface* LazyQueryProcessor::getWeightingFunction( const std::string& name) const
+{
+	try
+	{
+		std::string key( string_conv::tolower( name));
+		const WeightingFunctionInterface* rt = m_weightingFunctions.find( key);
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have published it meanwhile
+		rt = m_weightingFunctions.find( key);
+		if (rt) return rt;
+		if (!m_weightingFunctionMap.empty() && !createWeightingFunction( key)) return 0;
+		rt = m_impl->getWeightingFunction( name);
+		if (rt) m_weightingFunctions.insert( key, rt);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting weighting function: %s"), *m_errorhnd, 0);
+}
+
+void LazyQueryProcessor::defineSummarizerFunction( const std::string& name, SummarizerFunctionInterface* sumfunc)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::string key( string_conv::tolower( name));
+		m_summarizerFunctionMap.erase( key);
+		m_summarizerFunctions.erase( key);
+		m_impl->defineSummarizerFunction( name, sumfunc);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining summarizer function: %s"), *m_errorhnd);
+}
+
+const SummarizerFunctionInterface* LazyQueryProcessor::getSummarizerFunction( const std::string& name) const
+{
+	try
+	{
+		std::string key( string_conv::tolower( name));
+		const SummarizerFunctionInterface* rt = m_summarizerFunctions.find( key);
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have published it meanwhile
+		rt = m_summarizerFunctions.find( key);
+		if (rt) return rt;
+		if (!m_summarizerFunctionMap.empty() && !createSummarizerFunction( key)) return 0;
+		rt = m_impl->getSummarizerFunction( name);
+		if (rt) m_summarizerFunctions.insert( key, rt);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting summarizer function: %s"), *m_errorhnd, 0);
+}
+
+void LazyQueryProcessor::defineScalarFunctionParser( const std::string& name, ScalarFunctionParserInterface* parser)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::string key( string_conv::tolower( name));
+		m_scalarFunctionParserMap.erase( key);
+		m_scalarFunctionParsers.erase( key);
+		m_impl->defineScalarFunctionParser( name, parser);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining scalar function parser: %s"), *m_errorhnd);
+}
+
+const ScalarFunctionParserInterface* LazyQueryProcessor::getScalarFunctionParser( const std::string& name) const
+{
+	try
+	{
+		std::string key( string_conv::tolower( name));
+		const ScalarFunctionParserInterface* rt = m_scalarFunctionParsers.find( key);
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have published it meanwhile
+		rt = m_scalarFunctionParsers.find( key);
+		if (rt) return rt;
+		if (!m_scalarFunctionParserMap.empty() && !createScalarFunctionParser( key)) return 0;
+		rt = m_impl->getScalarFunctionParser( name);
+		if (rt) m_scalarFunctionParsers.insert( key, rt);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting scalar function parser: %s"), *m_errorhnd, 0);
+}
+
+template <typename Create>
+static void appendKeys( std::vector<std::string>& res, const std::map<std::string,Create>& map)
+{
+	typename std::map<std::string,Create>::const_iterator mi = map.begin(), me = map.end();
+	for (; mi != me; ++mi)
+	{
+		if (std::find( res.begin(), res.end(), mi->first) == res.end())
+		{
+			res.push_back( mi->first);
+		}
+	}
+}
+
+std::vector<std::string> LazyQueryProcessor::getFunctionList( const FunctionType& type) const
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::vector<std::string> rt = m_impl->getFunctionList( type);
+		switch (type)
+		{
+			case PostingJoinOperator: appendKeys( rt, m_postingJoinOperatorMap); break;
+			case WeightingFunction: appendKeys( rt, m_weightingFunctionMap); break;
+			case SummarizerFunction: appendKeys( rt, m_summarizerFunctionMap); break;
+			case ScalarFunctionParser: appendKeys( rt, m_scalarFunctionParserMap); break;
+		}
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting function list of query processor: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+StructView LazyQueryProcessor::view() const
+{
+	try
+	{
+		// ... the description of a function is provided by the function itself, so we have to create them all:
+		strus::scoped_lock lock( m_mutex);
+		createAllFunctions();
+		return m_impl->view();
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting description of query processor: %s"), *m_errorhnd, StructView());
+}
+
+void LazyQueryProcessor::registerPostingJoinOperators( const PostingIteratorJoinConstructor* ar)
+{
+	strus::scoped_lock lock( m_mutex);
+	for (; ar->create != 0; ++ar)
+	{
+		std::string key( string_conv::tolower( ar->name));
+		m_postingJoinOperatorMap[ key] = ar->create;
+		m_postingJoinOperators.erase( key);
+	}
+}
+
+void LazyQueryProcessor::registerWeightingFunctions( const WeightingFunctionConstructor* ar)
+{
+	strus::scoped_lock lock( m_mutex);
+	for (; ar->create != 0; ++ar)
+	{
+		std::string key( string_conv::tolower( ar->name));
+		m_weightingFunctionMap[ key] = ar->create;
+		m_weightingFunctions.erase( key);
+	}
+}
+
+void LazyQueryProcessor::registerSummarizerFunctions( const SummarizerFunctionConstructor* ar)
+{
+	strus::scoped_lock lock( m_mutex);
+	for (; ar->create != 0; ++ar)
+	{
+		std::string key( string_conv::tolower( ar->name));
+		m_summarizerFunctionMap[ key] = ar->create;
+		m_summarizerFunctions.erase( key);
+	}
+}
+
+void LazyQueryProcessor::registerScalarFunctionParsers( const ScalarFunctionParserConstructor* ar)
+{
+	strus::scoped_lock lock( m_mutex);
+	for (; ar->create != 0; ++ar)
+	{
+		std::string key( string_conv::tolower( ar->name));
+		m_scalarFunctionParserMap[ key] = ar->create;
+		m_scalarFunctionParsers.erase( key);
+	}
+}
+
+void LazyQueryProcessor::createAllFunctions() const
+{
+	while (!m_postingJoinOperatorMap.empty())
+	{
+		std::string key( m_postingJoinOperatorMap.begin()->first);
+		if (!createPostingJoinOperator( key)) throw std::runtime_error( m_errorhnd->fetchError());
+	}
+	while (!m_weightingFunctionMap.empty())
+	{
+		std::string key( m_weightingFunctionMap.begin()->first);
+		if (!createWeightingFunction( key)) throw std::runtime_error( m_errorhnd->fetchError());
+	}
+	while (!m_summarizerFunctionMap.empty())
+	{
+		std::string key( m_summarizerFunctionMap.begin()->first);
+		if (!createSummarizerFunction( key)) throw std::runtime_error( m_errorhnd->fetchError());
+	}
+	while (!m_scalarFunctionParserMap.empty())
+	{
+		std::string key( m_scalarFunctionParserMap.begin()->first);
+		if (!createScalarFunctionParser( key)) throw std::runtime_error( m_errorhnd->fetchError());
+	}
+}
+
+// The create methods below are called with the mutex locked. They return true
+// if there was nothing to create or if the function was created and defined successfully:
+
+bool LazyQueryProcessor::createPostingJoinOperator( const std::string& key) const
+{
+	std::map<std::string,PostingIteratorJoinConstructor::Create>::iterator ci = m_postingJoinOperatorMap.find( key);
+	if (ci == m_postingJoinOperatorMap.end()) return true;
+
+	double starttime = getMonotonicTime();
+	PostingJoinOperatorInterface* func = ci->second( m_errorhnd);
+	if (!func)
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating posting join operator '%s'"), key.c_str());
+		return false;
+	}
+	double createTime = getMonotonicTime() - starttime;
+	m_postingJoinOperatorMap.erase( ci);
+	// ... the ownership of the function is passed with the define also if it fails, so it must not be deleted here
+	bool hadError = m_errorhnd->hasError();
+	m_impl->definePostingJoinOperator( key, func);
+	if (!hadError && m_errorhnd->hasError())
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining posting join operator '%s'"), key.c_str());
+		return false;
+	}
+	if (m_metrics) m_metrics->add( "joinop", key, createTime);
+	return true;
+}
+
+bool LazyQueryProcessor::createWeightingFunction( const std::string& key) const
+{
+	std::map<std::string,WeightingFunctionConstructor::Create>::iterator ci = m_weightingFunctionMap.find( key);
+	if (ci == m_weightingFunctionMap.end()) return true;
+
+	double starttime = getMonotonicTime();
+	WeightingFunctionInterface* func = ci->second( m_errorhnd);
+	if (!func)
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating weighting function '%s'"), key.c_str());
+		return false;
+	}
+	double createTime = getMonotonicTime() - starttime;
+	m_weightingFunctionMap.erase( ci);
+	// ... the ownership of the function is passed with the define also if it fails, so it must not be deleted here
+	bool hadError = m_errorhnd->hasError();
+	m_impl->defineWeightingFunction( key, func);
+	if (!hadError && m_errorhnd->hasError())
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining weighting function '%s'"), key.c_str());
+		return false;
+	}
+	if (m_metrics) m_metrics->add( "weighting", key, createTime);
+	return true;
+}
+
+bool LazyQueryProcessor::createSummarizerFunction( const std::string& key) const
+{
+	std::map<std::string,SummarizerFunctionConstructor::Create>::iterator ci = m_summarizerFunctionMap.find( key);
+	if (ci == m_summarizerFunctionMap.end()) return true;
+
+	double starttime = getMonotonicTime();
+	SummarizerFunctionInterface* func = ci->second( m_errorhnd);
+	if (!func)
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating summarizer function '%s'"), key.c_str());
+		return false;
+	}
+	double createTime = getMonotonicTime() - starttime;
+	m_summarizerFunctionMap.erase( ci);
+	// ... the ownership of the function is passed with the define also if it fails, so it must not be deleted here
+	bool hadError = m_errorhnd->hasError();
+	m_impl->defineSummarizerFunction( key, func);
+	if (!hadError && m_errorhnd->hasError())
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining summarizer function '%s'"), key.c_str());
+		return false;
+	}
+	if (m_metrics) m_metrics->add( "summarizer", key, createTime);
+	return true;
+}
+
+bool LazyQueryProcessor::createScalarFunctionParser( const std::string& key) const
+{
+	std::map<std::string,ScalarFunctionParserConstructor::Create>::iterator ci = m_scalarFunctionParserMap.find( key);
+	if (ci == m_scalarFunctionParserMap.end()) return true;
+
+	double starttime = getMonotonicTime();
+	ScalarFunctionParserInterface* func = ci->second( m_errorhnd);
+	if (!func)
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating scalar function parser '%s'"), key.c_str());
+		return false;
+	}
+	double createTime = getMonotonicTime() - starttime;
+	m_scalarFunctionParserMap.erase( ci);
+	// ... the ownership of the function is passed with the define also if it fails, so it must not be deleted here
+	bool hadError = m_errorhnd->hasError();
+	m_impl->defineScalarFunctionParser( key, func);
+	if (!hadError && m_errorhnd->hasError())
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining scalar function parser '%s'"), key.c_str());
+		return false;
+	}
+	if (m_metrics) m_metrics->add( "scalarparser", key, createTime);
+	return true;
+}
+
@@ -0,0 +1,91 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Query processor creating the functions defined by storage modules on first use
+/// \file lazyQueryProcessor.hpp
+#ifndef _STRUS_MODULE_LAZY_QUERY_PROCESSOR_HPP_INCLUDED
+#define _STRUS_MODULE_LAZY_QUERY_PROCESSOR_HPP_INCLUDED
+#include "strus/queryProcessorInterface.hpp"
+#include "strus/storageModule.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/thread.hpp"
+#include "publishedFunctionMap.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+class ErrorBufferInterface;
+class ConstructorMetricsCollector;
+
+namespace module
+{
+
+/// \brief Query processor proxy that records the constructors of functions loaded from modules by name and creates the function on the first lookup
+/// \note Functions defined directly or already created are owned by the query processor wrapped.
+///		The functions found are published in maps read without lock, only the lookup of a function not found before takes the lock.
+///		A constructor registered later for the same name replaces a function defined before, as an eager define would do.
+class LazyQueryProcessor
+	:public QueryProcessorInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] impl_ query processor wrapped (ownership passed)
+	/// \param[in] metrics_ collector of the time spent in constructors or NULL
+	/// \param[in] errorhnd_ buffer for reporting errors
+	LazyQueryProcessor( QueryProcessorInterface* impl_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_);
+	virtual ~LazyQueryProcessor(){}
+
+	virtual void definePostingJoinOperator( const std::string& name, PostingJoinOperatorInterface* op);
+	virtual const PostingJoinOperatorInterface* getPostingJoinOperator( const std::string& name) const;
+
+	virtual void defineWeightingFunction( const std::string& name, WeightingFunctionInterface* func);
+	virtual const WeightingFunctionInterface* getWeightingFunction( const std::string& name) const;
+
+	virtual void defineSummarizerFunction( const std::string& name, SummarizerFunctionInterface* sumfunc);
+	virtual const SummarizerFunctionInterface* getSummarizerFunction( const std::string& name) const;
+
+	virtual std::vector<std::string> getFunctionList( const FunctionType& type) const;
+
+	virtual void defineScalarFunctionParser( const std::string& name, ScalarFunctionParserInterface* parser);
+	virtual const ScalarFunctionParserInterface* getScalarFunctionParser( const std::string& name) const;
+
+	virtual StructView view() const;
+
+public/*StorageObjectBuilder*/:
+	/// \brief Register the constructors of a list terminated by an element with create==0
+	void registerPostingJoinOperators( const PostingIteratorJoinConstructor* ar);
+	void registerWeightingFunctions( const WeightingFunctionConstructor* ar);
+	void registerSummarizerFunctions( const SummarizerFunctionConstructor* ar);
+	void registerScalarFunctionParsers( const ScalarFunctionParserConstructor* ar);
+
+private:
+	void createAllFunctions() const;
+	bool createPostingJoinOperator( const std::string& key) const;
+	bool createWeightingFunction( const std::string& key) const;
+	bool createSummarizerFunction( const std::string& key) const;
+	bool createScalarFunctionParser( const std::string& key) const;
+
+private:
+	Reference<QueryProcessorInterface> m_impl;						///< query processor owning the functions created
+	mutable strus::mutex m_mutex;								///< mutex for creating functions on lookup
+	mutable std::map<std::string,PostingIteratorJoinConstructor::Create> m_postingJoinOperatorMap;	///< posting join operators not created yet
+	mutable std::map<std::string,WeightingFunctionConstructor::Create> m_weightingFunctionMap;	///< weighting functions not created yet
+	mutable std::map<std::string,SummarizerFunctionConstructor::Create> m_summarizerFunctionMap;	///< summarizer functions not created yet
+	mutable std::map<std::string,ScalarFunctionParserConstructor::Create> m_scalarFunctionParserMap;///< scalar function parsers not created yet
+	mutable PublishedFunctionMap<PostingJoinOperatorInterface> m_postingJoinOperators;		///< posting join operators found
+	mutable PublishedFunctionMap<WeightingFunctionInterface> m_weightingFunctions;			///< weighting functions found
+	mutable PublishedFunctionMap<SummarizerFunctionInterface> m_summarizerFunctions;		///< summarizer functions found
+	mutable PublishedFunctionMap<ScalarFunctionParserInterface> m_scalarFunctionParsers;		///< scalar function parsers found
+	ConstructorMetricsCollector* m_metrics;							///< collector of the time spent in constructors or NULL
+	ErrorBufferInterface* m_errorhnd;							///< buffer for reporting errors
+};
+
+}}//namespace
+#endif
+
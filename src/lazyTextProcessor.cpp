@@ -0,0 +1,503 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Text processor creating the functions defined by analyzer modules on first use
+/// \file lazyTextProcessor.cpp
+#include "lazyTextProcessor.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/debugTraceInterface.hpp"
+#include "strus/tokenizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/aggregatorFunctionInterface.hpp"
+#include "strus/patternLexerInterface.hpp"
+#include "strus/patternMatcherInterface.hpp"
+#include "strus/base/string_conv.hpp"
+#include "loadMetrics.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <algorithm>
+#include <cstring>
+
+using namespace strus;
+using namespace strus::module;
+
+LazyTextProcessor::LazyTextProcessor( TextProcessorInterface* impl_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_)
+	:m_impl(impl_),m_mutex()
+	,m_tokenizerMap( "tokenizer", &TextProcessorInterface::defineTokenizer, &TextProcessorInterface::getTokenizer)
+	,m_normalizerMap( "normalizer", &TextProcessorInterface::defineNormalizer, &TextProcessorInterface::getNormalizer)
+	,m_aggregatorMap( "aggregator", &TextProcessorInterface::defineAggregator, &TextProcessorInterface::getAggregator)
+	,m_patternLexerMap( "pattern lexer", &TextProcessorInterface::definePatternLexer, &TextProcessorInterface::getPatternLexer)
+	,m_patternMatcherMap( "pattern matcher", &TextProcessorInterface::definePatternMatcher, &TextProcessorInterface::getPatternMatcher)
+	,m_nofRegistered(0),m_nofCreated(0)
+	,m_metrics(metrics_),m_errorhnd(errorhnd_),m_debugtrace(0)
+{
+	DebugTraceInterface* dbg = m_errorhnd->debugTrace();
+	if (dbg) m_debugtrace = dbg->createTraceContext( "module");
+}
+
+LazyTextProcessor::~LazyTextProcessor()
+{
+	if (m_debugtrace) delete m_debugtrace;
+}
+
+template <class Constructor>
+int LazyTextProcessor::SortedTable<Constructor>::find( const std::string& key) const
+{
+	std::size_t first = 0, last = size;
+	while (first < last)
+	{
+		std::size_t mid = (first + last) / 2;
+		int cmp = std::strcmp( ar[ mid].name, key.c_str());
+		if (cmp == 0) return (int)mid;
+		if (cmp < 0)
+		{
+			first = mid+1;
+		}
+		else
+		{
+			last = mid;
+		}
+	}
+	return -1;
+}
+
+template <class Interface, class Constructor>
+void LazyTextProcessor::ConstructorMap<Interface,Constructor>::markDone( const std::string& key)
+{
+	typename TableList::iterator ti = tables.begin(), te = tables.end();
+	for (; ti != te; ++ti)
+	{
+		int idx = ti->find( key);
+		if (idx >= 0 && !ti->done[ idx])
+		{
+			ti->done[ idx] = true;
+			--nofPending;
+		}
+	}
+}
+
+template <class Interface, class Constructor>
+const Interface* LazyTextProcessor::getFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& name) const
+{
+	std::string key( string_conv::tolower( name));
+	const Interface* rt = cmap.published.find( key);
+	if (rt) return rt;
+	strus::scoped_lock lock( m_mutex);
+	// ... check again with the lock held, another thread might have published it meanwhile
+	rt = cmap.published.find( key);
+	if (rt) return rt;
+	if (!cmap.empty() && !createFunction( cmap, key)) return 0;
+	rt = (m_impl.get()->*cmap.get)( name);
+	if (rt) cmap.published.insert( key, rt);
+	return rt;
+}
+
+template <class Interface, class Constructor>
+bool LazyTextProcessor::createFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& key) const
+{
+	// ... called with the mutex locked, returns true if there was nothing to create or if the function was created and defined successfully
+	typename Constructor::Create create = 0;
+	typename ConstructorMap<Interface,Constructor>::Map::iterator ci = cmap.map.find( key);
+	if (ci != cmap.map.end())
+	{
+		create = ci->second;
+	}
+	else
+	{
+		// ... the sorted table registered last that defines the name decides:
+		typename ConstructorMap<Interface,Constructor>::TableList::const_reverse_iterator ti = cmap.tables.rbegin(), te = cmap.tables.rend();
+		for (; ti != te; ++ti)
+		{
+			int idx = ti->find( key);
+			if (idx >= 0)
+			{
+				if (ti->done[ idx]) return true;
+				create = ti->ar[ idx].create;
+				break;
+			}
+		}
+		if (!create) return true;
+	}
+	double starttime = getMonotonicTime();
+	Interface* func = create( m_errorhnd);
+	if (!func)
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating %s '%s'"), cmap.typeName, key.c_str());
+		return false;
+	}
+	double createTime = getMonotonicTime() - starttime;
+	if (ci != cmap.map.end()) cmap.map.erase( ci);
+	cmap.markDone( key);
+	// ... the ownership of the function is passed with the define also if it fails, so it must not be deleted here
+	bool hadError = m_errorhnd->hasError();
+	(m_impl.get()->*cmap.define)( key, func);
+	if (!hadError && m_errorhnd->hasError())
+	{
+		m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining %s '%s'"), cmap.typeName, key.c_str());
+		return false;
+	}
+	if (m_metrics) m_metrics->add( cmap.typeName, key, createTime);
+	++m_nofCreated;
+	if (m_debugtrace) m_debugtrace->event( "create", "%s %s (%u of %u functions registered created)", cmap.typeName, key.c_str(), m_nofCreated, m_nofRegistered);
+	return true;
+}
+
+template <class Interface, class Constructor>
+void LazyTextProcessor::createAllFunctions( ConstructorMap<Interface,Constructor>& cmap) const
+{
+	while (!cmap.map.empty())
+	{
+		std::string key( cmap.map.begin()->first);
+		if (!createFunction( cmap, key)) throw std::runtime_error( m_errorhnd->fetchError());
+	}
+	// ... creating a function marks the constructors of its name in all tables as done, so the ones replaced by a later table are skipped:
+	typename ConstructorMap<Interface,Constructor>::TableList::reverse_iterator ti = cmap.tables.rbegin(), te = cmap.tables.rend();
+	for (; cmap.nofPending > 0 && ti != te; ++ti)
+	{
+		for (std::size_t idx=0; idx < ti->size; ++idx)
+		{
+			if (ti->done[ idx]) continue;
+			if (!createFunction( cmap, ti->ar[ idx].name)) throw std::runtime_error( m_errorhnd->fetchError());
+		}
+	}
+}
+
+template <class Interface, class Constructor>
+void LazyTextProcessor::registerFunction( ConstructorMap<Interface,Constructor>& cmap, const char* name, typename Constructor::Create create)
+{
+	std::string key( string_conv::tolower( name));
+	cmap.map[ key] = create;
+	cmap.published.erase( key);
+	++m_nofRegistered;
+}
+
+/// \brief Test if an element of a table flagged as sorted has a lower case name greater than the name of the element before
+template <class Constructor>
+static bool isSortedTableEntry( const Constructor* ar, std::size_t idx)
+{
+	const char* name = ar[ idx].name;
+	if (!name) return false;
+	const char* ni = name;
+	for (; *ni; ++ni)
+	{
+		if (*ni >= 'A' && *ni <= 'Z') return false;
+	}
+	return idx == 0 || std::strcmp( ar[ idx-1].name, name) < 0;
+}
+
+template <class Interface, class Constructor>
+void LazyTextProcessor::registerFunctions( ConstructorMap<Interface,Constructor>& cmap, const Constructor* ar, bool sorted)
+{
+	if (!sorted)
+	{
+		for (; ar->create != 0; ++ar) registerFunction( cmap, ar->name, ar->create);
+		return;
+	}
+	// ... the flag is not validated at compile time without C++11, so the order is checked here once, a table not sorted is registered in the map
+	std::size_t size = 0;
+	for (; ar[ size].create != 0; ++size)
+	{
+		if (!isSortedTableEntry( ar, size))
+		{
+			if (m_debugtrace) m_debugtrace->event( "unsorted", "%s table with '%s' registered by name", cmap.typeName, ar[ size].name);
+			for (; ar->create != 0; ++ar) registerFunction( cmap, ar->name, ar->create);
+			return;
+		}
+	}
+	if (size == 0) return;
+	cmap.tables.push_back( SortedTable<Constructor>( ar, size));
+	cmap.nofPending += size;
+	m_nofRegistered += size;
+
+	// ... constructors registered before in the map and functions found before are replaced by the ones of the table:
+	const SortedTable<Constructor>& table = cmap.tables.back();
+	for (std::size_t idx=0; idx < size; ++idx) cmap.published.erase( ar[ idx].name);
+	typename ConstructorMap<Interface,Constructor>::Map::iterator mi = cmap.map.begin();
+	while (mi != cmap.map.end())
+	{
+		if (table.find( mi->first) >= 0)
+		{
+			cmap.map.erase( mi++);
+		}
+		else
+		{
+			++mi;
+		}
+	}
+}
+
+template <class Interface, class Constructor>
+void LazyTextProcessor::removeFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& key)
+{
+	cmap.map.erase( key);
+	if (cmap.nofPending > 0) cmap.markDone( key);
+	cmap.published.erase( key);
+}
+
+const SegmenterInterface* LazyTextProcessor::getSegmenterByName( const std::string& name) const
+{
+	return m_impl->getSegmenterByName( name);
+}
+
+const SegmenterInterface* LazyTextProcessor::getSegmenterByMimeType( const std::string& mimetype) const
+{
+	return m_impl->getSegmenterByMimeType( mimetype);
+}
+
+analyzer::SegmenterOptions LazyTextProcessor::getSegmenterOptions( const std::string& scheme) const
+{
+	return m_impl->getSegmenterOptions( scheme);
+}
+
+const TokenizerFunctionInterface* LazyTextProcessor::getTokenizer( const std::string& name) const
+{
+	try
+	{
+		return getFunction( m_tokenizerMap, name);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting tokenizer: %s"), *m_errorhnd, 0);
+}
+
+const NormalizerFunctionInterface* LazyTextProcessor::getNormalizer( const std::string& name) const
+{
+	try
+	{
+		return getFunction( m_normalizerMap, name);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting normalizer: %s"), *m_errorhnd, 0);
+}
+
+const AggregatorFunctionInterface* LazyTextProcessor::getAggregator( const std::string& name) const
+{
+	try
+	{
+		return getFunction( m_aggregatorMap, name);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting aggregator: %s"), *m_errorhnd, 0);
+}
+
+const PatternLexerInterface* LazyTextProcessor::getPatternLexer( const std::string& name) const
+{
+	try
+	{
+		return getFunction( m_patternLexerMap, name);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting pattern lexer: %s"), *m_errorhnd, 0);
+}
+
+const PatternMatcherInterface* LazyTextProcessor::getPatternMatcher( const std::string& name) const
+{
+	try
+	{
+		return getFunction( m_patternMatcherMap, name);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting pattern matcher: %s"), *m_errorhnd, 0);
+}
+
+const PatternTermFeederInterface* LazyTextProcessor::getPatternTermFeeder() const
+{
+	return m_impl->getPatternTermFeeder();
+}
+
+const PosTaggerInterface* LazyTextProcessor::getPosTagger() const
+{
+	return m_impl->getPosTagger();
+}
+
+PosTaggerDataInterface* LazyTextProcessor::createPosTaggerData( TokenizerFunctionInstanceInterface* tokenizer) const
+{
+	return m_impl->createPosTaggerData( tokenizer);
+}
+
+TokenMarkupInstanceInterface* LazyTextProcessor::createTokenMarkupInstance() const
+{
+	return m_impl->createTokenMarkupInstance();
+}
+
+bool LazyTextProcessor::detectDocumentClass(
+		analyzer::DocumentClass& dclass,
+		const char* contentBegin,
+		std::size_t contentBeginSize,
+		bool isComplete) const
+{
+	return m_impl->detectDocumentClass( dclass, contentBegin, contentBeginSize, isComplete);
+}
+
+void LazyTextProcessor::defineDocumentClassDetector( DocumentClassDetectorInterface* detector)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_impl->defineDocumentClassDetector( detector);
+}
+
+void LazyTextProcessor::defineSegmenter( const std::string& name, SegmenterInterface* segmenter)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_impl->defineSegmenter( name, segmenter);
+}
+
+void LazyTextProcessor::defineSegmenterOptions( const std::string& scheme, const analyzer::SegmenterOptions& options)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_impl->defineSegmenterOptions( scheme, options);
+}
+
+void LazyTextProcessor::defineTokenizer( const std::string& name, TokenizerFunctionInterface* tokenizer)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		removeFunction( m_tokenizerMap, string_conv::tolower( name));
+		m_impl->defineTokenizer( name, tokenizer);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining tokenizer: %s"), *m_errorhnd);
+}
+
+void LazyTextProcessor::defineNormalizer( const std::string& name, NormalizerFunctionInterface* normalizer)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		removeFunction( m_normalizerMap, string_conv::tolower( name));
+		m_impl->defineNormalizer( name, normalizer);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining normalizer: %s"), *m_errorhnd);
+}
+
+void LazyTextProcessor::defineAggregator( const std::string& name, AggregatorFunctionInterface* statfunc)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		removeFunction( m_aggregatorMap, string_conv::tolower( name));
+		m_impl->defineAggregator( name, statfunc);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining aggregator: %s"), *m_errorhnd);
+}
+
+void LazyTextProcessor::definePatternLexer( const std::string& name, PatternLexerInterface* lexer)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		removeFunction( m_patternLexerMap, string_conv::tolower( name));
+		m_impl->definePatternLexer( name, lexer);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining pattern lexer: %s"), *m_errorhnd);
+}
+
+void LazyTextProcessor::definePatternMatcher( const std::string& name, PatternMatcherInterface* matcher)
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		removeFunction( m_patternMatcherMap, string_conv::tolower( name));
+		m_impl->definePatternMatcher( name, matcher);
+	}
+	CATCH_ERROR_MAP( _TXT("error defining pattern matcher: %s"), *m_errorhnd);
+}
+
+void LazyTextProcessor::definePosTagger( PosTaggerInterface* postagger)
+{
+	strus::scoped_lock lock( m_mutex);
+	m_impl->definePosTagger( postagger);
+}
+
+template <typename Create>
+static void appendKeys( std::vector<std::string>& res, const std::map<std::string,Create>& map)
+{
+	typename std::map<std::string,Create>::const_iterator mi = map.begin(), me = map.end();
+	for (; mi != me; ++mi)
+	{
+		if (std::find( res.begin(), res.end(), mi->first) == res.end())
+		{
+			res.push_back( mi->first);
+		}
+	}
+}
+
+template <class Table>
+static void appendKeys( std::vector<std::string>& res, const std::vector<Table>& tables)
+{
+	typename std::vector<Table>::const_iterator ti = tables.begin(), te = tables.end();
+	for (; ti != te; ++ti)
+	{
+		for (std::size_t idx=0; idx < ti->size; ++idx)
+		{
+			if (!ti->done[ idx] && std::find( res.begin(), res.end(), ti->ar[ idx].name) == res.end())
+			{
+				res.push_back( ti->ar[ idx].name);
+			}
+		}
+	}
+}
+
+std::vector<std::string> LazyTextProcessor::getFunctionList( const FunctionType& type) const
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::vector<std::string> rt = m_impl->getFunctionList( type);
+		switch (type)
+		{
+			case Segmenter: break;
+			case Tokenizer: appendKeys( rt, m_tokenizerMap.map); appendKeys( rt, m_tokenizerMap.tables); break;
+			case Normalizer: appendKeys( rt, m_normalizerMap.map); appendKeys( rt, m_normalizerMap.tables); break;
+			case Aggregator: appendKeys( rt, m_aggregatorMap.map); appendKeys( rt, m_aggregatorMap.tables); break;
+			case PatternLexer: appendKeys( rt, m_patternLexerMap.map); appendKeys( rt, m_patternLexerMap.tables); break;
+			case PatternMatcher: appendKeys( rt, m_patternMatcherMap.map); appendKeys( rt, m_patternMatcherMap.tables); break;
+		}
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting function list of text processor: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+StructView LazyTextProcessor::view() const
+{
+	try
+	{
+		// ... the description of a function is provided by the function itself, so we have to create them all:
+		strus::scoped_lock lock( m_mutex);
+		createAllFunctions( m_tokenizerMap);
+		createAllFunctions( m_normalizerMap);
+		createAllFunctions( m_aggregatorMap);
+		createAllFunctions( m_patternLexerMap);
+		createAllFunctions( m_patternMatcherMap);
+		return m_impl->view();
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting description of text processor: %s"), *m_errorhnd, StructView());
+}
+
+void LazyTextProcessor::registerTokenizers( const TokenizerConstructor* ar, bool sorted)
+{
+	strus::scoped_lock lock( m_mutex);
+	registerFunctions( m_tokenizerMap, ar, sorted);
+}
+
+void LazyTextProcessor::registerNormalizers( const NormalizerConstructor* ar, bool sorted)
+{
+	strus::scoped_lock lock( m_mutex);
+	registerFunctions( m_normalizerMap, ar, sorted);
+}
+
+void LazyTextProcessor::registerAggregators( const AggregatorConstructor* ar, bool sorted)
+{
+	strus::scoped_lock lock( m_mutex);
+	registerFunctions( m_aggregatorMap, ar, sorted);
+}
+
+void LazyTextProcessor::registerPatternLexer( const PatternLexerConstructor& constructor)
+{
+	strus::scoped_lock lock( m_mutex);
+	registerFunction( m_patternLexerMap, constructor.name, constructor.create);
+}
+
+void LazyTextProcessor::registerPatternMatcher( const PatternMatcherConstructor& constructor)
+{
+	strus::scoped_lock lock( m_mutex);
+	registerFunction( m_patternMatcherMap, constructor.name, constructor.create);
+}
+
@@ -0,0 +1,177 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Text processor creating the functions defined by analyzer modules on first use
+/// \file lazyTextProcessor.hpp
+#ifndef _STRUS_MODULE_LAZY_TEXT_PROCESSOR_HPP_INCLUDED
+#define _STRUS_MODULE_LAZY_TEXT_PROCESSOR_HPP_INCLUDED
+#include "strus/textProcessorInterface.hpp"
+#include "strus/analyzerModule.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/thread.hpp"
+#include "publishedFunctionMap.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+class ErrorBufferInterface;
+class DebugTraceContextInterface;
+class ConstructorMetricsCollector;
+
+namespace module
+{
+
+/// \brief Text processor proxy that records the constructors of functions loaded from modules by name and creates the function on the first lookup
+/// \note Functions defined directly or already created are owned by the text processor wrapped.
+///		A constructor registered later for the same name replaces a function defined before, as an eager define would do.
+/// \note Segmenters are not created lazily, because the text processor needs the segmenter object for the lookup by MIME type.
+/// \note The functions found are published in maps read without lock, only the lookup of a function not found before takes the lock.
+class LazyTextProcessor
+	:public TextProcessorInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] impl_ text processor wrapped (ownership passed)
+	/// \param[in] metrics_ collector of the time spent in constructors or NULL
+	/// \param[in] errorhnd_ buffer for reporting errors
+	LazyTextProcessor( TextProcessorInterface* impl_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_);
+	virtual ~LazyTextProcessor();
+
+	virtual const SegmenterInterface* getSegmenterByName( const std::string& name) const;
+	virtual const SegmenterInterface* getSegmenterByMimeType( const std::string& mimetype) const;
+	virtual analyzer::SegmenterOptions getSegmenterOptions( const std::string& scheme) const;
+	virtual const TokenizerFunctionInterface* getTokenizer( const std::string& name) const;
+	virtual const NormalizerFunctionInterface* getNormalizer( const std::string& name) const;
+	virtual const AggregatorFunctionInterface* getAggregator( const std::string& name) const;
+	virtual const PatternLexerInterface* getPatternLexer( const std::string& name) const;
+	virtual const PatternMatcherInterface* getPatternMatcher( const std::string& name) const;
+	virtual const PatternTermFeederInterface* getPatternTermFeeder() const;
+	virtual const PosTaggerInterface* getPosTagger() const;
+	virtual PosTaggerDataInterface* createPosTaggerData( TokenizerFunctionInstanceInterface* tokenizer) const;
+	virtual TokenMarkupInstanceInterface* createTokenMarkupInstance() const;
+	virtual bool detectDocumentClass(
+			analyzer::DocumentClass& dclass,
+			const char* contentBegin,
+			std::size_t contentBeginSize,
+			bool isComplete) const;
+
+	virtual void defineDocumentClassDetector( DocumentClassDetectorInterface* detector);
+	virtual void defineSegmenter( const std::string& name, SegmenterInterface* segmenter);
+	virtual void defineSegmenterOptions( const std::string& scheme, const analyzer::SegmenterOptions& options);
+	virtual void defineTokenizer( const std::string& name, TokenizerFunctionInterface* tokenizer);
+	virtual void defineNormalizer( const std::string& name, NormalizerFunctionInterface* normalizer);
+	virtual void defineAggregator( const std::string& name, AggregatorFunctionInterface* statfunc);
+	virtual void definePatternLexer( const std::string& name, PatternLexerInterface* lexer);
+	virtual void definePatternMatcher( const std::string& name, PatternMatcherInterface* matcher);
+	virtual void definePosTagger( PosTaggerInterface* postagger);
+
+	virtual std::vector<std::string> getFunctionList( const FunctionType& type) const;
+	virtual StructView view() const;
+
+public/*AnalyzerObjectBuilder*/:
+	/// \brief Register the constructors of a list terminated by an element with create==0
+	/// \param[in] ar list of constructors
+	/// \param[in] sorted true if the list is sorted by name with unique lower case names (ModuleEntryPoint::FlagSortedConstructorTables),
+	///		then the list is registered as a whole without copying its names and looked up by binary search.
+	///		The order is checked once in O(n), a list flagged as sorted that is not is registered by name
+	void registerTokenizers( const TokenizerConstructor* ar, bool sorted=false);
+	void registerNormalizers( const NormalizerConstructor* ar, bool sorted=false);
+	void registerAggregators( const AggregatorConstructor* ar, bool sorted=false);
+	/// \brief Register a single constructor
+	void registerPatternLexer( const PatternLexerConstructor& constructor);
+	void registerPatternMatcher( const PatternMatcherConstructor& constructor);
+
+private:
+	/// \brief List of constructors sorted by name with unique lower case names registered as a whole
+	template <class Constructor>
+	struct SortedTable
+	{
+		const Constructor* ar;		///< constructors
+		std::size_t size;		///< number of constructors
+		std::vector<bool> done;		///< flags marking the constructors called or replaced by a later definition
+
+		SortedTable( const Constructor* ar_, std::size_t size_)
+			:ar(ar_),size(size_),done(size_,false){}
+		SortedTable( const SortedTable& o)
+			:ar(o.ar),size(o.size),done(o.done){}
+
+		/// \brief Find a constructor by binary search
+		/// \param[in] key name in lower case
+		/// \return index of the constructor or -1 if not found
+		int find( const std::string& key) const;
+	};
+
+	/// \brief Map of function names to the constructors not called yet
+	/// \note A name is looked up in the map first and then in the sorted tables from the last registered to the first.
+	///		The entries of the map registered before a sorted table defining the same name are removed when the table is registered.
+	template <class Interface, class Constructor>
+	struct ConstructorMap
+	{
+		typedef typename Constructor::Create Create;
+		typedef void (TextProcessorInterface::*Define)( const std::string& name, Interface* func);
+		typedef const Interface* (TextProcessorInterface::*Get)( const std::string& name) const;
+		typedef std::map<std::string,Create> Map;
+		typedef std::vector<SortedTable<Constructor> > TableList;
+
+		Map map;		///< constructors not called yet
+		TableList tables;	///< sorted tables registered
+		std::size_t nofPending;	///< number of constructors in tables not marked as done
+		const char* typeName;	///< name of the function type for messages
+		Define define;		///< method to define the function created in the text processor wrapped
+		Get get;		///< method to get a function from the text processor wrapped
+		PublishedFunctionMap<Interface> published;	///< functions found, read without lock
+
+		ConstructorMap( const char* typeName_, Define define_, Get get_)
+			:map(),tables(),nofPending(0),typeName(typeName_),define(define_),get(get_),published(){}
+
+		/// \brief Test if there are no constructors left to call
+		bool empty() const
+		{
+			return map.empty() && nofPending == 0;
+		}
+		/// \brief Mark the constructors of a name in the sorted tables as done
+		void markDone( const std::string& key);
+	};
+	typedef ConstructorMap<TokenizerFunctionInterface,TokenizerConstructor> TokenizerMap;
+	typedef ConstructorMap<NormalizerFunctionInterface,NormalizerConstructor> NormalizerMap;
+	typedef ConstructorMap<AggregatorFunctionInterface,AggregatorConstructor> AggregatorMap;
+	typedef ConstructorMap<PatternLexerInterface,PatternLexerConstructor> PatternLexerMap;
+	typedef ConstructorMap<PatternMatcherInterface,PatternMatcherConstructor> PatternMatcherMap;
+
+	template <class Interface, class Constructor>
+	const Interface* getFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& name) const;
+	template <class Interface, class Constructor>
+	bool createFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& key) const;
+	template <class Interface, class Constructor>
+	void createAllFunctions( ConstructorMap<Interface,Constructor>& cmap) const;
+	template <class Interface, class Constructor>
+	void registerFunction( ConstructorMap<Interface,Constructor>& cmap, const char* name, typename Constructor::Create create);
+	template <class Interface, class Constructor>
+	void registerFunctions( ConstructorMap<Interface,Constructor>& cmap, const Constructor* ar, bool sorted);
+	template <class Interface, class Constructor>
+	void removeFunction( ConstructorMap<Interface,Constructor>& cmap, const std::string& key);
+
+private:
+	Reference<TextProcessorInterface> m_impl;		///< text processor owning the functions created
+	mutable strus::mutex m_mutex;				///< mutex for creating functions on lookup
+	mutable TokenizerMap m_tokenizerMap;			///< tokenizers not created yet
+	mutable NormalizerMap m_normalizerMap;			///< normalizers not created yet
+	mutable AggregatorMap m_aggregatorMap;			///< aggregators not created yet
+	mutable PatternLexerMap m_patternLexerMap;		///< pattern lexers not created yet
+	mutable PatternMatcherMap m_patternMatcherMap;		///< pattern matchers not created yet
+	unsigned int m_nofRegistered;				///< number of constructors registered, for the debug trace
+	mutable unsigned int m_nofCreated;			///< number of registered constructors called, for the debug trace
+	ConstructorMetricsCollector* m_metrics;			///< collector of the time spent in constructors or NULL
+	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
+	DebugTraceContextInterface* m_debugtrace;		///< debug trace context for reporting the functions created
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Measurement of the time and memory spent for loading modules and creating the objects defined in them
+/// \file loadMetrics.cpp
+#include "loadMetrics.hpp"
+#include <cstdio>
+
+#if defined(_WIN32)
+#error Load metrics not ported to Windows, only implementation for POSIX available
+#else
+#include <unistd.h>
+#endif
+
+using namespace strus;
+
+long strus::getResidentMemory()
+{
+	// ... second number in /proc/self/statm is the resident set size in pages
+	std::FILE* fh = std::fopen( "/proc/self/statm", "r");
+	if (!fh) return -1;
+	long size = 0, resident = 0;
+	int nofItems = std::fscanf( fh, "%ld %ld", &size, &resident);
+	std::fclose( fh);
+	if (nofItems != 2) return -1;
+	return resident * ::sysconf( _SC_PAGESIZE);
+}
+
+void ConstructorMetricsCollector::add( const char* kind, const std::string& name, double createTime)
+{
+	std::string key( kind);
+	key.push_back( '\t');
+	key.append( name);
+
+	strus::scoped_lock lock( m_mutex);
+	std::map<std::string,std::size_t>::const_iterator ki = m_index.find( key);
+	std::size_t idx;
+	if (ki == m_index.end())
+	{
+		idx = m_metrics.size();
+		m_metrics.push_back( ModuleConstructorMetrics( kind, name));
+		m_index[ key] = idx;
+	}
+	else
+	{
+		idx = ki->second;
+	}
+	ModuleConstructorMetrics& metrics = m_metrics[ idx];
+	metrics.nofCreated += 1;
+	metrics.createTime += createTime;
+	if (createTime > metrics.maxCreateTime) metrics.maxCreateTime = createTime;
+}
+
+std::vector<ModuleConstructorMetrics> ConstructorMetricsCollector::get() const
+{
+	strus::scoped_lock lock( m_mutex);
+	return m_metrics;
+}
+
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Measurement of the time and memory spent for loading modules and creating the objects defined in them
+/// \file loadMetrics.hpp
+#ifndef _STRUS_MODULE_LOAD_METRICS_HPP_INCLUDED
+#define _STRUS_MODULE_LOAD_METRICS_HPP_INCLUDED
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/base/thread.hpp"
+#include "monotonicTime.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+
+/// \brief Get the resident memory of the process
+/// \return the resident memory in bytes or -1 if not available
+long getResidentMemory();
+
+/// \brief Collector of the time spent in the constructors called by the object builders of a module loader, thread safe
+class ConstructorMetricsCollector
+{
+public:
+	ConstructorMetricsCollector()
+		:m_mutex(),m_metrics(),m_index(){}
+
+	/// \brief Record the creation of an object
+	/// \param[in] kind kind of the object (e.g. "normalizer")
+	/// \param[in] name name of the object
+	/// \param[in] createTime seconds spent in the constructor
+	void add( const char* kind, const std::string& name, double createTime);
+
+	/// \brief Get the metrics recorded in the order of the first creation of the objects
+	std::vector<ModuleConstructorMetrics> get() const;
+
+private:
+	mutable strus::mutex m_mutex;					///< mutex for the members below
+	std::vector<ModuleConstructorMetrics> m_metrics;		///< metrics per object kind and name
+	std::map<std::string,std::size_t> m_index;			///< map of kind and name to the index in m_metrics
+};
+
+}//namespace
+#endif
+
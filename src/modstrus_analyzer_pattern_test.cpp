@@ -9,6 +9,7 @@
 #include "strus/errorBufferInterface.hpp"
 #include "strus/base/dll_tags.hpp"
 #include "strus/analyzerModule.hpp"
+#include "strus/staticModule.hpp"
 #include "internationalization.hpp"
 #include "errorUtils.hpp"
 
@@ -22,9 +23,7 @@ static const strus::PatternMatcherConstructor matcher =
 	"std", strus::createPatternMatcher_test
 };
 
-extern "C" DLL_PUBLIC strus::AnalyzerModule entryPoint;
-
-strus::AnalyzerModule entryPoint( lexer, matcher);
+STRUS_MODULE_ENTRY_POINT( strus::AnalyzerModule, analyzer_pattern_test)( lexer, matcher);
 
 
 
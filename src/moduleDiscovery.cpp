@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Table of the module files in the module search paths, built with one directory read per path
+/// \file moduleDiscovery.cpp
+#include "moduleDiscovery.hpp"
+#include "moduleIndex.hpp"
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#error Module discovery not ported to Windows, only implementation for POSIX available
+#else
+#include <sys/types.h>
+#include <dirent.h>
+#endif
+
+using namespace strus;
+
+void ModuleDiscovery::scanDirectory( const std::string& dirpath, Directory& dir)
+{
+	DIR* dh = ::opendir( dirpath.c_str());
+	if (!dh)
+	{
+		// ... a directory that does not exist contains no modules, other errors leave the lookups to the caller
+		dir.readable = (errno == ENOENT || errno == ENOTDIR);
+		return;
+	}
+
+	struct dirent* de;
+	errno = 0;
+	while (!!(de = ::readdir( dh)))
+	{
+		// ... the loader only looks for files with the prefix 'modstrus_', see moduleFileName in moduleLoader.cpp
+		if (0!=std::strncmp( de->d_name, "modstrus_", 9) || !isModuleFileName( de->d_name)) continue;
+#if defined(_DIRENT_HAVE_D_TYPE) || defined(DT_REG)
+		if (de->d_type == DT_REG)
+		{
+			dir.files.insert( de->d_name);
+		}
+		else if (de->d_type == DT_LNK || de->d_type == DT_UNKNOWN)
+		{
+			dir.others.insert( de->d_name);
+		}
+#else
+		dir.others.insert( de->d_name);
+#endif
+	}
+	dir.readable = (errno == 0);
+	::closedir( dh);
+}
+
+ModuleDiscovery::LookupResult ModuleDiscovery::lookup( const std::string& dirpath, const std::string& filename)
+{
+	std::map<std::string,Directory>::iterator di = m_dirmap.find( dirpath);
+	if (di == m_dirmap.end())
+	{
+		di = m_dirmap.insert( std::pair<std::string,Directory>( dirpath, Directory())).first;
+		scanDirectory( dirpath, di->second);
+	}
+	const Directory& dir = di->second;
+	if (dir.files.find( filename) != dir.files.end()) return Found;
+	if (dir.others.find( filename) != dir.others.end()) return Unknown;
+	return dir.readable ? NotFound : Unknown;
+}
+
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Table of the module files in the module search paths, built with one directory read per path
+/// \file moduleDiscovery.hpp
+#ifndef _STRUS_MODULE_DISCOVERY_HPP_INCLUDED
+#define _STRUS_MODULE_DISCOVERY_HPP_INCLUDED
+#include <string>
+#include <set>
+#include <map>
+
+namespace strus
+{
+
+/// \brief Table of the module files found in the module search paths
+/// \note Every directory is read once with its first lookup, without any file status calls.
+///		Changes of a directory after it has been read are not seen.
+class ModuleDiscovery
+{
+public:
+	/// \brief Result of a lookup
+	enum LookupResult
+	{
+		Found,		///< regular module file is in the directory
+		NotFound,	///< module file is not in the directory
+		Unknown		///< directory could not be read or the entry is not known to be a regular file, the caller has to check the file path itself
+	};
+
+	ModuleDiscovery()
+		:m_dirmap(){}
+
+	/// \brief Lookup a module file in a directory, reading the directory with its first lookup
+	/// \param[in] dirpath path of the directory
+	/// \param[in] filename name of the module file without directory
+	/// \return the lookup result
+	LookupResult lookup( const std::string& dirpath, const std::string& filename);
+
+	/// \brief Get the number of directories read
+	std::size_t nofDirectories() const
+	{
+		return m_dirmap.size();
+	}
+
+private:
+	struct Directory
+	{
+		bool readable;				///< false, if the directory could not be read
+		std::set<std::string> files;		///< module files known to be regular files
+		std::set<std::string> others;		///< module files of unknown file type (symbolic links or file systems not reporting the type)
+
+		Directory()
+			:readable(false),files(),others(){}
+		Directory( const Directory& o)
+			:readable(o.readable),files(o.files),others(o.others){}
+	};
+
+	static void scanDirectory( const std::string& dirpath, Directory& dir);
+
+private:
+	std::map<std::string,Directory> m_dirmap;		///< map of directory paths to their module files
+};
+
+}//namespace
+#endif
+
@@ -8,6 +8,7 @@
 #include "strus/moduleEntryPoint.hpp"
 #include "strus/base/dll_tags.hpp"
 #include "internationalization.hpp"
+#include "monotonicTime.hpp"
 #include <cstring>
 #include <vector>
 #include <stdexcept>
@@ -53,18 +54,36 @@ static void initStatusMessage( ModuleEntryPoint::Status& status, const char* msg
 }
 
 DLL_PUBLIC const ModuleEntryPoint* strus::loadModuleEntryPoint( const char* modfilename, ModuleEntryPoint::Status& status, ModuleEntryPoint::Handle& hnd, MatchModuleVersionFunc matchVersion)
+{
+	return strus::loadModuleEntryPoint( modfilename, status, hnd, matchVersion, ModuleEntryPoint::BindNow);
+}
+
+DLL_PUBLIC const ModuleEntryPoint* strus::loadModuleEntryPoint( const char* modfilename, ModuleEntryPoint::Status& status, ModuleEntryPoint::Handle& hnd, MatchModuleVersionFunc matchVersion, ModuleEntryPoint::BindingMode bindingMode)
 {
 	status.errorcode = 0;
 	status.errormsg[0] = '\0';
+	status.openTime = 0.0;
+	status.matchVersionTime = 0.0;
 
-	hnd = ::dlopen( modfilename, RTLD_NOW | RTLD_LOCAL);
+	double starttime = getMonotonicTime();
+	hnd = ::dlopen( modfilename, (bindingMode == ModuleEntryPoint::BindLazy ? RTLD_LAZY : RTLD_NOW) | RTLD_LOCAL);
 	if (!hnd)
 	{
+		status.openTime = getMonotonicTime() - starttime;
 		status.errorcode = ModuleEntryPoint::ErrorOpenModule;
 		initStatusMessage( status, ::dlerror());
 		return 0;
 	}
-	ModuleEntryPoint* entryPoint = (ModuleEntryPoint*)::dlsym( hnd, "entryPoint");
+	const ModuleEntryPoint* entryPoint = (const ModuleEntryPoint*)::dlsym( hnd, "entryPoint");
+	const ModuleEntryPoint* const* table = 0;
+	if (!entryPoint)
+	{
+		// ... module with a table of entry points, represented by the first one:
+		table = (const ModuleEntryPoint* const*)::dlsym( hnd, "entryPoints");
+		if (table) entryPoint = table[0];
+	}
+	double opentime = getMonotonicTime();
+	status.openTime = opentime - starttime;
 	if (!entryPoint)
 	{
 		::dlclose( hnd);
@@ -74,7 +93,13 @@ DLL_PUBLIC const ModuleEntryPoint* strus::loadModuleEntryPoint( const char* modf
 		return 0;
 	}
 	int errorcode = 0;
-	if (!(*matchVersion)( entryPoint, errorcode))
+	bool match = (*matchVersion)( entryPoint, errorcode);
+	for (int ti=1; match && table && table[ti]; ++ti)
+	{
+		match = (*matchVersion)( table[ti], errorcode);
+	}
+	status.matchVersionTime = getMonotonicTime() - opentime;
+	if (!match)
 	{
 		::dlclose( hnd);
 		hnd = 0;
@@ -85,3 +110,15 @@ DLL_PUBLIC const ModuleEntryPoint* strus::loadModuleEntryPoint( const char* modf
 	return entryPoint;
 }
 
+DLL_PUBLIC const ModuleEntryPoint* const* strus::getModuleEntryPointTable( ModuleEntryPoint::Handle hnd)
+{
+	if (!hnd || ::dlsym( hnd, "entryPoint")) return 0;
+	const ModuleEntryPoint* const* table = (const ModuleEntryPoint* const*)::dlsym( hnd, "entryPoints");
+	return (table && table[0] && table[1]) ? table : 0;
+}
+
+DLL_PUBLIC void strus::unloadModuleHandle( ModuleEntryPoint::Handle hnd)
+{
+	if (hnd) ::dlclose( hnd);
+}
+
@@ -0,0 +1,47 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Reference counted handle of a module opened
+/// \file moduleHandle.hpp
+#ifndef _STRUS_MODULE_HANDLE_HPP_INCLUDED
+#define _STRUS_MODULE_HANDLE_HPP_INCLUDED
+#include "strus/moduleEntryPoint.hpp"
+#include "strus/reference.hpp"
+
+namespace strus
+{
+
+/// \brief Handle of a module opened, referenced by the module loader and by every object builder using the module
+/// \note The module is unloaded with the release of the last reference, if unloading was enabled when the module was opened
+class ModuleHandle
+{
+public:
+	/// \brief Constructor
+	/// \param[in] handle_ handle of the module opened
+	/// \param[in] unload_ true, if the module should be unloaded with the destruction of this object, false if it stays loaded until the process exits
+	ModuleHandle( ModuleEntryPoint::Handle handle_, bool unload_)
+		:m_handle(handle_),m_unload(unload_){}
+
+	~ModuleHandle()
+	{
+		if (m_unload) unloadModuleHandle( m_handle);
+	}
+
+private:
+	ModuleHandle( const ModuleHandle&){}		//< non copyable
+	void operator=( const ModuleHandle&){}		//< non copyable
+
+private:
+	ModuleEntryPoint::Handle m_handle;		///< handle of the module
+	bool m_unload;					///< true, if the module is unloaded with the destruction of this object
+};
+
+typedef Reference<ModuleHandle> ModuleHandleReference;
+
+}//namespace
+#endif
+
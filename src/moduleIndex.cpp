@@ -0,0 +1,287 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Persistent index of the module files found in the module search paths
+/// \file moduleIndex.cpp
+#include "moduleIndex.hpp"
+#include "moduleDirectory.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/string_conv.hpp"
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <ctime>
+#include <cerrno>
+
+#if defined(_WIN32)
+#error Module index not ported to Windows, only implementation for POSIX available
+#else
+#include <sys/types.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include <unistd.h>
+#endif
+
+using namespace strus;
+
+#define MODULE_INDEX_HEADER "# strus module index 1"
+
+int strus::getModuleFileStat( const std::string& path, ModuleFileStat& st)
+{
+	struct stat buf;
+	if (0!=::stat( path.c_str(), &buf)) return errno;
+	st.mtime = buf.st_mtime;
+	st.inode = buf.st_ino;
+	st.size = S_ISDIR( buf.st_mode) ? 0 : buf.st_size;
+	return 0;
+}
+
+ModuleIndex::ModuleIndex( const std::string& filename_)
+	:m_filename(filename_),m_dirmap(),m_modified(false){}
+
+bool strus::isModuleFileName( const char* filename)
+{
+	std::size_t namelen = std::strlen( filename);
+	std::size_t extlen = std::strlen( STRUS_MODULE_EXTENSION);
+	return namelen > extlen && strus::caseInsensitiveEquals( filename + namelen - extlen, STRUS_MODULE_EXTENSION);
+}
+
+int ModuleIndex::scanDirectory( const std::string& dirpath, const ModuleFileStat& dirstat, Directory& dir) const
+{
+	DIR* dh = ::opendir( dirpath.c_str());
+	if (!dh) return errno;
+
+	std::map<std::string,Entry> files;
+	struct dirent* de;
+	errno = 0;
+	while (!!(de = ::readdir( dh)))
+	{
+		if (de->d_name[0] == '.' || !isModuleFileName( de->d_name)) continue;
+		ModuleFileStat st;
+		std::string filepath = strus::joinFilePath( dirpath, de->d_name);
+		if (0!=getModuleFileStat( filepath, st)) continue;
+
+		std::map<std::string,Entry>::const_iterator oi = dir.files.find( de->d_name);
+		if (oi != dir.files.end() && oi->second.stat == st)
+		{
+			// ... file did not change, keep the meta data recorded when it was loaded
+			files[ de->d_name] = oi->second;
+		}
+		else
+		{
+			files[ de->d_name] = Entry( st);
+		}
+	}
+	int ec = errno;
+	::closedir( dh);
+	if (ec) return ec;
+
+	dir.files.swap( files);
+	dir.stat = dirstat;
+	if ((long long)std::time( NULL) <= dirstat.mtime + 1)
+	{
+		// ... directory modified within the granularity of the modification time,
+		//	we cannot be sure to have seen all changes, so we force a rescan on the next lookup:
+		dir.stat.mtime = 0;
+	}
+	return 0;
+}
+
+ModuleIndex::LookupResult ModuleIndex::lookup( const std::string& dirpath, const std::string& filename, bool& scanned)
+{
+	scanned = false;
+	ModuleFileStat dirstat;
+	if (0!=getModuleFileStat( dirpath, dirstat)) return NotFound;
+
+	std::map<std::string,Directory>::iterator di = m_dirmap.find( dirpath);
+	if (di == m_dirmap.end() || di->second.stat != dirstat)
+	{
+		Directory& dir = m_dirmap[ dirpath];
+		if (0!=scanDirectory( dirpath, dirstat, dir))
+		{
+			m_dirmap.erase( dirpath);
+			return Unknown;
+		}
+		m_modified = true;
+		scanned = true;
+		di = m_dirmap.find( dirpath);
+	}
+	return di->second.files.find( filename) == di->second.files.end() ? NotFound : Found;
+}
+
+void ModuleIndex::update( const std::string& dirpath, const std::string& filename, const ModuleEntryPoint* entryPoint)
+{
+	Entry& entry = m_dirmap[ dirpath].files[ filename];
+	// ... the file has been checked by the lookup before, so its stat is only needed if the meta data changed
+	if (entry.stat.inode
+		&& entry.type == (int)entryPoint->type
+		&& entry.signature == entryPoint->signature
+		&& entry.modversion_minor == entryPoint->modversion_minor
+		&& entry.compversion_major == entryPoint->compversion_major
+		&& entry.compversion_minor == entryPoint->compversion_minor)
+	{
+		return;
+	}
+	ModuleFileStat st;
+	if (0!=getModuleFileStat( strus::joinFilePath( dirpath, filename), st)) return;
+	entry.stat = st;
+	entry.signature = entryPoint->signature;
+	entry.type = (int)entryPoint->type;
+	entry.modversion_minor = entryPoint->modversion_minor;
+	entry.compversion_major = entryPoint->compversion_major;
+	entry.compversion_minor = entryPoint->compversion_minor;
+	m_modified = true;
+}
+
+const ModuleIndex::Entry* ModuleIndex::get( const std::string& dirpath, const std::string& filename) const
+{
+	std::map<std::string,Directory>::const_iterator di = m_dirmap.find( dirpath);
+	if (di == m_dirmap.end()) return NULL;
+	std::map<std::string,Entry>::const_iterator fi = di->second.files.find( filename);
+	return fi == di->second.files.end() ? NULL : &fi->second;
+}
+
+const char* strus::moduleTypeName( int type)
+{
+	switch (type)
+	{
+		case ModuleEntryPoint::Analyzer: return "analyzer";
+		case ModuleEntryPoint::Storage: return "storage";
+		case ModuleEntryPoint::Trace: return "trace";
+	}
+	return "-";
+}
+
+int strus::moduleTypeFromName( const std::string& name)
+{
+	if (name == "analyzer") return ModuleEntryPoint::Analyzer;
+	if (name == "storage") return ModuleEntryPoint::Storage;
+	if (name == "trace") return ModuleEntryPoint::Trace;
+	return -1;
+}
+
+void strus::splitModuleFileLine( std::vector<std::string>& res, const std::string& line)
+{
+	res.clear();
+	std::string::size_type start = 0, end = line.find( '\t');
+	for (; end != std::string::npos; start = end+1, end = line.find( '\t', start))
+	{
+		res.push_back( std::string( line, start, end-start));
+	}
+	res.push_back( std::string( line, start));
+}
+
+bool strus::parseModuleFileStat( ModuleFileStat& st, const std::string& mtime, const std::string& inode, const std::string& size)
+{
+	char* ee;
+	st.mtime = std::strtoll( mtime.c_str(), &ee, 10);
+	if (*ee) return false;
+	st.inode = std::strtoull( inode.c_str(), &ee, 10);
+	if (*ee) return false;
+	st.size = std::strtoull( size.c_str(), &ee, 10);
+	if (*ee) return false;
+	return true;
+}
+
+int ModuleIndex::load()
+{
+	std::string content;
+	m_dirmap.clear();
+	m_modified = false;
+	int ec = strus::readFile( m_filename, content);
+	if (ec == ENOENT) return 0;
+	if (ec) return ec;
+
+	std::map<std::string,Directory> dirmap;
+	Directory* curdir = NULL;
+	std::vector<std::string> col;
+	std::string::size_type start = 0, end = content.find( '\n');
+	if (end == std::string::npos || content.compare( 0, end, MODULE_INDEX_HEADER) != 0)
+	{
+		return EINVAL;
+	}
+	for (start = end+1, end = content.find( '\n', start); end != std::string::npos; start = end+1, end = content.find( '\n', start))
+	{
+		splitModuleFileLine( col, std::string( content, start, end-start));
+		if (col.size() == 5 && col[0] == "D")
+		{
+			curdir = &dirmap[ col[1]];
+			if (!parseModuleFileStat( curdir->stat, col[2], col[3], col[4])) return EINVAL;
+		}
+		else if (col.size() == 10 && col[0] == "F" && curdir)
+		{
+			Entry& entry = curdir->files[ col[1]];
+			if (!parseModuleFileStat( entry.stat, col[2], col[3], col[4])) return EINVAL;
+			entry.type = moduleTypeFromName( col[5]);
+			if (entry.type >= 0)
+			{
+				entry.signature = col[6];
+				entry.modversion_minor = (unsigned short)std::atoi( col[7].c_str());
+				entry.compversion_major = (unsigned short)std::atoi( col[8].c_str());
+				entry.compversion_minor = (unsigned short)std::atoi( col[9].c_str());
+			}
+		}
+		else
+		{
+			return EINVAL;
+		}
+	}
+	m_dirmap.swap( dirmap);
+	return 0;
+}
+
+int ModuleIndex::store()
+{
+	if (!m_modified) return 0;
+
+	std::string content( MODULE_INDEX_HEADER "\n");
+	char buf[ 256];
+	std::map<std::string,Directory>::const_iterator di = m_dirmap.begin(), de = m_dirmap.end();
+	for (; di != de; ++di)
+	{
+		std::snprintf( buf, sizeof(buf), "\t%lld\t%llu\t%llu\n", di->second.stat.mtime, di->second.stat.inode, di->second.stat.size);
+		content.append( "D\t");
+		content.append( di->first);
+		content.append( buf);
+
+		std::map<std::string,Entry>::const_iterator fi = di->second.files.begin(), fe = di->second.files.end();
+		for (; fi != fe; ++fi)
+		{
+			const Entry& entry = fi->second;
+			std::snprintf( buf, sizeof(buf), "\t%lld\t%llu\t%llu\t%s\t%s\t%u\t%u\t%u\n",
+					entry.stat.mtime, entry.stat.inode, entry.stat.size,
+					moduleTypeName( entry.type), entry.loaded() ? entry.signature.c_str() : "-",
+					(unsigned int)entry.modversion_minor, (unsigned int)entry.compversion_major, (unsigned int)entry.compversion_minor);
+			content.append( "F\t");
+			content.append( fi->first);
+			content.append( buf);
+		}
+	}
+	int ec = writeModuleFileAtomic( m_filename, content);
+	if (ec) return ec;
+	m_modified = false;
+	return 0;
+}
+
+int strus::writeModuleFileAtomic( const std::string& filename, const std::string& content)
+{
+	// ... write to a temporary file first and rename it, so that concurrent readers never see a partially written file:
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), ".%d.tmp", (int)::getpid());
+	std::string tmpfilename = filename + buf;
+	int ec = strus::writeFile( tmpfilename, content);
+	if (ec) return ec;
+	if (0!=std::rename( tmpfilename.c_str(), filename.c_str()))
+	{
+		ec = errno;
+		(void)std::remove( tmpfilename.c_str());
+		return ec;
+	}
+	return 0;
+}
+
@@ -0,0 +1,172 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Persistent index of the module files found in the module search paths
+/// \file moduleIndex.hpp
+#ifndef _STRUS_MODULE_INDEX_HPP_INCLUDED
+#define _STRUS_MODULE_INDEX_HPP_INCLUDED
+#include "strus/moduleEntryPoint.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+
+/// \brief Identity of a file or directory in the file system used to detect changes
+struct ModuleFileStat
+{
+	long long mtime;		///< time of last modification (seconds since epoch)
+	unsigned long long inode;	///< inode number
+	unsigned long long size;	///< file size in bytes
+
+	ModuleFileStat()
+		:mtime(0),inode(0),size(0){}
+	ModuleFileStat( const ModuleFileStat& o)
+		:mtime(o.mtime),inode(o.inode),size(o.size){}
+
+	bool operator == (const ModuleFileStat& o) const	{return mtime == o.mtime && inode == o.inode && size == o.size;}
+	bool operator != (const ModuleFileStat& o) const	{return !operator==(o);}
+};
+
+/// \brief Get the identity of a file or directory
+/// \param[in] path path of the file or directory
+/// \param[out] st the identity of the file
+/// \return 0 on success, errno on failure
+int getModuleFileStat( const std::string& path, ModuleFileStat& st);
+
+/// \brief Evaluate if a file name has the extension of module files
+/// \param[in] filename name of the file
+bool isModuleFileName( const char* filename);
+
+/// \brief Get the name of a module type as written to index and manifest files
+/// \param[in] type ModuleEntryPoint::Type of the module or -1 if not known
+/// \return the name of the type or "-" if not known
+const char* moduleTypeName( int type);
+
+/// \brief Get the module type from its name as written to index and manifest files
+/// \param[in] name name of the type
+/// \return ModuleEntryPoint::Type of the module or -1 if not known
+int moduleTypeFromName( const std::string& name);
+
+/// \brief Split a line of an index or manifest file into its tab separated columns
+/// \param[out] res the columns
+/// \param[in] line the line without end of line
+void splitModuleFileLine( std::vector<std::string>& res, const std::string& line);
+
+/// \brief Parse the identity of a file from its columns in an index or manifest file
+/// \return true on success, false if one of the columns is not a number
+bool parseModuleFileStat( ModuleFileStat& st, const std::string& mtime, const std::string& inode, const std::string& size);
+
+/// \brief Write an index or manifest file via a temporary file renamed, so that concurrent readers never see a partially written file
+/// \param[in] filename path of the file
+/// \param[in] content content to write
+/// \return 0 on success, errno on failure
+int writeModuleFileAtomic( const std::string& filename, const std::string& content);
+
+/// \brief Index of module files mapping directories to the module files in them, stored in a file and updated incrementally
+/// \note The index answers the question if a module file exists in a directory with one stat call of the directory instead of one per candidate.
+///		A directory is rescanned if its modification time or inode changed since the last scan.
+class ModuleIndex
+{
+public:
+	/// \brief Description of a module file with the entry point meta data recorded when the module was loaded the last time
+	struct Entry
+	{
+		ModuleFileStat stat;			///< identity of the file
+		std::string signature;			///< signature of the entry point or empty if the module has not been loaded yet
+		int type;				///< ModuleEntryPoint::Type of the module or -1 if the module has not been loaded yet
+		unsigned short modversion_minor;	///< minor version of the module
+		unsigned short compversion_major;	///< major version of components in the module
+		unsigned short compversion_minor;	///< minor version of components in the module
+
+		Entry()
+			:stat(),signature(),type(-1),modversion_minor(0),compversion_major(0),compversion_minor(0){}
+		explicit Entry( const ModuleFileStat& stat_)
+			:stat(stat_),signature(),type(-1),modversion_minor(0),compversion_major(0),compversion_minor(0){}
+		Entry( const Entry& o)
+			:stat(o.stat),signature(o.signature),type(o.type)
+			,modversion_minor(o.modversion_minor),compversion_major(o.compversion_major),compversion_minor(o.compversion_minor){}
+
+		bool loaded() const			{return type >= 0;}
+	};
+
+	/// \brief Result of a lookup
+	enum LookupResult
+	{
+		Found,		///< module file is in the directory
+		NotFound,	///< module file is not in the directory
+		Unknown		///< directory could not be inspected, the caller has to check the file path itself
+	};
+
+	/// \brief Constructor
+	/// \param[in] filename_ path of the file where the index is stored
+	explicit ModuleIndex( const std::string& filename_);
+
+	/// \brief Get the path of the file where the index is stored
+	const std::string& filename() const
+	{
+		return m_filename;
+	}
+
+	/// \brief Read the index from its file, a missing file is not an error and leaves the index empty
+	/// \return 0 on success, errno on failure (the index is empty then)
+	int load();
+
+	/// \brief Write the index to its file if it has been modified since the last load or store
+	/// \return 0 on success, errno on failure
+	int store();
+
+	/// \brief Lookup a module file in a directory, rescanning the directory if it changed
+	/// \param[in] dirpath path of the directory
+	/// \param[in] filename name of the module file without directory
+	/// \param[out] scanned true if the directory has been scanned, false if the index was used as is
+	/// \return the lookup result, Found means that the file exists without the need of checking it, as the directory has been checked or scanned
+	/// \note Costs one stat call of the directory if it did not change
+	LookupResult lookup( const std::string& dirpath, const std::string& filename, bool& scanned);
+
+	/// \brief Record the meta data of a loaded module, the file is only inspected if the meta data recorded differs
+	/// \param[in] dirpath path of the directory of the module file
+	/// \param[in] filename name of the module file without directory
+	/// \param[in] entryPoint entry point of the module loaded
+	void update( const std::string& dirpath, const std::string& filename, const ModuleEntryPoint* entryPoint);
+
+	/// \brief Get the entry of a module file
+	/// \param[in] dirpath path of the directory of the module file
+	/// \param[in] filename name of the module file without directory
+	/// \return pointer to the entry or NULL if not found
+	const Entry* get( const std::string& dirpath, const std::string& filename) const;
+
+	/// \brief Evaluate if the index has been modified since the last load or store
+	bool modified() const
+	{
+		return m_modified;
+	}
+
+private:
+	struct Directory
+	{
+		ModuleFileStat stat;
+		std::map<std::string,Entry> files;
+
+		Directory()
+			:stat(),files(){}
+		Directory( const Directory& o)
+			:stat(o.stat),files(o.files){}
+	};
+
+	int scanDirectory( const std::string& dirpath, const ModuleFileStat& dirstat, Directory& dir) const;
+
+private:
+	std::string m_filename;					///< path of the file where the index is stored
+	std::map<std::string,Directory> m_dirmap;		///< map of directory paths to their module files
+	bool m_modified;					///< true, if the index has been modified since the last load or store
+};
+
+}//namespace
+#endif
+
@@ -9,6 +9,7 @@
 #include "moduleDirectory.hpp"
 #include "strus/lib/filelocator.hpp"
 #include "strus/moduleEntryPoint.hpp"
+#include "strus/staticModule.hpp"
 #include "strus/storageModule.hpp"
 #include "strus/versionStorage.hpp"
 #include "strus/analyzerModule.hpp"
@@ -23,40 +24,80 @@
 #include "strus/lib/traceproc_std.hpp"
 #include "storageObjectBuilder.hpp"
 #include "analyzerObjectBuilder.hpp"
+#include "sharedObjectBuilder.hpp"
+#include "moduleIndex.hpp"
+#include "moduleDiscovery.hpp"
+#include "moduleWatcher.hpp"
+#include "preloadManifest.hpp"
+#include "asyncTraceLogger.hpp"
+#include "sampleTraceLogger.hpp"
+#include "binaryTraceLogger.hpp"
+#include "histogramTraceLogger.hpp"
+#include "ringTraceLogger.hpp"
 #include "strus/base/fileio.hpp"
 #include "strus/base/env.hpp"
 #include "strus/base/configParser.hpp"
 #include "strus/base/local_ptr.hpp"
 #include "strus/base/string_conv.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/thread.hpp"
 #include "strus/traceLoggerInterface.hpp"
 #include "errorUtils.hpp"
 #include "internationalization.hpp"
 #include <string>
 #include <cstring>
 #include <memory>
+#include <set>
+#include <algorithm>
 #include <iostream>
 #include <stdarg.h>
+#include <unistd.h>
 
 using namespace strus;
 
 #define ENV_STRUS_MODULE_PATH "STRUS_MODULE_PATH"
+#define STATIC_MODULE_PATH_PREFIX "static:"
+
+static bool isStaticModulePath( const std::string& path)
+{
+	return 0==std::strncmp( path.c_str(), STATIC_MODULE_PATH_PREFIX, std::strlen( STATIC_MODULE_PATH_PREFIX));
+}
 
 ModuleLoader::ModuleLoader( ErrorBufferInterface* errorhnd_)
-	:m_errorhnd(errorhnd_),m_debugtrace(0),m_filelocator(strus::createFileLocator_std(errorhnd_))
+	:m_moduleGeneration(0),m_loadMetrics(),m_constructorMetrics(),m_errorhnd(errorhnd_),m_debugtrace(0),m_filelocator(strus::createFileLocator_std(errorhnd_)),m_moduleIndex(0),m_moduleDiscovery(0),m_moduleWatcher(0),m_reloadCopyDirectory(),m_reloadCounter(0),m_loadMode(LoadEager),m_prepared(false),m_moduleUnloading(false)
+	,m_builderCaching(false),m_storageObjectBuilder(),m_storageObjectBuilderGeneration(0),m_analyzerObjectBuilder(),m_analyzerObjectBuilderGeneration(0)
 {
 	if (!m_filelocator) throw std::runtime_error(m_errorhnd->fetchError());
 	DebugTraceInterface* dbg = m_errorhnd->debugTrace();
 	if (dbg) m_debugtrace = dbg->createTraceContext( "module");
+	defineBuiltInTraceLoggers();
+	m_snapshot.reset( new ModuleSnapshot());
+}
+
+void ModuleLoader::defineBuiltInTraceLoggers()
+{
+	m_traceLoggerMap.insert( "dump", TraceLoggerDef( &createTraceLogger_dump, true));
+	m_traceLoggerMap.insert( "json", TraceLoggerDef( &createTraceLogger_json, true));
+	m_traceLoggerMap.insert( "breakpoint", TraceLoggerDef( &createTraceLogger_breakpoint, true));
+	m_traceLoggerMap.insert( "count", TraceLoggerDef( &createTraceLogger_count, true));
+	m_traceLoggerMap.insert( "histogram", TraceLoggerDef( &createTraceLogger_histogram, true));
+	m_traceLoggerMap.insert( "binary", TraceLoggerDef( &createTraceLogger_binary, true));
+	m_traceLoggerMap.insert( "ring", TraceLoggerDef( &createTraceLogger_ring, true));
+	m_traceLoggerMap.insert( "async", TraceLoggerDef( &createTraceLogger_async));
+	m_traceLoggerMap.insert( "sample", TraceLoggerDef( &createTraceLogger_sample));
 }
 
 ModuleLoader::~ModuleLoader()
 {
-	std::vector<ModuleEntryPoint::Handle>::iterator hi = m_handleList.begin(), he = m_handleList.end();
-	for (; hi != he; ++hi)
-	{
-		ModuleEntryPoint::closeHandle( *hi);
-	}
+	// ... cached builders own objects created by module code, so they have to be deleted before closing the modules
+	m_storageObjectBuilder.reset();
+	m_analyzerObjectBuilder.reset();
+	// ... modules still used by object builders alive are unloaded with the deletion of the last builder using them
+	m_moduleHandleMap.clear();
 	delete m_filelocator;
+	if (m_moduleIndex) delete m_moduleIndex;
+	if (m_moduleDiscovery) delete m_moduleDiscovery;
+	if (m_moduleWatcher) delete m_moduleWatcher;
 	if (m_debugtrace) delete m_debugtrace;
 }
 
@@ -75,6 +116,7 @@ void ModuleLoader::addSystemModulePath()
 {
 	try
 	{
+		strus::scoped_lock lock( m_moduleMutex);
 		addPath_( m_modulePaths, STRUS_MODULE_DIRECTORIES);
 	}
 	catch (const std::bad_alloc&)
@@ -87,6 +129,7 @@ void ModuleLoader::addModulePath(const std::string& path)
 {
 	try
 	{
+		strus::scoped_lock lock( m_moduleMutex);
 		addPath_( m_modulePaths, path.c_str());
 	}
 	catch (const std::bad_alloc&)
@@ -95,6 +138,16 @@ void ModuleLoader::addModulePath(const std::string& path)
 	}
 }
 
+std::vector<std::string> ModuleLoader::modulePaths() const
+{
+	try
+	{
+		strus::scoped_lock lock( m_moduleMutex);
+		return m_modulePaths;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting module paths: %s"), *m_errorhnd, std::vector<std::string>());
+}
+
 void ModuleLoader::addResourcePath( const std::string& path)
 {
 	try
@@ -119,318 +172,1573 @@ void ModuleLoader::defineWorkingDirectory( const std::string& path)
 	}
 }
 
-const ModuleEntryPoint* ModuleLoader::searchAndLoadEntryPoint( const std::string& name, std::vector<std::string>& paths_tried)
+void ModuleLoader::defineLoadMode( const LoadMode& mode)
 {
-	const ModuleEntryPoint* entryPoint = loadModuleAlt( name, m_modulePaths, paths_tried);
-	if (!entryPoint)
+	m_loadMode = mode;
+}
+
+void ModuleLoader::defineBuilderCaching( bool enable)
+{
+	strus::scoped_lock lock( m_builderCacheMutex);
+	m_builderCaching = enable;
+	if (!enable)
 	{
-		std::vector<std::string> paths;
-		int ec = getenv_list( ENV_STRUS_MODULE_PATH, separatorPathList(), paths);
-		if (ec)
+		m_storageObjectBuilder.reset();
+		m_analyzerObjectBuilder.reset();
+	}
+}
+
+void ModuleLoader::defineModuleDiscovery( bool enable)
+{
+	try
+	{
+		strus::scoped_lock lock( m_moduleDiscoveryMutex);
+		if (m_moduleDiscovery)
 		{
-			m_errorhnd->report( ec, _TXT("failed to read environment variable %s in module loader: %s"), ENV_STRUS_MODULE_PATH, ::strerror(ec));
-			return 0;
+			delete m_moduleDiscovery;
+			m_moduleDiscovery = 0;
 		}
-		if (m_modulePaths.empty())
+		if (enable)
 		{
-			addPath_( paths, STRUS_MODULE_DIRECTORIES);
+			m_moduleDiscovery = new ModuleDiscovery();
 		}
-		entryPoint = loadModuleAlt( name, paths, paths_tried);
 	}
-	return entryPoint;
+	catch (const std::bad_alloc&)
+	{
+		m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
+	}
 }
 
-bool ModuleLoader::loadModule(const std::string& name)
+bool ModuleLoader::prepare()
 {
 	try
 	{
-		if (hasUpdirReference( name))
-		{
-			m_errorhnd->report( ErrorCodeInvalidFilePath, _TXT("tried to load module with upper directory reference in the module name"));
-			return false;
-		}
-		std::vector<std::string> paths_tried;
-		const ModuleEntryPoint* entryPoint = searchAndLoadEntryPoint( name, paths_tried);
-		if (!entryPoint)
+		if (!openDeferredModules( -1)) return false;
 		{
-			m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("failed to load module '%s': "), name.c_str());
-			return false;
+			strus::scoped_lock lock( m_moduleMutex);
+			std::vector<LoadedModule>::iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+			for (; li != le; ++li)
+			{
+				// ... the dynamic linker does not relocate a module opened already, its function symbols are resolved in every worker on their first call
+				if (li->bindLazy && m_debugtrace) m_debugtrace->event( "lazy", "module %s not resolved before fork", li->path.c_str());
+			}
 		}
-		if (entryPoint)
 		{
-			try
+			strus::scoped_lock lock( m_builderCacheMutex);
+			if (m_builderCaching)
 			{
-				switch (entryPoint->type)
+				// ... the builders with their constructor tables are built in the parent process, so that the workers forked share them copy-on-write
+				ModuleSnapshotReference snapshot = moduleSnapshot();
+				if (!m_storageObjectBuilder.get() || m_storageObjectBuilderGeneration < snapshot->generation)
 				{
-					case ModuleEntryPoint::Analyzer:
-						if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "analyzer");
-						m_analyzerModules.push_back( reinterpret_cast<const AnalyzerModule*>( entryPoint));
-						break;
-					case ModuleEntryPoint::Storage:
-						if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "storage");
-						m_storageModules.push_back( reinterpret_cast<const StorageModule*>( entryPoint));
-						break;
-					case ModuleEntryPoint::Trace:
-						if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "trace");
-						m_traceModules.push_back( reinterpret_cast<const TraceModule*>( entryPoint));
-						break;
+					m_storageObjectBuilder.reset( newStorageObjectBuilder( *snapshot));
+					m_storageObjectBuilderGeneration = snapshot->generation;
 				}
-				if (entryPoint->license_3rdparty)
+				if (!m_analyzerObjectBuilder.get() || m_analyzerObjectBuilderGeneration < snapshot->generation)
 				{
-					m_license_3rdparty_ar.push_back( entryPoint->license_3rdparty);
+					m_analyzerObjectBuilder.reset( newAnalyzerObjectBuilder( *snapshot));
+					m_analyzerObjectBuilderGeneration = snapshot->generation;
 				}
-				if (entryPoint->version_3rdparty)
+				if (m_errorhnd->hasError())
 				{
-					m_version_3rdparty_ar.push_back( entryPoint->version_3rdparty);
-				}
-				std::string pname;
-				int ec = strus::getFileName( name, pname, false);
-				if (ec)
-				{
-					m_errorhnd->report( ec, "%s", ::strerror(ec));
+					m_storageObjectBuilder.reset();
+					m_analyzerObjectBuilder.reset();
 					return false;
 				}
-				m_modules.push_back( pname);
-				return true;
-			}
-			catch (const std::bad_alloc&)
-			{
-				m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
-				return false;
 			}
 		}
-		else
+		m_prepared = true;
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error preparing module loader for fork: %s"), *m_errorhnd, false);
+}
+
+bool ModuleLoader::activate()
+{
+	try
+	{
+		if (!m_prepared)
 		{
+			m_errorhnd->report( ErrorCodeOperationOrder, _TXT("module loader activated without calling prepare before"));
 			return false;
 		}
+		strus::scoped_lock lock( m_builderCacheMutex);
+		if (m_storageObjectBuilder.get())
+		{
+			// ... the cached builder is always created by newStorageObjectBuilder, its storage and databases created in the parent process are not shared
+			static_cast<module::StorageObjectBuilder*>( m_storageObjectBuilder.get())->resetProcessHandles();
+		}
+		return true;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error loading module: %s"), *m_errorhnd, 0);
+	CATCH_ERROR_MAP_RETURN( _TXT("error activating module loader: %s"), *m_errorhnd, false);
 }
 
-std::vector<std::string> ModuleLoader::moduleLoadTryPaths( const std::string& name)
+void ModuleLoader::defineModuleIndexFile( const std::string& filename)
 {
 	try
 	{
-		std::vector<std::string> rt;
-		searchAndLoadEntryPoint( name, rt);
-		return rt;
+		strus::local_ptr<ModuleIndex> moduleIndex( new ModuleIndex( filename));
+		int ec = moduleIndex->load();
+		if (ec)
+		{
+			// ... an unreadable index is not an error, it is rebuilt from scratch
+			if (m_debugtrace) m_debugtrace->event( "moduleindex", "failed to read %s: %s", filename.c_str(), ::strerror(ec));
+		}
+		if (m_moduleIndex) delete m_moduleIndex;
+		m_moduleIndex = moduleIndex.release();
+	}
+	catch (const std::bad_alloc&)
+	{
+		m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error seeking for module (moduleLoadTryPaths): %s"), *m_errorhnd, std::vector<std::string>());
 }
 
-StorageObjectBuilderInterface* ModuleLoader::createStorageObjectBuilder() const
+void ModuleLoader::storeModuleIndex()
 {
-	try
+	// ... other threads loading modules update the index concurrently
+	strus::scoped_lock lock( m_moduleIndexMutex);
+	if (m_moduleIndex && m_moduleIndex->modified())
 	{
-		strus::local_ptr<module::StorageObjectBuilder> builder( new module::StorageObjectBuilder( m_filelocator, m_errorhnd));
-		std::vector<const StorageModule*>::const_iterator
-			mi = m_storageModules.begin(), me = m_storageModules.end();
-		for (; mi != me; ++mi)
+		int ec = m_moduleIndex->store();
+		if (ec)
 		{
-			builder->addStorageModule( *mi);
+			if (m_debugtrace) m_debugtrace->event( "moduleindex", "failed to write %s: %s", m_moduleIndex->filename().c_str(), ::strerror(ec));
 		}
-		return builder.release();
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage object builder: %s"), *m_errorhnd, 0);
 }
 
-AnalyzerObjectBuilderInterface* ModuleLoader::createAnalyzerObjectBuilder() const
+bool ModuleLoader::getSearchPaths( SearchPaths& paths)
 {
-	try
 	{
-		strus::local_ptr<module::AnalyzerObjectBuilder> builder( new module::AnalyzerObjectBuilder( m_filelocator, m_errorhnd));
-		std::vector<const AnalyzerModule*>::const_iterator
-			mi = m_analyzerModules.begin(), me = m_analyzerModules.end();
-		for (; mi != me; ++mi)
+		strus::scoped_lock lock( m_moduleMutex);
+		paths.modulePaths = m_modulePaths;
+	}
+	paths.envPaths.clear();
+	paths.envError = getenv_list( ENV_STRUS_MODULE_PATH, separatorPathList(), paths.envPaths);
+	if (paths.envError) return false;
+	if (paths.modulePaths.empty())
+	{
+		addPath_( paths.envPaths, STRUS_MODULE_DIRECTORIES);
+	}
+	return true;
+}
+
+void ModuleLoader::searchEntryPoint( ModuleSearch& search, const SearchPaths& paths) const
+{
+	double starttime = getMonotonicTime();
+	if (tryLoadStaticModule( search))
+	{
+		// ... modules linked statically take precedence over module files with the same name
+	}
+	else if (!loadModuleAlt( search, paths.modulePaths))
+	{
+		if (paths.envError)
+		{
+			search.error( paths.envError, strus::string_format( _TXT("failed to read environment variable %s in module loader: %s"), ENV_STRUS_MODULE_PATH, ::strerror(paths.envError)));
+		}
+		else
 		{
-			builder->addAnalyzerModule( *mi);
+			(void)loadModuleAlt( search, paths.envPaths);
 		}
-		return builder.release();
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage object builder: %s"), *m_errorhnd, 0);
+	search.metrics.statTime += getMonotonicTime() - starttime;
 }
 
-
-TraceLoggerInterface* ModuleLoader::createTraceLogger( const std::string& loggerName, const std::string& config) const
+void ModuleLoader::reportSearch( ModuleSearch& search)
 {
-	std::vector<const TraceModule*>::const_iterator mi = m_traceModules.begin(), me = m_traceModules.end();
-	for (; mi != me; ++mi)
+	if (m_debugtrace)
 	{
-		const TraceLoggerConstructor* car = (*mi)->traceLoggerConstructors;
-		std::size_t ci = 0;
-		for (; car[ci].title; ++ci)
+		std::vector<ModuleSearch::Message>::const_iterator vi = search.events.begin(), ve = search.events.end();
+		for (; vi != ve; ++vi)
 		{
-			if (strus::caseInsensitiveEquals( loggerName, car[ci].title))
-			{
-				return car->create( config, m_errorhnd);
-			}
+			m_debugtrace->event( vi->type, "%s", vi->text.c_str());
 		}
 	}
-	if (strus::caseInsensitiveEquals( loggerName, "dump"))
+	std::vector<ModuleSearch::Error>::const_iterator ei = search.errors.begin(), ee = search.errors.end();
+	for (; ei != ee; ++ei)
 	{
-		return createTraceLogger_dump( config, m_errorhnd);
+		m_errorhnd->report( ei->errorcode, "%s", ei->text.c_str());
 	}
-	else if (strus::caseInsensitiveEquals( loggerName, "json"))
+	if (search.handle)
 	{
-		return createTraceLogger_json( config, m_errorhnd);
+		strus::scoped_lock lock( m_moduleMutex);
+		addModuleHandle( search.handle, search.entryPoint);
+		search.handle = NULL;
 	}
-	else if (strus::caseInsensitiveEquals( loggerName, "breakpoint"))
+}
+
+void ModuleLoader::addModuleHandle( ModuleEntryPoint::Handle hnd, const ModuleEntryPoint* entryPoint) const
+{
+	const ModuleEntryPoint* const* table = entryPoint ? strus::getModuleEntryPointTable( hnd) : NULL;
+	// ... trace loggers are owned by trace object builders not tracked, so trace modules are never unloaded
+	bool unload = m_moduleUnloading && entryPoint && !hasTraceEntryPoint( entryPoint, table);
+	ModuleHandleReference ref( new ModuleHandle( hnd, unload));
+	if (!entryPoint) return;
+	std::map<const ModuleEntryPoint*,ModuleHandleReference>::const_iterator mi = m_moduleHandleMap.find( entryPoint);
+	if (mi == m_moduleHandleMap.end())
 	{
-		return createTraceLogger_breakpoint( config, m_errorhnd);
+		// ... every entry point of a module references its handle, because object builders look up the handles by the entry points registered
+		m_moduleHandleMap[ entryPoint] = ref;
+		if (table)
+		{
+			m_entryPointTables[ entryPoint] = table;
+			for (++table; *table; ++table) m_moduleHandleMap[ *table] = ref;
+		}
 	}
-	else if (strus::caseInsensitiveEquals( loggerName, "count"))
+	// ... else the module is opened twice, the additional handle is released with ref
+}
+
+void ModuleLoader::eraseModuleHandle( const ModuleEntryPoint* entryPoint) const
+{
+	std::map<const ModuleEntryPoint*,const ModuleEntryPoint* const*>::iterator ti = m_entryPointTables.find( entryPoint);
+	if (ti != m_entryPointTables.end())
 	{
-		return createTraceLogger_count( config, m_errorhnd);
+		const ModuleEntryPoint* const* table = ti->second;
+		for (; *table; ++table) m_moduleHandleMap.erase( *table);
+		m_entryPointTables.erase( ti);
 	}
-	else
+	m_moduleHandleMap.erase( entryPoint);
+}
+
+const ModuleEntryPoint* const* ModuleLoader::entryPointTable( const ModuleEntryPoint* entryPoint) const
+{
+	std::map<const ModuleEntryPoint*,const ModuleEntryPoint* const*>::const_iterator ti = m_entryPointTables.find( entryPoint);
+	return ti == m_entryPointTables.end() ? NULL : ti->second;
+}
+
+/// \brief Get the type of a module with a table of entry points
+/// \return the type of all entry points or -1 if they are of different types
+static int entryPointTableType( const ModuleEntryPoint* const* table)
+{
+	int rt = (*table)->type;
+	for (++table; *table; ++table)
 	{
-		throw strus::runtime_error(_TXT("unknown trace logger '%s' (did you load its module)"), loggerName.c_str());
+		if ((int)(*table)->type != rt) return -1;
 	}
+	return rt;
 }
 
-TraceObjectBuilderInterface* ModuleLoader::createTraceObjectBuilder( const std::string& config_) const
+int ModuleLoader::moduleType( const ModuleEntryPoint* entryPoint) const
 {
-	try
+	const ModuleEntryPoint* const* table = entryPointTable( entryPoint);
+	return table ? entryPointTableType( table) : (int)entryPoint->type;
+}
+
+bool ModuleLoader::hasTraceEntryPoint( const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table)
+{
+	if (!table) return entryPoint->type == ModuleEntryPoint::Trace;
+	for (; *table; ++table)
 	{
-		std::string config( config_);
-		std::string modulename;
-		if (!extractStringFromConfigString( modulename, config, "log", m_errorhnd))
-		{
-			throw strus::runtime_error(_TXT("undefined '%s' in config"), "log");
-		}
-		TraceLoggerInterface* tracelog = createTraceLogger( modulename, config);
-		if (!tracelog)
-		{
-			throw strus::runtime_error( _TXT( "could not load trace processor '%s'"), modulename.c_str());
-		}
-		TraceObjectBuilderInterface* rt = traceCreateObjectBuilder( tracelog, m_errorhnd);
-		if (!rt) delete tracelog;
-		return rt;
+		if ((*table)->type == ModuleEntryPoint::Trace) return true;
 	}
-	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage object builder: %s"), *m_errorhnd, 0);
+	return false;
 }
 
-std::vector<std::string> ModuleLoader::get3rdPartyLicenseTexts() const
+void ModuleLoader::recordLoadMetrics( const ModuleSearch& search)
 {
-	return m_license_3rdparty_ar;
+	ModuleLoadMetrics metrics( search.metrics);
+	metrics.name = search.name;
+	metrics.path = search.path;
+	metrics.nofPathsProbed = search.paths_tried.size();
+	metrics.statTime -= metrics.openTime + metrics.versionCheckTime;
+	if (metrics.statTime < 0.0) metrics.statTime = 0.0;
 
+	strus::scoped_lock lock( m_moduleMutex);
+	m_loadMetrics.push_back( metrics);
 }
-std::vector<std::string> ModuleLoader::get3rdPartyVersionTexts() const
+
+std::vector<ModuleLoadMetrics> ModuleLoader::moduleLoadMetrics() const
 {
-	return m_version_3rdparty_ar;
+	try
+	{
+		strus::scoped_lock lock( m_moduleMutex);
+		return m_loadMetrics;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting module load metrics: %s"), *m_errorhnd, std::vector<ModuleLoadMetrics>());
 }
 
-static bool matchModuleVersion( const ModuleEntryPoint* entryPoint, int& errorcode)
+std::vector<ModuleConstructorMetrics> ModuleLoader::constructorMetrics() const
 {
-	const char* loader_signature = STRUS_MODULE_SIGNATURE;
-	//... signature contains major version number in it
-	if (std::strcmp( entryPoint->signature, loader_signature) != 0)
+	try
 	{
-		errorcode = ModuleEntryPoint::ErrorSignature;
-		return false;
+		return m_constructorMetrics.get();
 	}
-	unsigned short expected_modversion_minor = STRUS_MODULE_VERSION_MINOR;
-	if (entryPoint->modversion_minor > expected_modversion_minor)
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting constructor metrics: %s"), *m_errorhnd, std::vector<ModuleConstructorMetrics>());
+}
+
+bool ModuleLoader::addModule( const std::string& name, const ModuleSearch& search)
+{
+	try
 	{
-		errorcode = ModuleEntryPoint::ErrorModMinorVersion;
-		return false;
+		std::string pname;
+		int ec = strus::getFileName( name, pname, false);
+		if (ec)
+		{
+			m_errorhnd->report( ec, "%s", ::strerror(ec));
+			return false;
+		}
+		strus::scoped_lock lock( m_moduleMutex);
+		if (search.entryPoint && m_deferredModules.empty())
+		{
+			if (!registerModule( search.entryPoint)) return false;
+		}
+		else
+		{
+			// ... module opened later or registered after the modules loaded before that are still deferred
+			if (m_debugtrace) m_debugtrace->event( "defer", "module %s", search.path.c_str());
+			m_deferredModules.push_back( DeferredModule( search.path, search.entryPoint ? moduleType( search.entryPoint) : search.type, search.entryPoint));
+		}
+		m_loadedModules.push_back( LoadedModule( name, search.path, search.entryPoint, search.entryPoint && search.loadMode == LoadLazy));
+		if (m_moduleWatcher) watchLoadedModule( m_loadedModules.back());
+		m_modules.push_back( pname);
+		publishSnapshot();
+		return true;
 	}
-	unsigned short expected_compversion_major = 0;
-	unsigned short expected_compversion_minor = 0;
-	switch (entryPoint->type)
+	catch (const std::bad_alloc&)
 	{
-		case ModuleEntryPoint::Analyzer:
-			expected_compversion_major = STRUS_ANALYZER_VERSION_MAJOR;
-			expected_compversion_minor = STRUS_ANALYZER_VERSION_MINOR;
-			break;
+		m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
+		return false;
+	}
+}
 
-		case ModuleEntryPoint::Storage:
-			expected_compversion_major = STRUS_STORAGE_VERSION_MAJOR;
-			expected_compversion_minor = STRUS_STORAGE_VERSION_MINOR;
-			break;
+static bool matchModuleVersion( const ModuleEntryPoint* entryPoint, int& errorcode);
 
-		case ModuleEntryPoint::Trace:
-			expected_compversion_major = STRUS_TRACE_VERSION_MAJOR;
-			expected_compversion_minor = STRUS_TRACE_VERSION_MINOR;
-			break;
+bool ModuleLoader::registerModule( const ModuleEntryPoint* entryPoint) const
+{
+	const ModuleEntryPoint* single[2] = {entryPoint, NULL};
+	const ModuleEntryPoint* const* table = entryPointTable( entryPoint);
+	if (!table) table = single;
 
-		default:
-			errorcode = ModuleEntryPoint::ErrorUnknownModuleType;
+	// ... check every entry point before registering any, so that a module is either registered completely or not at all
+	const ModuleEntryPoint* const* ti = table;
+	for (; *ti; ++ti)
+	{
+		if (!checkEntryPoint( *ti, table)) return false;
+	}
+	for (ti = table; *ti; ++ti)
+	{
+		if (!registerEntryPoint( *ti))
+		{
+			// ... only possible when running out of memory, the entry points registered before are removed
+			while (ti != table) unregisterEntryPoint( *--ti);
 			return false;
+		}
 	}
-	if (entryPoint->compversion_major != expected_compversion_major)
+	++m_moduleGeneration;
+	return true;
+}
+
+bool ModuleLoader::checkEntryPoint( const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table) const
+{
+	int errorcode = 0;
+	if (!matchModuleVersion( entryPoint, errorcode))
 	{
-		errorcode = ModuleEntryPoint::ErrorCompMajorVersion;
+		m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("entry point of module does not match the module loader version (error %d)"), errorcode);
 		return false;
 	}
-	if (entryPoint->compversion_minor < expected_compversion_minor)
+	if (entryPoint->type != ModuleEntryPoint::Trace) return true;
+
+	const TraceModule* mod = reinterpret_cast<const TraceModule*>( entryPoint);
+	if (!mod->traceLoggerConstructors) return true;
+	const TraceLoggerConstructor* ci = mod->traceLoggerConstructors;
+	for (; ci->title; ++ci)
 	{
-		errorcode = ModuleEntryPoint::ErrorCompMinorVersion;
-		return false;
+		const TraceLoggerDef* def = m_traceLoggerMap.find( ci->title, std::strlen( ci->title));
+		if (def && !def->builtin && def->create != ci->create)
+		{
+			// ... the same constructor registered again (e.g. a module linked into more than one module file) is not a conflict
+			m_errorhnd->report( ErrorCodeDuplicateDefinition, _TXT("trace logger '%s' defined by more than one module"), ci->title);
+			return false;
+		}
+		const TraceLoggerConstructor* pi = mod->traceLoggerConstructors;
+		for (; pi != ci; ++pi)
+		{
+			if (strus::caseInsensitiveEquals( pi->title, ci->title))
+			{
+				m_errorhnd->report( ErrorCodeDuplicateDefinition, _TXT("trace logger '%s' defined twice in the same module"), ci->title);
+				return false;
+			}
+		}
+		// ... the trace entry points of the same module checked before are not registered yet
+		const ModuleEntryPoint* const* ti = table;
+		for (; *ti != entryPoint; ++ti)
+		{
+			if ((*ti)->type != ModuleEntryPoint::Trace) continue;
+			const TraceLoggerConstructor* oi = reinterpret_cast<const TraceModule*>( *ti)->traceLoggerConstructors;
+			for (; oi && oi->title; ++oi)
+			{
+				if (strus::caseInsensitiveEquals( oi->title, ci->title) && oi->create != ci->create)
+				{
+					m_errorhnd->report( ErrorCodeDuplicateDefinition, _TXT("trace logger '%s' defined twice in the same module"), ci->title);
+					return false;
+				}
+			}
+		}
 	}
 	return true;
 }
 
-const ModuleEntryPoint* ModuleLoader::loadModuleAlt(
-		const std::string& name,
-		const std::vector<std::string>& paths,
-		std::vector<std::string>& paths_tried)
+bool ModuleLoader::registerEntryPoint( const ModuleEntryPoint* entryPoint) const
 {
-	std::vector<std::string>::const_iterator pi = paths.begin(), pe = paths.end();
-	for (; pi != pe; ++pi)
+	try
 	{
-		std::string modfilename;
-		if (stringStartsWith( name, "modstrus_"))
+		switch (entryPoint->type)
 		{
-			modfilename = strus::joinFilePath( *pi, name);
+			case ModuleEntryPoint::Analyzer:
+				if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "analyzer");
+				m_analyzerModules.push_back( reinterpret_cast<const AnalyzerModule*>( entryPoint));
+				break;
+			case ModuleEntryPoint::Storage:
+				if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "storage");
+				m_storageModules.push_back( reinterpret_cast<const StorageModule*>( entryPoint));
+				break;
+			case ModuleEntryPoint::Trace:
+				if (m_debugtrace) m_debugtrace->event( "modtype", "%s", "trace");
+				if (!registerTraceModule( reinterpret_cast<const TraceModule*>( entryPoint))) return false;
+				break;
 		}
-		else if (stringStartsWith( name, "strus_"))
+		if (entryPoint->license_3rdparty)
 		{
-			modfilename = strus::joinFilePath( *pi, "mod" + name);
+			m_license_3rdparty_ar.push_back( entryPoint->license_3rdparty);
 		}
-		else
-		{
-			modfilename = strus::joinFilePath( *pi, "modstrus_" + name);
-		}
-		if (!strus::caseInsensitiveEquals(
-			modfilename.c_str() + modfilename.size() - std::strlen( STRUS_MODULE_EXTENSION),
-			STRUS_MODULE_EXTENSION))
+		if (entryPoint->version_3rdparty)
 		{
-			modfilename.append( STRUS_MODULE_EXTENSION);
+			m_version_3rdparty_ar.push_back( entryPoint->version_3rdparty);
 		}
-		const ModuleEntryPoint* entrypoint;
-		paths_tried.push_back( modfilename);
-		if (!!(entrypoint = tryLoadPathAsModule( modfilename)))
+		return true;
+	}
+	catch (const std::bad_alloc&)
+	{
+		m_errorhnd->report( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
+		return false;
+	}
+}
+
+bool ModuleLoader::registerTraceModule( const TraceModule* mod) const
+{
+	// ... called after checkEntryPoint, so there are no conflicting definitions
+	if (!mod->traceLoggerConstructors) return true;
+	const TraceLoggerConstructor* ci = mod->traceLoggerConstructors;
+	for (; ci->title; ++ci)
+	{
+		const TraceLoggerDef* def = m_traceLoggerMap.find( ci->title, std::strlen( ci->title));
+		// ... a definition by a module left is the same constructor registered again
+		if (def && !def->builtin) continue;
+		if (m_debugtrace)
 		{
-			if (m_debugtrace) m_debugtrace->event( "entrypoint", "module %s", modfilename.c_str());
-			return entrypoint;
+			m_debugtrace->event( def ? "override" : "tracelogger", "%s", ci->title);
 		}
+		m_traceLoggerMap.insert( ci->title, TraceLoggerDef( ci->create, false));
 	}
-	return 0;
+	return true;
 }
 
-const ModuleEntryPoint* ModuleLoader::tryLoadPathAsModule( const std::string& modpath)
+bool ModuleLoader::loadModule(const std::string& name)
 {
-	if (m_debugtrace) m_debugtrace->event( "tryload", "module %s", modpath.c_str());
-	if (isFile( modpath))
+	try
 	{
-		ModuleEntryPoint::Status status;
-		ModuleEntryPoint::Handle modhnd = NULL;
-		const ModuleEntryPoint* entrypoint = strus::loadModuleEntryPoint( modpath.c_str(), status, modhnd, &matchModuleVersion);
-		if (!entrypoint)
+		if (hasUpdirReference( name))
 		{
-			m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("error loading module '%s': %s"), modpath.c_str(), status.errormsg);
+			m_errorhnd->report( ErrorCodeInvalidFilePath, _TXT("tried to load module with upper directory reference in the module name"));
+			return false;
 		}
-		else
+		SearchPaths paths;
+		(void)getSearchPaths( paths);
+		ModuleSearch search( name, m_loadMode);
+		searchEntryPoint( search, paths);
+		reportSearch( search);
+		recordLoadMetrics( search);
+		storeModuleIndex();
+		if (search.path.empty())
 		{
-			m_handleList.push_back( modhnd);
+			m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("failed to load module '%s': "), name.c_str());
+			return false;
 		}
-		return entrypoint;
+		return addModule( name, search);
 	}
-	else
+	CATCH_ERROR_MAP_RETURN( _TXT("error loading module: %s"), *m_errorhnd, 0);
+}
+
+/// \brief Queue of module searches processed by a pool of worker threads
+class ModuleSearchQueue
+{
+public:
+	ModuleSearchQueue( const ModuleLoader* loader_, std::vector<ModuleLoader::ModuleSearch>& searchar_, const ModuleLoader::SearchPaths& paths_)
+		:m_loader(loader_),m_searchar(searchar_),m_paths(paths_),m_mutex(),m_next(0){}
+
+	void run()
 	{
-		return NULL;
+		for (;;)
+		{
+			std::size_t idx;
+			{
+				strus::scoped_lock lock( m_mutex);
+				if (m_next >= m_searchar.size()) return;
+				idx = m_next++;
+			}
+			ModuleLoader::ModuleSearch& search = m_searchar[ idx];
+			try
+			{
+				m_loader->searchEntryPoint( search, m_paths);
+			}
+			catch (const std::bad_alloc&)
+			{
+				search.error( ErrorCodeOutOfMem, _TXT("out of memory in module loader"));
+			}
+			catch (const std::exception& err)
+			{
+				search.error( ErrorCodeLoadModuleFailed, err.what());
+			}
+		}
 	}
-}
 
+private:
+	const ModuleLoader* m_loader;
+	std::vector<ModuleLoader::ModuleSearch>& m_searchar;
+	const ModuleLoader::SearchPaths& m_paths;
+	strus::mutex m_mutex;
+	std::size_t m_next;
+};
+
+/// \brief Thread function object of a module search worker
+struct ModuleSearchWorker
+{
+	explicit ModuleSearchWorker( ModuleSearchQueue* queue_)
+		:queue(queue_){}
+	ModuleSearchWorker( const ModuleSearchWorker& o)
+		:queue(o.queue){}
+
+	void operator()()
+	{
+		queue->run();
+	}
+
+	ModuleSearchQueue* queue;
+};
+
+#define MaxModuleSearchThreads 8
+
+bool ModuleLoader::loadModules( const std::vector<std::string>& names)
+{
+	try
+	{
+		std::vector<ModuleSearch> searchar;
+		std::vector<std::string>::const_iterator ni = names.begin(), ne = names.end();
+		for (; ni != ne; ++ni)
+		{
+			if (hasUpdirReference( *ni))
+			{
+				m_errorhnd->report( ErrorCodeInvalidFilePath, _TXT("tried to load module with upper directory reference in the module name"));
+				return false;
+			}
+			searchar.push_back( ModuleSearch( *ni, m_loadMode));
+		}
+		SearchPaths paths;
+		(void)getSearchPaths( paths);
+
+		// Search and open the modules concurrently:
+		ModuleSearchQueue queue( this, searchar, paths);
+		unsigned int nofThreads = strus::thread::hardware_concurrency();
+		if (nofThreads > MaxModuleSearchThreads) nofThreads = MaxModuleSearchThreads;
+		if (nofThreads > searchar.size()) nofThreads = searchar.size();
+		std::vector<strus::thread*> threads;
+		try
+		{
+			for (unsigned int ti=1; ti < nofThreads; ++ti)
+			{
+				threads.push_back( new strus::thread( ModuleSearchWorker( &queue)));
+			}
+		}
+		catch (const std::exception&)
+		{
+			//... failed to create threads, continue with the ones created and the current thread
+		}
+		queue.run();
+		std::vector<strus::thread*>::iterator ti = threads.begin(), te = threads.end();
+		for (; ti != te; ++ti)
+		{
+			(*ti)->join();
+			delete *ti;
+		}
+
+		// Report and register the modules found in the order of the request:
+		bool rt = true;
+		std::vector<ModuleSearch>::iterator si = searchar.begin(), se = searchar.end();
+		for (; si != se; ++si)
+		{
+			reportSearch( *si);
+			recordLoadMetrics( *si);
+			if (si->path.empty())
+			{
+				m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("failed to load module '%s': "), si->name.c_str());
+				rt = false;
+			}
+			else if (!addModule( si->name, *si))
+			{
+				rt = false;
+			}
+		}
+		storeModuleIndex();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error loading modules: %s"), *m_errorhnd, false);
+}
+
+bool ModuleLoader::writePreloadManifest( const std::string& filename) const
+{
+	try
+	{
+		if (!openDeferredModules( -1)) return false;
+		PreloadManifest manifest;
+		{
+			strus::scoped_lock lock( m_moduleMutex);
+			std::vector<LoadedModule>::const_iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+			for (; li != le; ++li)
+			{
+				// ... modules linked statically are found by name without accessing the file system, they are not preloaded
+				if (!li->entryPoint || isStaticModulePath( li->path)) continue;
+				int ec = manifest.add( li->name, li->path, li->entryPoint, entryPointTable( li->entryPoint));
+				if (ec)
+				{
+					m_errorhnd->report( ec, _TXT("failed to inspect module file %s for preload manifest: %s"), li->path.c_str(), ::strerror(ec));
+					return false;
+				}
+			}
+		}
+		int ec = manifest.store( filename);
+		if (ec)
+		{
+			m_errorhnd->report( ec, _TXT("failed to write preload manifest %s: %s"), filename.c_str(), ::strerror(ec));
+			return false;
+		}
+		if (m_debugtrace) m_debugtrace->event( "manifest", "wrote %d modules to %s", (int)manifest.entries().size(), filename.c_str());
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error writing preload manifest: %s"), *m_errorhnd, false);
+}
+
+bool ModuleLoader::loadPreloadManifest( const std::string& filename)
+{
+	try
+	{
+		PreloadManifest manifest;
+		int ec = manifest.load( filename);
+		if (ec)
+		{
+			m_errorhnd->report( ec, _TXT("failed to read preload manifest %s: %s"), filename.c_str(), ::strerror(ec));
+			return false;
+		}
+		SearchPaths paths;
+		bool pathsEvaluated = false;
+		bool rt = true;
+		std::vector<PreloadManifest::Entry>::const_iterator ei = manifest.entries().begin(), ee = manifest.entries().end();
+		for (; ei != ee; ++ei)
+		{
+			if (hasUpdirReference( ei->name))
+			{
+				m_errorhnd->report( ErrorCodeInvalidFilePath, _TXT("tried to load module with upper directory reference in the module name"));
+				return false;
+			}
+			ModuleSearch search( ei->name, m_loadMode);
+			double starttime = getMonotonicTime();
+			bool preloaded = tryLoadPreloaded( search, *ei);
+			search.metrics.statTime += getMonotonicTime() - starttime;
+			if (!preloaded)
+			{
+				// ... module file changed since the manifest was written, fall back to the search by name:
+				if (!pathsEvaluated)
+				{
+					(void)getSearchPaths( paths);
+					pathsEvaluated = true;
+				}
+				searchEntryPoint( search, paths);
+			}
+			reportSearch( search);
+			recordLoadMetrics( search);
+			if (search.path.empty())
+			{
+				m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("failed to load module '%s': "), ei->name.c_str());
+				rt = false;
+			}
+			else if (!addModule( ei->name, search))
+			{
+				rt = false;
+			}
+		}
+		storeModuleIndex();
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error loading modules from preload manifest: %s"), *m_errorhnd, false);
+}
+
+std::vector<std::string> ModuleLoader::moduleLoadTryPaths( const std::string& name)
+{
+	try
+	{
+		SearchPaths paths;
+		(void)getSearchPaths( paths);
+		ModuleSearch search( name, LoadEager);
+		searchEntryPoint( search, paths);
+		reportSearch( search);
+		storeModuleIndex();
+		return search.paths_tried;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error seeking for module (moduleLoadTryPaths): %s"), *m_errorhnd, std::vector<std::string>());
+}
+
+ModuleSnapshotReference ModuleLoader::moduleSnapshot() const
+{
+	strus::scoped_lock lock( m_snapshotMutex);
+	return m_snapshot;
+}
+
+void ModuleLoader::publishSnapshot() const
+{
+	ModuleSnapshotReference snapshot( new ModuleSnapshot());
+	snapshot->modules = m_modules;
+	snapshot->analyzerModules = m_analyzerModules;
+	snapshot->storageModules = m_storageModules;
+	std::vector<const AnalyzerModule*>::const_iterator ai = m_analyzerModules.begin(), ae = m_analyzerModules.end();
+	for (; ai != ae; ++ai)
+	{
+		std::map<const ModuleEntryPoint*,ModuleHandleReference>::const_iterator
+			hi = m_moduleHandleMap.find( reinterpret_cast<const ModuleEntryPoint*>( *ai));
+		snapshot->analyzerModuleHandles.push_back( hi == m_moduleHandleMap.end() ? ModuleHandleReference() : hi->second);
+	}
+	std::vector<const StorageModule*>::const_iterator si = m_storageModules.begin(), se = m_storageModules.end();
+	for (; si != se; ++si)
+	{
+		std::map<const ModuleEntryPoint*,ModuleHandleReference>::const_iterator
+			hi = m_moduleHandleMap.find( reinterpret_cast<const ModuleEntryPoint*>( *si));
+		snapshot->storageModuleHandles.push_back( hi == m_moduleHandleMap.end() ? ModuleHandleReference() : hi->second);
+	}
+	std::vector<DeferredModule>::const_iterator di = m_deferredModules.begin(), de = m_deferredModules.end();
+	for (; di != de; ++di)
+	{
+		snapshot->addDeferred( di->type);
+	}
+	snapshot->generation = m_moduleGeneration;
+
+	// ... the snapshot replaced is deleted by the last reader holding it
+	strus::scoped_lock lock( m_snapshotMutex);
+	m_snapshot = snapshot;
+}
+
+module::StorageObjectBuilder* ModuleLoader::newStorageObjectBuilder( const ModuleSnapshot& snapshot) const
+{
+	strus::local_ptr<module::StorageObjectBuilder> builder( new module::StorageObjectBuilder( m_filelocator, &m_constructorMetrics, m_errorhnd));
+	std::size_t mi = 0, me = snapshot.storageModules.size();
+	for (; mi != me; ++mi)
+	{
+		builder->addStorageModule( snapshot.storageModules[ mi]);
+		if (snapshot.storageModuleHandles[ mi].get()) builder->addModuleHandle( snapshot.storageModuleHandles[ mi]);
+	}
+	return builder.release();
+}
+
+module::AnalyzerObjectBuilder* ModuleLoader::newAnalyzerObjectBuilder( const ModuleSnapshot& snapshot) const
+{
+	strus::local_ptr<module::AnalyzerObjectBuilder> builder( new module::AnalyzerObjectBuilder( m_filelocator, &m_constructorMetrics, m_errorhnd));
+	std::size_t mi = 0, me = snapshot.analyzerModules.size();
+	for (; mi != me; ++mi)
+	{
+		builder->addAnalyzerModule( snapshot.analyzerModules[ mi]);
+		if (snapshot.analyzerModuleHandles[ mi].get()) builder->addModuleHandle( snapshot.analyzerModuleHandles[ mi]);
+	}
+	return builder.release();
+}
+
+StorageObjectBuilderInterface* ModuleLoader::createStorageObjectBuilder() const
+{
+	try
+	{
+		ModuleSnapshotReference snapshot = moduleSnapshot();
+		if (snapshot->hasDeferred( ModuleEntryPoint::Storage))
+		{
+			if (!openDeferredModules( ModuleEntryPoint::Storage)) return 0;
+			snapshot = moduleSnapshot();
+		}
+		{
+			strus::scoped_lock lock( m_builderCacheMutex);
+			if (m_builderCaching)
+			{
+				// ... a cached builder newer than the snapshot of this thread is also accepted
+				if (!m_storageObjectBuilder.get() || m_storageObjectBuilderGeneration < snapshot->generation)
+				{
+					m_storageObjectBuilder.reset();
+					Reference<StorageObjectBuilderInterface> builder( newStorageObjectBuilder( *snapshot));
+					if (!builder.get()) return 0;
+					m_storageObjectBuilder = builder;
+					m_storageObjectBuilderGeneration = snapshot->generation;
+				}
+				return new module::SharedStorageObjectBuilder( m_storageObjectBuilder);
+			}
+		}
+		// ... builders not cached are created without holding any lock of the loader
+		return newStorageObjectBuilder( *snapshot);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage object builder: %s"), *m_errorhnd, 0);
+}
+
+AnalyzerObjectBuilderInterface* ModuleLoader::createAnalyzerObjectBuilder() const
+{
+	try
+	{
+		ModuleSnapshotReference snapshot = moduleSnapshot();
+		if (snapshot->hasDeferred( ModuleEntryPoint::Analyzer))
+		{
+			if (!openDeferredModules( ModuleEntryPoint::Analyzer)) return 0;
+			snapshot = moduleSnapshot();
+		}
+		{
+			strus::scoped_lock lock( m_builderCacheMutex);
+			if (m_builderCaching)
+			{
+				// ... a cached builder newer than the snapshot of this thread is also accepted
+				if (!m_analyzerObjectBuilder.get() || m_analyzerObjectBuilderGeneration < snapshot->generation)
+				{
+					m_analyzerObjectBuilder.reset();
+					Reference<AnalyzerObjectBuilderInterface> builder( newAnalyzerObjectBuilder( *snapshot));
+					if (!builder.get()) return 0;
+					m_analyzerObjectBuilder = builder;
+					m_analyzerObjectBuilderGeneration = snapshot->generation;
+				}
+				return new module::SharedAnalyzerObjectBuilder( m_analyzerObjectBuilder);
+			}
+		}
+		// ... builders not cached are created without holding any lock of the loader
+		return newAnalyzerObjectBuilder( *snapshot);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating analyzer object builder: %s"), *m_errorhnd, 0);
+}
+
+
+/// \brief Factory for the logger a built-in trace logger wrapper forwards its events to
+class ModuleInnerTraceLoggerFactory
+	:public InnerTraceLoggerFactory
+{
+public:
+	ModuleInnerTraceLoggerFactory( const ModuleLoader* loader_, const std::string& name_)
+		:m_loader(loader_),m_name(name_){}
+
+	virtual TraceLoggerInterface* create( const std::string& config) const
+	{
+		return m_loader->createTraceLogger( m_name, config);
+	}
+
+private:
+	const ModuleLoader* m_loader;
+	std::string m_name;
+};
+
+TraceLoggerInterface* ModuleLoader::createTraceLogger( const std::string& loggerName, const std::string& config) const
+{
+	TraceLoggerDef def;
+	{
+		strus::scoped_lock lock( m_moduleMutex);
+		const TraceLoggerDef* found = m_traceLoggerMap.find( loggerName);
+		if (found) def = *found;
+	}
+	if (def.wrap)
+	{
+		// ... a wrapper gets the logger it forwards to by the name defined with 'inner' in the configuration:
+		std::string wrapperConfig( config);
+		std::string innerName;
+		if (!extractStringFromConfigString( innerName, wrapperConfig, "inner", m_errorhnd))
+		{
+			throw strus::runtime_error(_TXT("undefined '%s' in config of trace logger '%s'"), "inner", loggerName.c_str());
+		}
+		return def.wrap( wrapperConfig, ModuleInnerTraceLoggerFactory( this, innerName), m_errorhnd);
+	}
+	if (!def.create)
+	{
+		throw strus::runtime_error(_TXT("unknown trace logger '%s' (did you load its module)"), loggerName.c_str());
+	}
+	return def.create( config, m_errorhnd);
+}
+
+TraceObjectBuilderInterface* ModuleLoader::createTraceObjectBuilder( const std::string& config_) const
+{
+	try
+	{
+		if (moduleSnapshot()->hasDeferred( ModuleEntryPoint::Trace) && !openDeferredModules( ModuleEntryPoint::Trace)) return 0;
+		std::string config( config_);
+		std::string modulename;
+		if (!extractStringFromConfigString( modulename, config, "log", m_errorhnd))
+		{
+			throw strus::runtime_error(_TXT("undefined '%s' in config"), "log");
+		}
+		TraceLoggerInterface* tracelog = createTraceLogger( modulename, config);
+		if (!tracelog)
+		{
+			throw strus::runtime_error( _TXT( "could not load trace processor '%s'"), modulename.c_str());
+		}
+		TraceObjectBuilderInterface* rt = traceCreateObjectBuilder( tracelog, m_errorhnd);
+		if (!rt) delete tracelog;
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating storage object builder: %s"), *m_errorhnd, 0);
+}
+
+std::vector<std::string> ModuleLoader::get3rdPartyLicenseTexts() const
+{
+	(void)openDeferredModules( -1);
+	strus::scoped_lock lock( m_moduleMutex);
+	return m_license_3rdparty_ar;
+
+}
+std::vector<std::string> ModuleLoader::get3rdPartyVersionTexts() const
+{
+	(void)openDeferredModules( -1);
+	strus::scoped_lock lock( m_moduleMutex);
+	return m_version_3rdparty_ar;
+}
+
+static bool matchVersion( int type, const char* signature, unsigned short modversion_minor, unsigned short compversion_major, unsigned short compversion_minor, int& errorcode)
+{
+	const char* loader_signature = STRUS_MODULE_SIGNATURE;
+	//... signature contains major version number in it
+	if (std::strcmp( signature, loader_signature) != 0)
+	{
+		errorcode = ModuleEntryPoint::ErrorSignature;
+		return false;
+	}
+	unsigned short expected_modversion_minor = STRUS_MODULE_VERSION_MINOR;
+	if (modversion_minor > expected_modversion_minor)
+	{
+		errorcode = ModuleEntryPoint::ErrorModMinorVersion;
+		return false;
+	}
+	unsigned short expected_compversion_major = 0;
+	unsigned short expected_compversion_minor = 0;
+	switch (type)
+	{
+		case ModuleEntryPoint::Analyzer:
+			expected_compversion_major = STRUS_ANALYZER_VERSION_MAJOR;
+			expected_compversion_minor = STRUS_ANALYZER_VERSION_MINOR;
+			break;
+
+		case ModuleEntryPoint::Storage:
+			expected_compversion_major = STRUS_STORAGE_VERSION_MAJOR;
+			expected_compversion_minor = STRUS_STORAGE_VERSION_MINOR;
+			break;
+
+		case ModuleEntryPoint::Trace:
+			expected_compversion_major = STRUS_TRACE_VERSION_MAJOR;
+			expected_compversion_minor = STRUS_TRACE_VERSION_MINOR;
+			break;
+
+		default:
+			errorcode = ModuleEntryPoint::ErrorUnknownModuleType;
+			return false;
+	}
+	if (compversion_major != expected_compversion_major)
+	{
+		errorcode = ModuleEntryPoint::ErrorCompMajorVersion;
+		return false;
+	}
+	if (compversion_minor < expected_compversion_minor)
+	{
+		errorcode = ModuleEntryPoint::ErrorCompMinorVersion;
+		return false;
+	}
+	return true;
+}
+
+static bool matchModuleVersion( const ModuleEntryPoint* entryPoint, int& errorcode)
+{
+	return matchVersion( entryPoint->type, entryPoint->signature, entryPoint->modversion_minor, entryPoint->compversion_major, entryPoint->compversion_minor, errorcode);
+}
+
+/// \brief Version check of a module opened from the preload manifest, the versions recorded in the manifest for the unchanged file have been checked already
+static bool acceptModuleVersion( const ModuleEntryPoint*, int&)
+{
+	return true;
+}
+
+static const ModuleEntryPoint* openModuleMeasured( const std::string& modpath, ModuleEntryPoint::BindingMode bindingMode, MatchModuleVersionFunc matchVersionFunc, ModuleEntryPoint::Handle& modhnd, ModuleEntryPoint::Status& status, ModuleLoadMetrics& metrics)
+{
+	long memstart = getResidentMemory();
+	const ModuleEntryPoint* rt = strus::loadModuleEntryPoint( modpath.c_str(), status, modhnd, matchVersionFunc, bindingMode);
+	long memend = getResidentMemory();
+	metrics.openTime += status.openTime;
+	metrics.versionCheckTime += status.matchVersionTime;
+	if (memstart >= 0 && memend >= 0) metrics.memoryDelta += memend - memstart;
+	return rt;
+}
+
+static std::string moduleFileName( const std::string& name)
+{
+	std::string rt;
+	if (stringStartsWith( name, "modstrus_"))
+	{
+		rt = name;
+	}
+	else if (stringStartsWith( name, "strus_"))
+	{
+		rt = "mod" + name;
+	}
+	else
+	{
+		rt = "modstrus_" + name;
+	}
+	std::size_t extlen = std::strlen( STRUS_MODULE_EXTENSION);
+	if (rt.size() < extlen || !strus::caseInsensitiveEquals( rt.c_str() + rt.size() - extlen, STRUS_MODULE_EXTENSION))
+	{
+		rt.append( STRUS_MODULE_EXTENSION);
+	}
+	return rt;
+}
+
+bool ModuleLoader::tryLoadStaticModule( ModuleSearch& search) const
+{
+	const StaticModuleRegistration* reg = strus::staticModules();
+	if (!reg) return false;
+	std::string modfilebase = moduleFileName( search.name);
+	if (0!=std::strchr( modfilebase.c_str(), strus::dirSeparator())) return false;
+	for (; reg; reg = reg->next)
+	{
+		if (strus::caseInsensitiveEquals( moduleFileName( reg->name), modfilebase)) break;
+	}
+	if (!reg) return false;
+
+	std::string modpath = STATIC_MODULE_PATH_PREFIX + modfilebase;
+	search.paths_tried.push_back( modpath);
+	int errorcode = 0;
+	if (!matchModuleVersion( reg->entryPoint, errorcode))
+	{
+		search.error( ErrorCodeLoadModuleFailed, strus::string_format( _TXT("module '%s' linked statically does not match the module loader version (error %d)"), search.name.c_str(), errorcode));
+		return true;
+	}
+	search.path = modpath;
+	search.type = reg->entryPoint->type;
+	search.entryPoint = reg->entryPoint;
+	search.event( "static", "module " + modpath);
+	return true;
+}
+
+bool ModuleLoader::loadModuleAlt(
+		ModuleSearch& search,
+		const std::vector<std::string>& paths) const
+{
+	std::string modfilebase = moduleFileName( search.name);
+	bool isBaseName = 0==std::strchr( modfilebase.c_str(), strus::dirSeparator());
+	bool useDiscovery = m_moduleDiscovery && isBaseName;
+	bool useIndex = m_moduleIndex && isBaseName;
+
+	std::vector<std::string>::const_iterator pi = paths.begin(), pe = paths.end();
+	for (; pi != pe; ++pi)
+	{
+		std::string modfilename = strus::joinFilePath( *pi, modfilebase);
+		search.paths_tried.push_back( modfilename);
+		bool checkFile = true;
+		if (useDiscovery)
+		{
+			strus::scoped_lock lock( m_moduleDiscoveryMutex);
+			ModuleDiscovery::LookupResult res = m_moduleDiscovery->lookup( *pi, modfilebase);
+			if (res == ModuleDiscovery::NotFound)
+			{
+				search.event( "discoverymiss", "module " + modfilename);
+				continue;
+			}
+			checkFile = (res != ModuleDiscovery::Found);
+		}
+		// ... with the module file discovered, the index is only needed for the module type in mode LoadDeferred:
+		if (useIndex && (checkFile || search.loadMode == LoadDeferred))
+		{
+			strus::scoped_lock lock( m_moduleIndexMutex);
+			bool scanned = false;
+			ModuleIndex::LookupResult res = m_moduleIndex->lookup( *pi, modfilebase, scanned);
+			if (res == ModuleIndex::NotFound)
+			{
+				search.event( "indexmiss", "module " + modfilename);
+				continue;
+			}
+			if (res == ModuleIndex::Found)
+			{
+				// ... the directory has just been checked or scanned, so the file exists
+				checkFile = false;
+				if (!scanned)
+				{
+					search.metrics.fromIndex = true;
+					search.event( "indexhit", "module " + modfilename);
+				}
+			}
+			const ModuleIndex::Entry* entry = m_moduleIndex->get( *pi, modfilebase);
+			if (entry && entry->loaded())
+			{
+				search.type = entry->type;
+			}
+		}
+		if (tryLoadPathAsModule( search, modfilename, checkFile))
+		{
+			search.event( "entrypoint", "module " + modfilename);
+			// ... the index records one type per module file, modules with entry points of different types are not recorded
+			const ModuleEntryPoint* const* table = search.handle ? strus::getModuleEntryPointTable( search.handle) : NULL;
+			if (useIndex && search.entryPoint && (!table || entryPointTableType( table) >= 0))
+			{
+				strus::scoped_lock lock( m_moduleIndexMutex);
+				m_moduleIndex->update( *pi, modfilebase, search.entryPoint);
+			}
+			return true;
+		}
+		search.type = -1;
+	}
+	return false;
+}
+
+bool ModuleLoader::tryLoadPathAsModule( ModuleSearch& search, const std::string& modpath, bool checkFile) const
+{
+	search.event( "tryload", "module " + modpath);
+	if (!checkFile || isFile( modpath))
+	{
+		if (search.loadMode == LoadDeferred)
+		{
+			search.path = modpath;
+			return true;
+		}
+		ModuleEntryPoint::Status status;
+		ModuleEntryPoint::Handle modhnd = NULL;
+		ModuleEntryPoint::BindingMode bindingMode = (search.loadMode == LoadLazy) ? ModuleEntryPoint::BindLazy : ModuleEntryPoint::BindNow;
+		const ModuleEntryPoint* entrypoint = openModuleMeasured( modpath, bindingMode, &matchModuleVersion, modhnd, status, search.metrics);
+		if (!entrypoint)
+		{
+			search.error( ErrorCodeLoadModuleFailed, strus::string_format( _TXT("error loading module '%s': %s"), modpath.c_str(), status.errormsg));
+			return false;
+		}
+		search.path = modpath;
+		search.entryPoint = entrypoint;
+		search.handle = modhnd;
+		search.type = entrypoint->type;
+		return true;
+	}
+	else
+	{
+		return false;
+	}
+}
+
+bool ModuleLoader::tryLoadPreloaded( ModuleSearch& search, const PreloadManifest::Entry& entry) const
+{
+	ModuleFileStat st;
+	if (0!=getModuleFileStat( entry.path, st) || st != entry.stat)
+	{
+		search.event( "preloadmiss", "module " + entry.path + " changed");
+		return false;
+	}
+	if (entry.type < 0)
+	{
+		search.event( "preloadmiss", "module " + entry.path + " with entry points of different types");
+		return false;
+	}
+	int errorcode = 0;
+	if (!matchVersion( entry.type, entry.signature.c_str(), entry.modversion_minor, entry.compversion_major, entry.compversion_minor, errorcode))
+	{
+		search.event( "preloadmiss", "module " + entry.path + " recorded for another version");
+		return false;
+	}
+	search.paths_tried.push_back( entry.path);
+	search.type = entry.type;
+	if (search.loadMode == LoadDeferred)
+	{
+		// ... type known from the manifest, the module is opened only with the first object builder of its type
+		search.path = entry.path;
+		search.event( "preload", "module " + entry.path);
+		return true;
+	}
+	ModuleEntryPoint::Status status;
+	ModuleEntryPoint::Handle modhnd = NULL;
+	ModuleEntryPoint::BindingMode bindingMode = (search.loadMode == LoadLazy) ? ModuleEntryPoint::BindLazy : ModuleEntryPoint::BindNow;
+	const ModuleEntryPoint* entrypoint = openModuleMeasured( entry.path, bindingMode, &acceptModuleVersion, modhnd, status, search.metrics);
+	if (!entrypoint || (int)entrypoint->type != entry.type)
+	{
+		// ... no object has been created with code of the module, so it can be closed (ModuleEntryPoint::closeHandle does nothing)
+		if (modhnd) strus::unloadModuleHandle( modhnd);
+		search.event( "preloadmiss", "module " + entry.path + " failed to open");
+		search.type = -1;
+		return false;
+	}
+	search.path = entry.path;
+	search.entryPoint = entrypoint;
+	search.handle = modhnd;
+	search.event( "preload", "module " + entry.path);
+	return true;
+}
+
+bool ModuleLoader::openDeferredModules( int type) const
+{
+	strus::scoped_lock lock( m_moduleMutex);
+	bool rt = true;
+	std::vector<DeferredModule>::iterator di = m_deferredModules.begin();
+	while (di != m_deferredModules.end())
+	{
+		if (!di->entryPoint && (type < 0 || di->type < 0 || di->type == type))
+		{
+			if (m_debugtrace) m_debugtrace->event( "open", "module %s", di->path.c_str());
+			ModuleEntryPoint::Status status;
+			ModuleEntryPoint::Handle modhnd = NULL;
+			ModuleLoadMetrics metrics;
+			di->entryPoint = openModuleMeasured( di->path, ModuleEntryPoint::BindNow, &matchModuleVersion, modhnd, status, metrics);
+			std::vector<ModuleLoadMetrics>::iterator mi = m_loadMetrics.begin(), me = m_loadMetrics.end();
+			for (; mi != me; ++mi)
+			{
+				if (mi->path == di->path && mi->openTime == 0.0)
+				{
+					mi->openTime = metrics.openTime;
+					mi->versionCheckTime = metrics.versionCheckTime;
+					mi->memoryDelta = metrics.memoryDelta;
+				}
+			}
+			if (!di->entryPoint)
+			{
+				m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("error loading deferred module '%s': %s"), di->path.c_str(), status.errormsg);
+				di = m_deferredModules.erase( di);
+				rt = false;
+				continue;
+			}
+			addModuleHandle( modhnd, di->entryPoint);
+			di->type = moduleType( di->entryPoint);
+			std::vector<LoadedModule>::iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+			for (; li != le; ++li)
+			{
+				if (!li->entryPoint && li->path == di->path)
+				{
+					li->entryPoint = di->entryPoint;
+					if (m_moduleWatcher) watchLoadedModule( *li);
+				}
+			}
+		}
+		// ... a module with entry points of different types is registered with the first object builder of any type
+		if (di->entryPoint && (type < 0 || di->type < 0 || di->type == type))
+		{
+			if (!registerModule( di->entryPoint)) rt = false;
+			di = m_deferredModules.erase( di);
+		}
+		else
+		{
+			++di;
+		}
+	}
+	publishSnapshot();
+	return rt;
+}
+
+void ModuleLoader::watchLoadedModule( LoadedModule& module) const
+{
+	// ... modules linked statically cannot change
+	if (!module.entryPoint || isStaticModulePath( module.path)) return;
+	(void)getModuleFileStat( module.path, module.stat);
+	std::string dirpath;
+	if (0==strus::getParentPath( module.path, dirpath))
+	{
+		int ec = m_moduleWatcher->watch( dirpath);
+		if (ec && m_debugtrace) m_debugtrace->event( "watch", "failed to watch %s, checking module files on every reload: %s", dirpath.c_str(), ::strerror(ec));
+	}
+}
+
+bool ModuleLoader::enableModuleReload( const std::string& copyDirectory)
+{
+	try
+	{
+		if (!strus::isDir( copyDirectory))
+		{
+			m_errorhnd->report( ErrorCodeInvalidFilePath, _TXT("directory for copies of modules reloaded does not exist: '%s'"), copyDirectory.c_str());
+			return false;
+		}
+		strus::local_ptr<ModuleWatcher> watcher( new ModuleWatcher());
+		strus::scoped_lock reloadLock( m_reloadMutex);
+		strus::scoped_lock lock( m_moduleMutex);
+		if (m_moduleWatcher) delete m_moduleWatcher;
+		m_moduleWatcher = watcher.release();
+		m_reloadCopyDirectory = copyDirectory;
+		std::vector<LoadedModule>::iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+		for (; li != le; ++li)
+		{
+			watchLoadedModule( *li);
+		}
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error enabling module reload: %s"), *m_errorhnd, false);
+}
+
+int ModuleLoader::reloadChangedModules()
+{
+	try
+	{
+		strus::scoped_lock reloadLock( m_reloadMutex);
+		std::vector<LoadedModule> candidates;
+		{
+			strus::scoped_lock lock( m_moduleMutex);
+			if (!m_moduleWatcher)
+			{
+				m_errorhnd->report( ErrorCodeOperationOrder, _TXT("module reload not enabled (enableModuleReload)"));
+				return -1;
+			}
+			if (!m_moduleWatcher->changed()) return 0;
+			candidates = m_loadedModules;
+		}
+		// ... modules are checked outside the module lock, so that object builders can be created meanwhile
+		int rt = 0;
+		bool success = true;
+		std::set<const ModuleEntryPoint*> visited;
+		std::vector<LoadedModule>::const_iterator ci = candidates.begin(), ce = candidates.end();
+		for (; ci != ce; ++ci)
+		{
+			// ... modules not opened yet are opened from their file when needed, modules loaded twice are reloaded once
+			if (!ci->entryPoint || !visited.insert( ci->entryPoint).second) continue;
+			ModuleFileStat st;
+			if (0!=getModuleFileStat( ci->path, st)) continue;
+			if (st == ci->stat || st == ci->failedStat) continue;
+			if (reloadModule( *ci, st))
+			{
+				++rt;
+			}
+			else
+			{
+				markModuleReloadFailed( ci->entryPoint, st);
+				success = false;
+			}
+		}
+		return success ? rt : -1;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error reloading modules: %s"), *m_errorhnd, -1);
+}
+
+bool ModuleLoader::reloadModule( const LoadedModule& module, const ModuleFileStat& stat)
+{
+	// ... opening the same path again would return the handle of the version loaded, so we open a copy with a unique name.
+	//	The copy is removed after opening it. With unloading enabled, the version replaced is unloaded when the last builder referencing it is deleted:
+	std::string filename;
+	int ec = strus::getFileName( module.path, filename, true);
+	if (ec)
+	{
+		m_errorhnd->report( ec, _TXT("failed to reload module '%s': %s"), module.path.c_str(), ::strerror(ec));
+		return false;
+	}
+	std::string copypath = strus::joinFilePath( m_reloadCopyDirectory, strus::string_format( "%s.%d.%u", filename.c_str(), (int)::getpid(), ++m_reloadCounter));
+	std::string content;
+	ec = strus::readFile( module.path, content);
+	if (!ec) ec = strus::writeFile( copypath, content);
+	if (ec)
+	{
+		(void)strus::removeFile( copypath);
+		m_errorhnd->report( ec, _TXT("failed to copy module '%s' to '%s' for reloading it: %s"), module.path.c_str(), copypath.c_str(), ::strerror(ec));
+		return false;
+	}
+	ModuleEntryPoint::Status status;
+	ModuleEntryPoint::Handle modhnd = NULL;
+	const ModuleEntryPoint* entryPoint = strus::loadModuleEntryPoint( copypath.c_str(), status, modhnd, &matchModuleVersion, ModuleEntryPoint::BindNow);
+	(void)strus::removeFile( copypath);
+	if (!entryPoint)
+	{
+		m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("error reloading module '%s': %s"), module.path.c_str(), status.errormsg);
+		return false;
+	}
+	strus::scoped_lock lock( m_moduleMutex);
+	const ModuleEntryPoint* const* table = strus::getModuleEntryPointTable( modhnd);
+	if ((table ? entryPointTableType( table) : (int)entryPoint->type) != moduleType( module.entryPoint))
+	{
+		ModuleHandle rejected( modhnd, m_moduleUnloading);
+		m_errorhnd->report( ErrorCodeLoadModuleFailed, _TXT("error reloading module '%s': type of module changed"), module.path.c_str());
+		return false;
+	}
+	addModuleHandle( modhnd, entryPoint);
+	replaceModule( module.entryPoint, entryPoint);
+	// ... the version replaced is unloaded when the object builders created with it are deleted
+	eraseModuleHandle( module.entryPoint);
+	std::vector<LoadedModule>::iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+	for (; li != le; ++li)
+	{
+		if (li->entryPoint == module.entryPoint)
+		{
+			li->entryPoint = entryPoint;
+			li->bindLazy = false;
+			li->stat = stat;
+		}
+	}
+	++m_moduleGeneration;
+	publishSnapshot();
+	if (m_debugtrace) m_debugtrace->event( "reload", "module %s", module.path.c_str());
+	return true;
+}
+
+void ModuleLoader::replaceModule( const ModuleEntryPoint* oldEntryPoint, const ModuleEntryPoint* newEntryPoint)
+{
+	// ... a module not registered yet is replaced in the list of deferred modules and registered later
+	bool deferred = false;
+	std::vector<DeferredModule>::iterator di = m_deferredModules.begin(), de = m_deferredModules.end();
+	for (; di != de; ++di)
+	{
+		if (di->entryPoint == oldEntryPoint)
+		{
+			di->entryPoint = newEntryPoint;
+			deferred = true;
+		}
+	}
+	if (deferred) return;
+
+	const ModuleEntryPoint* const* oldTable = entryPointTable( oldEntryPoint);
+	const ModuleEntryPoint* const* newTable = entryPointTable( newEntryPoint);
+	if (!oldTable && !newTable)
+	{
+		replaceEntryPoint( oldEntryPoint, newEntryPoint);
+		return;
+	}
+	// ... the entry points of tables are replaced by position, the ones added or removed by the new version are registered or unregistered
+	const ModuleEntryPoint* oldSingle[2] = {oldEntryPoint, NULL};
+	const ModuleEntryPoint* newSingle[2] = {newEntryPoint, NULL};
+	const ModuleEntryPoint* const* oi = oldTable ? oldTable : oldSingle;
+	const ModuleEntryPoint* const* ni = newTable ? newTable : newSingle;
+	for (; *oi || *ni; oi += (*oi ? 1:0), ni += (*ni ? 1:0))
+	{
+		replaceEntryPoint( *oi, *ni);
+	}
+}
+
+void ModuleLoader::unregisterEntryPoint( const ModuleEntryPoint* entryPoint) const
+{
+	switch (entryPoint->type)
+	{
+		case ModuleEntryPoint::Analyzer:
+		{
+			std::vector<const AnalyzerModule*>::iterator
+				mi = std::find( m_analyzerModules.begin(), m_analyzerModules.end(), reinterpret_cast<const AnalyzerModule*>( entryPoint));
+			if (mi != m_analyzerModules.end()) m_analyzerModules.erase( mi);
+			break;
+		}
+		case ModuleEntryPoint::Storage:
+		{
+			std::vector<const StorageModule*>::iterator
+				mi = std::find( m_storageModules.begin(), m_storageModules.end(), reinterpret_cast<const StorageModule*>( entryPoint));
+			if (mi != m_storageModules.end()) m_storageModules.erase( mi);
+			break;
+		}
+		case ModuleEntryPoint::Trace:
+			// ... trace loggers stay defined, because the trace loggers created are not tracked
+			break;
+	}
+}
+
+void ModuleLoader::replaceEntryPoint( const ModuleEntryPoint* oldEntryPoint, const ModuleEntryPoint* newEntryPoint) const
+{
+	// ... an entry point replaced by one of another type or by none is unregistered, an entry point replacing none is added
+	if (oldEntryPoint && (!newEntryPoint || oldEntryPoint->type != newEntryPoint->type))
+	{
+		unregisterEntryPoint( oldEntryPoint);
+		oldEntryPoint = NULL;
+	}
+	if (!newEntryPoint) return;
+	switch (newEntryPoint->type)
+	{
+		case ModuleEntryPoint::Analyzer:
+		{
+			const AnalyzerModule* oldmod = reinterpret_cast<const AnalyzerModule*>( oldEntryPoint);
+			const AnalyzerModule* newmod = reinterpret_cast<const AnalyzerModule*>( newEntryPoint);
+			if (oldmod && m_analyzerModules.end() != std::find( m_analyzerModules.begin(), m_analyzerModules.end(), oldmod))
+			{
+				std::replace( m_analyzerModules.begin(), m_analyzerModules.end(), oldmod, newmod);
+			}
+			else
+			{
+				m_analyzerModules.push_back( newmod);
+			}
+			break;
+		}
+		case ModuleEntryPoint::Storage:
+		{
+			const StorageModule* oldmod = reinterpret_cast<const StorageModule*>( oldEntryPoint);
+			const StorageModule* newmod = reinterpret_cast<const StorageModule*>( newEntryPoint);
+			if (oldmod && m_storageModules.end() != std::find( m_storageModules.begin(), m_storageModules.end(), oldmod))
+			{
+				std::replace( m_storageModules.begin(), m_storageModules.end(), oldmod, newmod);
+			}
+			else
+			{
+				m_storageModules.push_back( newmod);
+			}
+			break;
+		}
+		case ModuleEntryPoint::Trace:
+		{
+			// ... trace loggers removed in the new version stay defined by the old version
+			const TraceModule* mod = reinterpret_cast<const TraceModule*>( newEntryPoint);
+			const TraceLoggerConstructor* ci = mod->traceLoggerConstructors;
+			for (; ci && ci->title; ++ci)
+			{
+				m_traceLoggerMap.insert( ci->title, TraceLoggerDef( ci->create, false));
+			}
+			break;
+		}
+	}
+}
+
+void ModuleLoader::markModuleReloadFailed( const ModuleEntryPoint* entryPoint, const ModuleFileStat& stat)
+{
+	strus::scoped_lock lock( m_moduleMutex);
+	std::vector<LoadedModule>::iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+	for (; li != le; ++li)
+	{
+		if (li->entryPoint == entryPoint) li->failedStat = stat;
+	}
+}
+
+void ModuleLoader::defineModuleUnloading( bool enable)
+{
+	strus::scoped_lock lock( m_moduleMutex);
+	m_moduleUnloading = enable;
+}
+
+bool ModuleLoader::unloadModule( const std::string& name)
+{
+	try
+	{
+		strus::scoped_lock lock( m_moduleMutex);
+		std::size_t lidx = 0;
+		for (; lidx < m_loadedModules.size() && m_loadedModules[ lidx].name != name; ++lidx){}
+		if (lidx == m_loadedModules.size())
+		{
+			m_errorhnd->report( ErrorCodeNotFound, _TXT("failed to unload module '%s': module not loaded"), name.c_str());
+			return false;
+		}
+		LoadedModule module( m_loadedModules[ lidx]);
+		std::vector<DeferredModule>::iterator di = m_deferredModules.begin(), de = m_deferredModules.end();
+		for (; di != de && (di->path != module.path || di->entryPoint != module.entryPoint); ++di){}
+
+		const ModuleEntryPoint* const* table = module.entryPoint ? entryPointTable( module.entryPoint) : NULL;
+		bool isTrace = module.entryPoint ? hasTraceEntryPoint( module.entryPoint, table) : (di != de && di->type == ModuleEntryPoint::Trace);
+		if (isTrace)
+		{
+			m_errorhnd->report( ErrorCodeNotImplemented, _TXT("failed to unload module '%s': trace modules cannot be unloaded"), name.c_str());
+			return false;
+		}
+		if (di != de)
+		{
+			m_deferredModules.erase( di);
+		}
+		else if (table)
+		{
+			for (; *table; ++table) unregisterEntryPoint( *table);
+		}
+		else if (module.entryPoint)
+		{
+			unregisterEntryPoint( module.entryPoint);
+		}
+		// ... m_modules and m_loadedModules are filled in parallel by addModule
+		m_loadedModules.erase( m_loadedModules.begin() + lidx);
+		m_modules.erase( m_modules.begin() + lidx);
+
+		// ... the module is released by the loader if not loaded under another name
+		std::vector<LoadedModule>::const_iterator li = m_loadedModules.begin(), le = m_loadedModules.end();
+		for (; li != le && (!module.entryPoint || li->entryPoint != module.entryPoint); ++li){}
+		if (module.entryPoint && li == le)
+		{
+			eraseModuleHandle( module.entryPoint);
+		}
+		++m_moduleGeneration;
+		publishSnapshot();
+		if (m_debugtrace) m_debugtrace->event( "unload", "module %s", module.path.c_str());
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error unloading module: %s"), *m_errorhnd, false);
+}
 
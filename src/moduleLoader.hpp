@@ -9,9 +9,19 @@
 #define _STRUS_MODULE_LOADER_HPP_INCLUDED
 #include "strus/moduleLoaderInterface.hpp"
 #include "strus/moduleEntryPoint.hpp"
+#include "strus/traceModule.hpp"
 #include "strus/fileLocatorInterface.hpp"
+#include "strus/reference.hpp"
+#include "strus/base/thread.hpp"
+#include "caseInsensitiveHashMap.hpp"
+#include "preloadManifest.hpp"
+#include "moduleHandle.hpp"
+#include "moduleSnapshot.hpp"
+#include "traceLoggerWrapper.hpp"
+#include "loadMetrics.hpp"
 #include <string>
 #include <vector>
+#include <map>
 
 namespace strus
 {
@@ -45,6 +55,18 @@ class ErrorBufferInterface;
 class DebugTraceContextInterface;
 /// \brief Forward declaration
 class FileLocatorInterface;
+/// \brief Forward declaration
+class ModuleIndex;
+/// \brief Forward declaration
+class ModuleDiscovery;
+/// \brief Forward declaration
+class ModuleWatcher;
+namespace module {
+/// \brief Forward declaration
+class StorageObjectBuilder;
+/// \brief Forward declaration
+class AnalyzerObjectBuilder;
+}
 
 
 /// \brief Implementation of ModuleLoaderInterface
@@ -57,12 +79,25 @@ public:
 	virtual void addSystemModulePath();
 	virtual void addModulePath( const std::string& path);
 	virtual bool loadModule( const std::string& name);
+	virtual bool loadModules( const std::vector<std::string>& names);
+	virtual bool writePreloadManifest( const std::string& filename) const;
+	virtual bool loadPreloadManifest( const std::string& filename);
+	virtual bool enableModuleReload( const std::string& copyDirectory);
+	virtual int reloadChangedModules();
+	virtual void defineModuleUnloading( bool enable);
+	virtual bool unloadModule( const std::string& name);
 	virtual std::vector<std::string> moduleLoadTryPaths( const std::string& name);
 	virtual void addResourcePath( const std::string& path);
 	virtual void defineWorkingDirectory( const std::string& path);
+	virtual void defineModuleIndexFile( const std::string& filename);
+	virtual void defineLoadMode( const LoadMode& mode);
+	virtual void defineBuilderCaching( bool enable);
+	virtual void defineModuleDiscovery( bool enable);
+	virtual bool prepare();
+	virtual bool activate();
 
-	virtual std::vector<std::string> modulePaths() const		{return m_modulePaths;}
-	virtual std::vector<std::string> modules() const		{return m_modules;}
+	virtual std::vector<std::string> modulePaths() const;
+	virtual std::vector<std::string> modules() const		{return moduleSnapshot()->modules;}
 	virtual std::vector<std::string> resourcePaths() const		{return m_filelocator->getResourcePaths();}
 	virtual std::string workingDirectory() const			{return m_filelocator->getWorkingDirectory();}
 
@@ -70,31 +105,213 @@ public:
 	virtual AnalyzerObjectBuilderInterface* createAnalyzerObjectBuilder() const;
 	virtual TraceObjectBuilderInterface* createTraceObjectBuilder( const std::string& config) const;
 
+	virtual std::vector<ModuleLoadMetrics> moduleLoadMetrics() const;
+	virtual std::vector<ModuleConstructorMetrics> constructorMetrics() const;
+
 	virtual std::vector<std::string> get3rdPartyLicenseTexts() const;
 	virtual std::vector<std::string> get3rdPartyVersionTexts() const;
 
-private:
-	const ModuleEntryPoint* searchAndLoadEntryPoint( const std::string& name, std::vector<std::string>& paths_tried);
-	const ModuleEntryPoint* loadModuleAlt(
-			const std::string& name,
-			const std::vector<std::string>& paths,
-			std::vector<std::string>& paths_tried);
-	const ModuleEntryPoint* tryLoadPathAsModule( const std::string& modpath);
+public/*ModuleSearchQueue*/:
+	/// \brief State of the search for a module, possibly filled in a worker thread and reported later in the thread owning the loader
+	struct ModuleSearch
+	{
+		struct Message
+		{
+			const char* type;
+			std::string text;
+
+			Message( const char* type_, const std::string& text_)
+				:type(type_),text(text_){}
+			Message( const Message& o)
+				:type(o.type),text(o.text){}
+		};
+		struct Error
+		{
+			int errorcode;
+			std::string text;
+
+			Error( int errorcode_, const std::string& text_)
+				:errorcode(errorcode_),text(text_){}
+			Error( const Error& o)
+				:errorcode(o.errorcode),text(o.text){}
+		};
+
+		std::string name;				///< name of the module searched
+		LoadMode loadMode;				///< mode of loading the module
+		std::string path;				///< path of the module file found or empty
+		int type;					///< ModuleEntryPoint::Type of the module found or -1 if not known
+		const ModuleEntryPoint* entryPoint;		///< entry point of the module found or NULL if not found or not opened (LoadDeferred)
+		ModuleEntryPoint::Handle handle;		///< handle of the module found or NULL
+		std::vector<std::string> paths_tried;		///< list of file paths tried to load
+		std::vector<Message> events;			///< debug trace events
+		std::vector<Error> errors;			///< errors to report
+		ModuleLoadMetrics metrics;			///< time and memory spent, statTime includes the other times until the search is recorded
+
+		ModuleSearch( const std::string& name_, LoadMode loadMode_)
+			:name(name_),loadMode(loadMode_),path(),type(-1),entryPoint(0),handle(0),paths_tried(),events(),errors(),metrics(){}
+		ModuleSearch( const ModuleSearch& o)
+			:name(o.name),loadMode(o.loadMode),path(o.path),type(o.type),entryPoint(o.entryPoint),handle(o.handle)
+			,paths_tried(o.paths_tried),events(o.events),errors(o.errors),metrics(o.metrics){}
+
+		void event( const char* type, const std::string& text)
+		{
+			events.push_back( Message( type, text));
+		}
+		void error( int errorcode, const std::string& text)
+		{
+			errors.push_back( Error( errorcode, text));
+		}
+	};
 
+	/// \brief Paths to search for modules, evaluated once for a search
+	struct SearchPaths
+	{
+		std::vector<std::string> modulePaths;		///< paths defined with addModulePath or addSystemModulePath
+		std::vector<std::string> envPaths;		///< paths defined in the environment or the system module path as fallback
+		int envError;					///< error reading the environment or 0
+
+		SearchPaths()
+			:modulePaths(),envPaths(),envError(0){}
+	};
+
+	/// \brief Search a module and open it, does not modify the loader except for the module index, thread safe
+	void searchEntryPoint( ModuleSearch& search, const SearchPaths& paths) const;
+
+public/*ModuleInnerTraceLoggerFactory*/:
+	/// \brief Create a trace logger registered by name, a built-in wrapper creates the logger named with 'inner' in the configuration with this method too
 	TraceLoggerInterface* createTraceLogger( const std::string& loggerName, const std::string& config) const;
 
 private:
-	std::vector<std::string> m_modulePaths;
+	bool getSearchPaths( SearchPaths& paths);
+	bool loadModuleAlt(
+			ModuleSearch& search,
+			const std::vector<std::string>& paths) const;
+	bool tryLoadStaticModule( ModuleSearch& search) const;
+	bool tryLoadPathAsModule( ModuleSearch& search, const std::string& modpath, bool checkFile) const;
+	bool tryLoadPreloaded( ModuleSearch& search, const PreloadManifest::Entry& entry) const;
+	void reportSearch( ModuleSearch& search);
+	void addModuleHandle( ModuleEntryPoint::Handle hnd, const ModuleEntryPoint* entryPoint) const;
+	void eraseModuleHandle( const ModuleEntryPoint* entryPoint) const;
+	/// \brief Get the table of entry points of a module with more than one or NULL, to be called with m_moduleMutex locked
+	const ModuleEntryPoint* const* entryPointTable( const ModuleEntryPoint* entryPoint) const;
+	/// \brief Get the type of a module, -1 if it has entry points of different types, to be called with m_moduleMutex locked
+	int moduleType( const ModuleEntryPoint* entryPoint) const;
+	static bool hasTraceEntryPoint( const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table);
+	void recordLoadMetrics( const ModuleSearch& search);
+	bool addModule( const std::string& name, const ModuleSearch& search);
+	bool registerModule( const ModuleEntryPoint* entryPoint) const;
+	/// \brief Check an entry point of a module before registering any of them (version, type and trace loggers defined)
+	/// \param[in] table all entry points of the module, NULL terminated, the ones before entryPoint checked already
+	bool checkEntryPoint( const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table) const;
+	bool registerEntryPoint( const ModuleEntryPoint* entryPoint) const;
+	void unregisterEntryPoint( const ModuleEntryPoint* entryPoint) const;
+	void replaceEntryPoint( const ModuleEntryPoint* oldEntryPoint, const ModuleEntryPoint* newEntryPoint) const;
+	bool registerTraceModule( const TraceModule* mod) const;
+	void defineBuiltInTraceLoggers();
+	bool openDeferredModules( int type) const;
+	module::StorageObjectBuilder* newStorageObjectBuilder( const ModuleSnapshot& snapshot) const;
+	module::AnalyzerObjectBuilder* newAnalyzerObjectBuilder( const ModuleSnapshot& snapshot) const;
+	/// \brief Get the current snapshot of the module set, the only access of builder creation to the module set besides opening deferred modules
+	ModuleSnapshotReference moduleSnapshot() const;
+	/// \brief Publish a new snapshot of the module set after a modification, to be called with m_moduleMutex locked
+	void publishSnapshot() const;
+	/// \brief Write the module index if modified, locks m_moduleIndexMutex
+	void storeModuleIndex();
+
+	/// \brief Module loaded but not registered yet, because it is not opened yet (LoadDeferred) or loaded after a module not opened yet
+	struct DeferredModule
+	{
+		std::string path;				///< path of the module file
+		int type;					///< ModuleEntryPoint::Type of the module or -1 if not known before opening it
+		const ModuleEntryPoint* entryPoint;		///< entry point of the module or NULL if not opened yet
+
+		DeferredModule( const std::string& path_, int type_, const ModuleEntryPoint* entryPoint_)
+			:path(path_),type(type_),entryPoint(entryPoint_){}
+		DeferredModule( const DeferredModule& o)
+			:path(o.path),type(o.type),entryPoint(o.entryPoint){}
+	};
+
+	/// \brief Module loaded with the path resolved, for writing the preload manifest
+	struct LoadedModule
+	{
+		std::string name;				///< name of the module as passed to the loader
+		std::string path;				///< path of the module file
+		const ModuleEntryPoint* entryPoint;		///< entry point of the module or NULL if not opened yet
+		bool bindLazy;					///< true if the module has been opened with symbols not resolved yet (LoadLazy)
+		ModuleFileStat stat;				///< identity of the module file opened, only recorded with module reload enabled
+		ModuleFileStat failedStat;			///< identity of the last module file that failed to reload
+
+		LoadedModule( const std::string& name_, const std::string& path_, const ModuleEntryPoint* entryPoint_, bool bindLazy_)
+			:name(name_),path(path_),entryPoint(entryPoint_),bindLazy(bindLazy_),stat(),failedStat(){}
+		LoadedModule( const LoadedModule& o)
+			:name(o.name),path(o.path),entryPoint(o.entryPoint),bindLazy(o.bindLazy),stat(o.stat),failedStat(o.failedStat){}
+	};
+
+	void watchLoadedModule( LoadedModule& module) const;
+	bool reloadModule( const LoadedModule& module, const ModuleFileStat& stat);
+	void replaceModule( const ModuleEntryPoint* oldEntryPoint, const ModuleEntryPoint* newEntryPoint);
+	void markModuleReloadFailed( const ModuleEntryPoint* entryPoint, const ModuleFileStat& stat);
+
+private:
+	// ... concurrency model: the members describing the module set are modified under m_moduleMutex only (writers).
+	//	Every modification publishes an immutable snapshot of the module set (m_snapshot). Object builders are created
+	//	from the snapshot current without holding m_moduleMutex (readers), so loading modules does not block them.
+	std::vector<std::string> m_modulePaths;			///< module search paths, guarded by m_moduleMutex
 	std::vector<std::string> m_modules;
-	std::vector<const AnalyzerModule*> m_analyzerModules;
-	std::vector<const StorageModule*> m_storageModules;
-	std::vector<const TraceModule*> m_traceModules;
-	std::vector<std::string> m_version_3rdparty_ar;
-	std::vector<std::string> m_license_3rdparty_ar;
-	std::vector<ModuleEntryPoint::Handle> m_handleList;
+	// ... the following members are modified by opening deferred modules in the const methods creating the object builders, guarded by m_moduleMutex:
+	mutable std::vector<const AnalyzerModule*> m_analyzerModules;
+	mutable std::vector<const StorageModule*> m_storageModules;
+	/// \brief Trace logger registered by name
+	struct TraceLoggerDef
+	{
+		TraceLoggerConstructor::CreateTraceLogger create;	///< constructor of the logger or NULL for a wrapper
+		WrapTraceLogger wrap;					///< constructor of a built-in logger forwarding to the logger named with 'inner' in the configuration or NULL
+		bool builtin;						///< true if the logger is built-in and can be replaced by a module
+
+		TraceLoggerDef()
+			:create(0),wrap(0),builtin(false){}
+		TraceLoggerDef( TraceLoggerConstructor::CreateTraceLogger create_, bool builtin_)
+			:create(create_),wrap(0),builtin(builtin_){}
+		explicit TraceLoggerDef( WrapTraceLogger wrap_)
+			:create(0),wrap(wrap_),builtin(true){}
+		TraceLoggerDef( const TraceLoggerDef& o)
+			:create(o.create),wrap(o.wrap),builtin(o.builtin){}
+	};
+	mutable CaseInsensitiveHashMap<TraceLoggerDef> m_traceLoggerMap;	///< built-in trace loggers and trace loggers of modules registered
+	mutable std::vector<std::string> m_version_3rdparty_ar;
+	mutable std::vector<std::string> m_license_3rdparty_ar;
+	mutable std::map<const ModuleEntryPoint*,ModuleHandleReference> m_moduleHandleMap;	///< handles of the modules opened by entry point, every entry point of a table included
+	mutable std::map<const ModuleEntryPoint*,const ModuleEntryPoint* const*> m_entryPointTables;	///< tables of entry points of the modules with more than one, by the first entry point representing the module
+	mutable std::vector<DeferredModule> m_deferredModules;
+	mutable std::vector<LoadedModule> m_loadedModules;
+	mutable unsigned int m_moduleGeneration;		///< incremented with every change of the registered modules, for invalidating cached builders
+	mutable std::vector<ModuleLoadMetrics> m_loadMetrics;	///< metrics of the modules loaded or tried to load
+	mutable ConstructorMetricsCollector m_constructorMetrics;	///< metrics of the objects created by the object builders
+	mutable strus::mutex m_moduleMutex;
+	mutable ModuleSnapshotReference m_snapshot;		///< snapshot of the module set published last
+	mutable strus::mutex m_snapshotMutex;			///< guards the reference m_snapshot only, held for copying it
 	ErrorBufferInterface* m_errorhnd;
 	DebugTraceContextInterface* m_debugtrace;
 	FileLocatorInterface* m_filelocator;
+	ModuleIndex* m_moduleIndex;
+	mutable strus::mutex m_moduleIndexMutex;
+	ModuleDiscovery* m_moduleDiscovery;			///< table of module files in the module directories if discovery is enabled or NULL
+	mutable strus::mutex m_moduleDiscoveryMutex;
+	// ... module reload, the watcher is guarded by m_moduleMutex, reloads are serialized with m_reloadMutex:
+	ModuleWatcher* m_moduleWatcher;				///< watcher of the module directories if module reload is enabled or NULL
+	std::string m_reloadCopyDirectory;			///< directory where the module files reloaded are copied to for opening them
+	unsigned int m_reloadCounter;				///< counter for making the names of the copies unique
+	strus::mutex m_reloadMutex;
+	LoadMode m_loadMode;
+	bool m_prepared;					///< true if prepare has been called
+	bool m_moduleUnloading;					///< true if modules opened are unloaded when not referenced anymore
+	// ... object builders cached if enabled with defineBuilderCaching, guarded by m_builderCacheMutex:
+	bool m_builderCaching;
+	mutable Reference<StorageObjectBuilderInterface> m_storageObjectBuilder;
+	mutable unsigned int m_storageObjectBuilderGeneration;
+	mutable Reference<AnalyzerObjectBuilderInterface> m_analyzerObjectBuilder;
+	mutable unsigned int m_analyzerObjectBuilderGeneration;
+	mutable strus::mutex m_builderCacheMutex;
 };
 
 }//namespace
@@ -0,0 +1,65 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Immutable snapshot of the set of modules registered in a module loader
+/// \file moduleSnapshot.hpp
+#ifndef _STRUS_MODULE_SNAPSHOT_HPP_INCLUDED
+#define _STRUS_MODULE_SNAPSHOT_HPP_INCLUDED
+#include "strus/moduleEntryPoint.hpp"
+#include "strus/reference.hpp"
+#include "moduleHandle.hpp"
+#include <string>
+#include <vector>
+
+namespace strus
+{
+/// \brief Forward declaration
+struct AnalyzerModule;
+/// \brief Forward declaration
+struct StorageModule;
+
+/// \brief Set of modules registered in a module loader at one point in time
+/// \note A snapshot is never modified after it has been published by the loader. Every change of the module set publishes a new snapshot,
+///		a snapshot replaced is deleted when the last object builder creation using it has finished (read-copy-update)
+struct ModuleSnapshot
+{
+	std::vector<std::string> modules;				///< names of the modules loaded without path and file extension
+	std::vector<const AnalyzerModule*> analyzerModules;		///< analyzer modules registered
+	std::vector<ModuleHandleReference> analyzerModuleHandles;	///< handles of the analyzer modules registered, parallel to analyzerModules, NULL if not tracked
+	std::vector<const StorageModule*> storageModules;		///< storage modules registered
+	std::vector<ModuleHandleReference> storageModuleHandles;	///< handles of the storage modules registered, parallel to storageModules, NULL if not tracked
+	unsigned int generation;					///< module generation of the loader when the snapshot was created
+	unsigned int deferredTypes;					///< set of deferred module types (bit 1<<type, bit 1<<NofTypes for type unknown yet)
+
+	enum {NofTypes=3};
+
+	ModuleSnapshot()
+		:modules(),analyzerModules(),analyzerModuleHandles(),storageModules(),storageModuleHandles(),generation(0),deferredTypes(0){}
+	ModuleSnapshot( const ModuleSnapshot& o)
+		:modules(o.modules),analyzerModules(o.analyzerModules),analyzerModuleHandles(o.analyzerModuleHandles)
+		,storageModules(o.storageModules),storageModuleHandles(o.storageModuleHandles),generation(o.generation),deferredTypes(o.deferredTypes){}
+
+	/// \brief Mark a module type as deferred
+	/// \param[in] type ModuleEntryPoint::Type of the module or -1 if not known yet
+	void addDeferred( int type)
+	{
+		deferredTypes |= (1U << (type < 0 ? (int)NofTypes : type));
+	}
+
+	/// \brief Test if there are deferred modules that have to be opened or registered for creating an object builder of a type
+	/// \param[in] type ModuleEntryPoint::Type of the object builder or -1 for any type
+	bool hasDeferred( int type) const
+	{
+		return type < 0 ? deferredTypes != 0 : 0 != (deferredTypes & ((1U << type) | (1U << NofTypes)));
+	}
+};
+
+typedef Reference<ModuleSnapshot> ModuleSnapshotReference;
+
+}//namespace
+#endif
+
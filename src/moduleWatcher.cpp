@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Watcher of the module directories for changes of module files, for reloading modules without restarting the process
+/// \file moduleWatcher.cpp
+#include "moduleWatcher.hpp"
+#include "moduleIndex.hpp"
+#include <string>
+#include <cstring>
+#include <cerrno>
+
+#if defined(__linux__)
+#include <sys/inotify.h>
+#include <unistd.h>
+#define STRUS_MODULE_WATCHER_INOTIFY
+#endif
+
+using namespace strus;
+
+ModuleWatcher::ModuleWatcher()
+	:m_fd(-1),m_dirs()
+{
+#ifdef STRUS_MODULE_WATCHER_INOTIFY
+	m_fd = ::inotify_init1( IN_NONBLOCK | IN_CLOEXEC);
+#endif
+}
+
+ModuleWatcher::~ModuleWatcher()
+{
+#ifdef STRUS_MODULE_WATCHER_INOTIFY
+	if (m_fd >= 0) ::close( m_fd);
+#endif
+}
+
+int ModuleWatcher::watch( const std::string& dirpath)
+{
+	if (m_dirs.find( dirpath) != m_dirs.end()) return 0;
+#ifdef STRUS_MODULE_WATCHER_INOTIFY
+	if (m_fd < 0) return ENOSYS;
+	// ... deployments either write the module file in place or move a new file over it:
+	if (0 > ::inotify_add_watch( m_fd, dirpath.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ATTRIB))
+	{
+		int ec = errno;
+		// ... without a watch on every directory we cannot rely on the notifications anymore
+		::close( m_fd);
+		m_fd = -1;
+		return ec;
+	}
+	m_dirs.insert( dirpath);
+	return 0;
+#else
+	return ENOSYS;
+#endif
+}
+
+bool ModuleWatcher::changed()
+{
+#ifdef STRUS_MODULE_WATCHER_INOTIFY
+	if (m_fd < 0) return true;
+	bool rt = false;
+	char buf[ 4096] __attribute__ ((aligned(__alignof__(struct inotify_event))));
+	for (;;)
+	{
+		ssize_t len = ::read( m_fd, buf, sizeof(buf));
+		if (len < 0)
+		{
+			if (errno == EINTR) continue;
+			// ... EAGAIN: no more notifications
+			break;
+		}
+		if (len == 0) break;
+		char const* ptr = buf;
+		for (; ptr < buf + len; ptr += sizeof(struct inotify_event) + ((const struct inotify_event*)ptr)->len)
+		{
+			const struct inotify_event* event = (const struct inotify_event*)ptr;
+			if (event->mask & IN_Q_OVERFLOW)
+			{
+				rt = true;
+			}
+			else if (event->len && isModuleFileName( event->name))
+			{
+				rt = true;
+			}
+		}
+	}
+	return rt;
+#else
+	return true;
+#endif
+}
+
@@ -0,0 +1,52 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Watcher of the module directories for changes of module files, for reloading modules without restarting the process
+/// \file moduleWatcher.hpp
+#ifndef _STRUS_MODULE_WATCHER_HPP_INCLUDED
+#define _STRUS_MODULE_WATCHER_HPP_INCLUDED
+#include <string>
+#include <set>
+
+namespace strus
+{
+
+/// \brief Watcher of directories for module files created, written or moved into them
+/// \note Uses inotify if available. Without inotify every call of changed returns true, so that the caller has to check the files itself.
+class ModuleWatcher
+{
+public:
+	ModuleWatcher();
+	~ModuleWatcher();
+
+	/// \brief Start watching a directory, does nothing if the directory is already watched
+	/// \param[in] dirpath path of the directory
+	/// \return 0 on success, errno on failure (the watcher falls back to report every call of changed as change then)
+	int watch( const std::string& dirpath);
+
+	/// \brief Consume the notifications received since the last call without blocking
+	/// \return true if a module file may have changed since the last call
+	bool changed();
+
+	/// \brief Evaluate if the notifications of file changes are available
+	bool notifying() const
+	{
+		return m_fd >= 0;
+	}
+
+private:
+	ModuleWatcher( const ModuleWatcher&){}		//< non copyable
+	void operator=( const ModuleWatcher&){}	//< non copyable
+
+private:
+	int m_fd;				///< inotify file descriptor or -1 if not available
+	std::set<std::string> m_dirs;		///< directories watched
+};
+
+}//namespace
+#endif
+
@@ -0,0 +1,31 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Monotonic clock for measuring durations, inline for being usable by the module libraries that do not link the loader
+/// \file monotonicTime.hpp
+#ifndef _STRUS_MODULE_MONOTONIC_TIME_HPP_INCLUDED
+#define _STRUS_MODULE_MONOTONIC_TIME_HPP_INCLUDED
+#include <ctime>
+
+#if defined(_WIN32)
+#error Monotonic time not ported to Windows, only implementation for POSIX available
+#endif
+
+namespace strus
+{
+
+/// \brief Get a monotonic time stamp in seconds for measuring durations
+inline double getMonotonicTime()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+}//namespace
+#endif
+
@@ -0,0 +1,157 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Manifest of the modules loaded, written after a successful load and read back to load the same modules without searching them
+/// \file preloadManifest.cpp
+#include "preloadManifest.hpp"
+#include "strus/base/fileio.hpp"
+#include <string>
+#include <cstring>
+#include <cstdlib>
+#include <cstdio>
+#include <cerrno>
+
+using namespace strus;
+
+#define PRELOAD_MANIFEST_HEADER "# strus module preload manifest 2"
+
+/// \brief Append a field of a manifest line, with the tabs, newlines and backslashes escaped, because the fields are separated by tabs
+static void appendField( std::string& res, const std::string& field)
+{
+	std::string::const_iterator fi = field.begin(), fe = field.end();
+	for (; fi != fe; ++fi)
+	{
+		switch (*fi)
+		{
+			case '\t': res.append( "\\t"); break;
+			case '\n': res.append( "\\n"); break;
+			case '\r': res.append( "\\r"); break;
+			case '\\': res.append( "\\\\"); break;
+			default: res.push_back( *fi);
+		}
+	}
+}
+
+/// \brief Revert the escaping of appendField
+/// \return false if the field contains an invalid escape sequence
+static bool unescapeField( std::string& field)
+{
+	if (field.find( '\\') == std::string::npos) return true;
+	std::string res;
+	std::string::const_iterator fi = field.begin(), fe = field.end();
+	for (; fi != fe; ++fi)
+	{
+		if (*fi != '\\')
+		{
+			res.push_back( *fi);
+			continue;
+		}
+		if (++fi == fe) return false;
+		switch (*fi)
+		{
+			case 't': res.push_back( '\t'); break;
+			case 'n': res.push_back( '\n'); break;
+			case 'r': res.push_back( '\r'); break;
+			case '\\': res.push_back( '\\'); break;
+			default: return false;
+		}
+	}
+	field.swap( res);
+	return true;
+}
+
+static bool unescapeFields( std::vector<std::string>& col)
+{
+	std::vector<std::string>::iterator ci = col.begin(), ce = col.end();
+	for (; ci != ce; ++ci)
+	{
+		if (!unescapeField( *ci)) return false;
+	}
+	return true;
+}
+
+int PreloadManifest::add( const std::string& name, const std::string& path, const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table)
+{
+	Entry entry;
+	int ec = getModuleFileStat( path, entry.stat);
+	if (ec) return ec;
+	entry.name = name;
+	entry.path = path;
+	entry.type = (int)entryPoint->type;
+	for (const ModuleEntryPoint* const* ti = table; ti && *ti; ++ti)
+	{
+		if ((int)(*ti)->type != entry.type) entry.type = -1;
+	}
+	entry.signature = entryPoint->signature;
+	entry.modversion_minor = entryPoint->modversion_minor;
+	entry.compversion_major = entryPoint->compversion_major;
+	entry.compversion_minor = entryPoint->compversion_minor;
+	m_entries.push_back( entry);
+	return 0;
+}
+
+int PreloadManifest::load( const std::string& filename)
+{
+	std::string content;
+	m_entries.clear();
+	int ec = strus::readFile( filename, content);
+	if (ec) return ec;
+
+	std::vector<Entry> entries;
+	std::vector<std::string> col;
+	std::string::size_type start = 0, end = content.find( '\n');
+	if (end == std::string::npos || content.compare( 0, end, PRELOAD_MANIFEST_HEADER) != 0)
+	{
+		return EINVAL;
+	}
+	for (start = end+1, end = content.find( '\n', start); end != std::string::npos; start = end+1, end = content.find( '\n', start))
+	{
+		splitModuleFileLine( col, std::string( content, start, end-start));
+		if (!unescapeFields( col)) return EINVAL;
+		if (col.size() == 11 && col[0] == "M")
+		{
+			entries.push_back( Entry());
+			Entry& entry = entries.back();
+			entry.name = col[1];
+			entry.path = col[2];
+			if (!parseModuleFileStat( entry.stat, col[3], col[4], col[5])) return EINVAL;
+			entry.type = moduleTypeFromName( col[6]);
+			if (entry.type < 0 && col[6] != "-") return EINVAL;
+			entry.signature = col[7];
+			entry.modversion_minor = (unsigned short)std::atoi( col[8].c_str());
+			entry.compversion_major = (unsigned short)std::atoi( col[9].c_str());
+			entry.compversion_minor = (unsigned short)std::atoi( col[10].c_str());
+		}
+		else
+		{
+			return EINVAL;
+		}
+	}
+	m_entries.swap( entries);
+	return 0;
+}
+
+int PreloadManifest::store( const std::string& filename) const
+{
+	std::string content( PRELOAD_MANIFEST_HEADER "\n");
+	char buf[ 256];
+	std::vector<Entry>::const_iterator ei = m_entries.begin(), ee = m_entries.end();
+	for (; ei != ee; ++ei)
+	{
+		std::snprintf( buf, sizeof(buf), "\t%lld\t%llu\t%llu\t%s\t%s\t%u\t%u\t%u\n",
+				ei->stat.mtime, ei->stat.inode, ei->stat.size,
+				moduleTypeName( ei->type), ei->signature.c_str(),
+				(unsigned int)ei->modversion_minor, (unsigned int)ei->compversion_major, (unsigned int)ei->compversion_minor);
+		content.append( "M\t");
+		appendField( content, ei->name);
+		content.append( "\t");
+		appendField( content, ei->path);
+		content.append( buf);
+	}
+	return writeModuleFileAtomic( filename, content);
+}
+
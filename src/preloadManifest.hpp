@@ -0,0 +1,78 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Manifest of the modules loaded, written after a successful load and read back to load the same modules without searching them
+/// \file preloadManifest.hpp
+#ifndef _STRUS_MODULE_PRELOAD_MANIFEST_HPP_INCLUDED
+#define _STRUS_MODULE_PRELOAD_MANIFEST_HPP_INCLUDED
+#include "strus/moduleEntryPoint.hpp"
+#include "moduleIndex.hpp"
+#include <string>
+#include <vector>
+
+namespace strus
+{
+
+/// \brief Manifest of the modules loaded with their resolved paths, file identity and entry point meta data
+/// \note The manifest is a text file with one tab separated line per module, tabs, newlines and backslashes in the fields are escaped with a backslash
+class PreloadManifest
+{
+public:
+	/// \brief Description of a module loaded
+	struct Entry
+	{
+		std::string name;			///< name of the module as passed to the loader
+		std::string path;			///< resolved path of the module file
+		ModuleFileStat stat;			///< identity of the module file when the manifest was written
+		int type;				///< ModuleEntryPoint::Type of the module or -1 if it has entry points of different types
+		std::string signature;			///< signature of the entry point
+		unsigned short modversion_minor;	///< minor version of the module
+		unsigned short compversion_major;	///< major version of components in the module
+		unsigned short compversion_minor;	///< minor version of components in the module
+
+		Entry()
+			:name(),path(),stat(),type(-1),signature(),modversion_minor(0),compversion_major(0),compversion_minor(0){}
+		Entry( const Entry& o)
+			:name(o.name),path(o.path),stat(o.stat),type(o.type),signature(o.signature)
+			,modversion_minor(o.modversion_minor),compversion_major(o.compversion_major),compversion_minor(o.compversion_minor){}
+	};
+
+	PreloadManifest()
+		:m_entries(){}
+
+	/// \brief Add a module loaded
+	/// \param[in] name name of the module as passed to the loader
+	/// \param[in] path resolved path of the module file
+	/// \param[in] entryPoint entry point of the module
+	/// \param[in] table NULL terminated table of all entry points of the module if it has more than one, else NULL
+	/// \return 0 on success, errno if the module file cannot be inspected
+	/// \note The type of a module with entry points of different types is recorded as unknown (-1)
+	int add( const std::string& name, const std::string& path, const ModuleEntryPoint* entryPoint, const ModuleEntryPoint* const* table);
+
+	/// \brief Read the manifest from a file
+	/// \param[in] filename path of the file
+	/// \return 0 on success, errno on failure (the manifest is empty then)
+	int load( const std::string& filename);
+
+	/// \brief Write the manifest to a file
+	/// \param[in] filename path of the file
+	/// \return 0 on success, errno on failure
+	int store( const std::string& filename) const;
+
+	/// \brief Get the modules of the manifest in the order they were loaded
+	const std::vector<Entry>& entries() const
+	{
+		return m_entries;
+	}
+
+private:
+	std::vector<Entry> m_entries;		///< modules in order of loading
+};
+
+}//namespace
+#endif
+
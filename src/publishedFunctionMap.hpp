@@ -0,0 +1,181 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Map of the functions looked up in a lazy processor, read without lock
+/// \file publishedFunctionMap.hpp
+#ifndef _STRUS_MODULE_PUBLISHED_FUNCTION_MAP_HPP_INCLUDED
+#define _STRUS_MODULE_PUBLISHED_FUNCTION_MAP_HPP_INCLUDED
+#include "strus/base/atomic.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+namespace module
+{
+
+/// \brief Map of function names (lower case) to the functions found, read without lock and modified with the lock of the owner held
+/// \note The map is an insert-only hash table of entries with an atomic slot for the function. An entry is never removed,
+///		erasing a name clears the function of its entry and a later insert of the name sets it again.
+///		The slot arrays replaced by a bigger one when the table grows are kept until the destruction of the map, because readers might still use them.
+///		Their size doubles with every growth, so all slot arrays together use at most twice the slots of the current one.
+template <class Interface>
+class PublishedFunctionMap
+{
+public:
+	PublishedFunctionMap()
+		:m_current(0),m_tables(),m_entries(){}
+	~PublishedFunctionMap()
+	{
+		typename std::vector<Table*>::iterator ti = m_tables.begin(), te = m_tables.end();
+		for (; ti != te; ++ti) delete *ti;
+		typename std::vector<Entry*>::iterator ei = m_entries.begin(), ee = m_entries.end();
+		for (; ei != ee; ++ei) delete *ei;
+	}
+
+	/// \brief Find a function, without lock
+	/// \param[in] key name of the function in lower case
+	/// \return the function or NULL if not published
+	const Interface* find( const std::string& key) const
+	{
+		const Table* table = m_current.load();
+		if (!table) return 0;
+		const Entry* entry = table->find( key, hash( key));
+		return entry ? entry->func.load() : 0;
+	}
+
+	/// \brief Publish a function found, called with the lock of the owner held
+	void insert( const std::string& key, const Interface* func)
+	{
+		std::size_t hashval = hash( key);
+		Table* table = m_current.load();
+		Entry* entry = table ? table->find( key, hashval) : 0;
+		if (entry)
+		{
+			entry->func.store( func);
+			return;
+		}
+		if (!table || (m_entries.size() + 1) * 2 > table->size)
+		{
+			table = grow( table);
+		}
+		m_entries.reserve( m_entries.size()+1);
+		entry = new Entry( key, func);
+		m_entries.push_back( entry);
+		// ... the entry is complete before it gets visible to readers through its slot
+		table->slot( hashval)->entry.store( entry);
+	}
+
+	/// \brief Remove a function replaced by a new definition, called with the lock of the owner held
+	void erase( const std::string& key)
+	{
+		Table* table = m_current.load();
+		Entry* entry = table ? table->find( key, hash( key)) : 0;
+		if (entry) entry->func.store( 0);
+	}
+
+private:
+	/// \brief Entry of the table, immutable except for the function
+	struct Entry
+	{
+		const std::string key;				///< name of the function in lower case
+		strus::atomic<const Interface*> func;		///< function published or NULL if erased
+
+		Entry( const std::string& key_, const Interface* func_)
+			:key(key_),func(func_){}
+	private:
+		Entry( const Entry&) :key(),func(0){}		//< non copyable
+		void operator=( const Entry&){}			//< non copyable
+	};
+
+	/// \brief Slot of the table, set once
+	struct Slot
+	{
+		strus::atomic<Entry*> entry;			///< entry in the slot or NULL if free
+
+		Slot()
+			:entry(0){}
+	private:
+		Slot( const Slot&) :entry(0){}			//< non copyable
+		void operator=( const Slot&){}			//< non copyable
+	};
+
+	/// \brief Array of slots addressed by open addressing with linear probing, kept at most half full
+	struct Table
+	{
+		std::size_t size;				///< number of slots, a power of 2
+		Slot* slots;					///< slots
+
+		explicit Table( std::size_t size_)
+			:size(size_),slots(new Slot[ size_]){}
+		~Table()
+		{
+			delete [] slots;
+		}
+
+		/// \brief Find the entry of a name
+		Entry* find( const std::string& key, std::size_t hashval) const
+		{
+			std::size_t idx = hashval & (size-1);
+			for (;;idx = (idx+1) & (size-1))
+			{
+				Entry* entry = slots[ idx].entry.load();
+				if (!entry) return 0;
+				if (entry->key == key) return entry;
+			}
+		}
+		/// \brief Get the first free slot for a name not in the table
+		Slot* slot( std::size_t hashval) const
+		{
+			std::size_t idx = hashval & (size-1);
+			while (slots[ idx].entry.load()) idx = (idx+1) & (size-1);
+			return &slots[ idx];
+		}
+	private:
+		Table( const Table&){}				//< non copyable
+		void operator=( const Table&){}			//< non copyable
+	};
+
+	static std::size_t hash( const std::string& key)
+	{
+		// ... FNV-1a
+		std::size_t rt = 2166136261U;
+		std::string::const_iterator ki = key.begin(), ke = key.end();
+		for (; ki != ke; ++ki) rt = (rt ^ (unsigned char)*ki) * 16777619U;
+		return rt;
+	}
+
+	/// \brief Publish a table of double size with the entries of the current one
+	Table* grow( const Table* table)
+	{
+		enum {MinTableSize=16};
+		m_tables.reserve( m_tables.size()+1);
+		Table* rt = new Table( table ? table->size * 2 : (std::size_t)MinTableSize);
+		m_tables.push_back( rt);
+		typename std::vector<Entry*>::const_iterator ei = m_entries.begin(), ee = m_entries.end();
+		for (; ei != ee; ++ei)
+		{
+			rt->slot( hash( (*ei)->key))->entry.store( *ei);
+		}
+		m_current.store( rt);
+		return rt;
+	}
+
+private:
+	PublishedFunctionMap( const PublishedFunctionMap&){}	//< non copyable
+	void operator=( const PublishedFunctionMap&){}		//< non copyable
+
+private:
+	strus::atomic<Table*> m_current;			///< table published last or NULL
+	std::vector<Table*> m_tables;				///< all tables published, owned
+	std::vector<Entry*> m_entries;				///< all entries, owned
+};
+
+}}//namespace
+#endif
+
@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger writing the calls into a memory mapped file used as ring buffer, keeping the most recent calls also in case of a crash
+/// \file ringTraceLogger.cpp
+#include "ringTraceLogger.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/configParser.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+#include <cstring>
+#include <cerrno>
+
+#if defined(_WIN32)
+#error Ring trace logger not ported to Windows, only implementation for POSIX available
+#else
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+using namespace strus;
+using namespace strus::binarytrace;
+
+#define DefaultRingSize (1<<24)
+
+static strus::AtomicCounter<unsigned int> g_loggerCounter( 0);
+
+RingTraceLogger::RingTraceLogger( const std::string& path_, unsigned int ringSize_, ErrorBufferInterface* errorhnd_)
+	:m_id(g_loggerCounter.allocIncrement() + 1),m_mutex(),m_path(path_),m_fd(-1),m_map(0),m_mapSize(0),m_header(0),m_nameArea(0),m_ring(0)
+	,m_blockOwned(0),m_nameMap(),m_threadStates(),m_handleCounter(0),m_namesFull(),m_errorhnd(errorhnd_)
+{
+	unsigned int nofBlocks = (ringSize_ + BlockSize - 1) / BlockSize;
+	if (nofBlocks < MinNofBlocks) nofBlocks = MinNofBlocks;
+	m_mapSize = RingHeaderSize + NameAreaSize + (std::size_t)nofBlocks * BlockSize;
+	m_blockOwned = new strus::AtomicCounter<unsigned int>[ nofBlocks];
+
+	m_fd = ::open( m_path.c_str(), O_RDWR|O_CREAT|O_TRUNC, 0644);
+	if (m_fd < 0)
+	{
+		int ec = errno;
+		delete [] m_blockOwned;
+		throw strus::runtime_error(_TXT("failed to create ring trace file '%s': %s"), m_path.c_str(), ::strerror( ec));
+	}
+	// ... the file is extended with zeros, so that the blocks not written yet are empty with a block sequence number 0
+	if (0 != ::ftruncate( m_fd, m_mapSize))
+	{
+		int ec = errno;
+		::close( m_fd);
+		delete [] m_blockOwned;
+		throw strus::runtime_error(_TXT("failed to resize ring trace file '%s': %s"), m_path.c_str(), ::strerror( ec));
+	}
+	void* map = ::mmap( 0, m_mapSize, PROT_READ|PROT_WRITE, MAP_SHARED, m_fd, 0);
+	if (map == MAP_FAILED)
+	{
+		int ec = errno;
+		::close( m_fd);
+		delete [] m_blockOwned;
+		throw strus::runtime_error(_TXT("failed to map ring trace file '%s' into memory: %s"), m_path.c_str(), ::strerror( ec));
+	}
+	m_map = (char*)map;
+	m_header = (RingHeader*)m_map;
+	m_nameArea = m_map + RingHeaderSize;
+	m_ring = m_nameArea + NameAreaSize;
+
+	std::memcpy( m_header->magic, STRUS_RING_TRACE_MAGIC, sizeof(m_header->magic));
+	m_header->version = STRUS_BINARY_TRACE_VERSION;
+	m_header->blockSize = BlockSize;
+	m_header->nofBlocks = nofBlocks;
+	m_header->nameAreaSize = NameAreaSize;
+	m_header->nameAreaUsed = 0;
+	m_header->nofBlocksStarted = 0;
+	m_header->nofDropped = 0;
+}
+
+RingTraceLogger::~RingTraceLogger()
+{
+	(void)unmap();
+	std::map<unsigned int,ThreadState*>::iterator ti = m_threadStates.begin(), te = m_threadStates.end();
+	for (; ti != te; ++ti)
+	{
+		delete ti->second;
+	}
+	delete [] m_blockOwned;
+}
+
+bool RingTraceLogger::unmap()
+{
+	if (!m_map) return true;
+	bool rt = true;
+	if (0 != ::msync( m_map, m_mapSize, MS_SYNC)) rt = false;
+	if (0 != ::munmap( m_map, m_mapSize)) rt = false;
+	if (0 != ::close( m_fd)) rt = false;
+	m_map = 0;
+	m_fd = -1;
+	m_header = 0;
+	m_nameArea = 0;
+	m_ring = 0;
+	return rt;
+}
+
+/// \brief Record of a thread shared by the thread and the states of the ring loggers it used, telling if the thread has exited
+struct strus::RingThreadLife
+{
+	strus::AtomicCounter<int> refs;			///< number of references, one of the thread as long as it runs and one of every thread state
+	strus::AtomicFlag exited;			///< set when the thread exits
+
+	RingThreadLife()
+		:refs(1),exited(){}
+};
+
+static void releaseThreadLife( RingThreadLife* life)
+{
+	if (life->refs.allocDecrement() == 1) delete life;
+}
+
+// ... the thread local record is released by the destructor of a thread specific key on exit of the thread,
+//	it is never released for the main thread, as no destructors of thread specific keys are called on exit of the process:
+static __thread RingThreadLife* g_threadLife = 0;
+static pthread_key_t g_threadLifeKey;
+static pthread_once_t g_threadLifeKeyOnce = PTHREAD_ONCE_INIT;
+static int g_threadLifeKeyError = 0;
+
+static void exitThreadLife( void* ptr)
+{
+	RingThreadLife* life = (RingThreadLife*)ptr;
+	life->exited.set( true);
+	releaseThreadLife( life);
+}
+
+static void createThreadLifeKey()
+{
+	g_threadLifeKeyError = ::pthread_key_create( &g_threadLifeKey, &exitThreadLife);
+}
+
+static RingThreadLife* threadLife()
+{
+	if (!g_threadLife)
+	{
+		if (0 != ::pthread_once( &g_threadLifeKeyOnce, &createThreadLifeKey) || g_threadLifeKeyError)
+		{
+			throw std::runtime_error( _TXT("failed to create thread specific key of ring trace logger"));
+		}
+		strus::local_ptr<RingThreadLife> life( new RingThreadLife());
+		if (0 != ::pthread_setspecific( g_threadLifeKey, life.get()))
+		{
+			throw std::runtime_error( _TXT("failed to register thread in ring trace logger"));
+		}
+		g_threadLife = life.release();
+	}
+	return g_threadLife;
+}
+
+RingTraceLogger::ThreadState::ThreadState( BinaryTraceNameTable* nameTable, unsigned int threadIndex_, RingThreadLife* life_)
+	:encoder(nameTable),record(),definitions(),block(0),blockIndex(0),threadIndex(threadIndex_),life(life_)
+{
+	life->refs.increment();
+}
+
+RingTraceLogger::ThreadState::~ThreadState()
+{
+	releaseThreadLife( life);
+}
+
+/// \brief Entry of the cache of the thread states of the ring loggers used by a thread
+struct RingThreadCacheSlot
+{
+	unsigned int loggerId;				///< id of the logger or 0 if the slot is free
+	RingTraceLogger::ThreadState* state;		///< state of the thread owned by the logger
+};
+
+// ... the cache is POD for being thread local without C++11, slots of loggers deleted are never matched again because the logger ids are unique:
+#define ThreadCacheSize 4
+static __thread RingThreadCacheSlot g_threadCache[ ThreadCacheSize];
+static __thread unsigned int g_threadCacheNext = 0;
+// ... index of the calling thread, assigned on its first call, as key of the thread states of a logger
+static __thread unsigned int g_threadIndex = 0;
+static strus::AtomicCounter<unsigned int> g_threadCounter( 0);
+
+RingTraceLogger::ThreadState* RingTraceLogger::threadState()
+{
+	for (int si=0; si < ThreadCacheSize; ++si)
+	{
+		if (g_threadCache[ si].loggerId == m_id) return g_threadCache[ si].state;
+	}
+	if (!g_threadIndex) g_threadIndex = g_threadCounter.allocIncrement() + 1;
+	ThreadState* rt;
+	{
+		strus::scoped_lock lock( m_mutex);
+		std::map<unsigned int,ThreadState*>::const_iterator ti = m_threadStates.find( g_threadIndex);
+		if (ti == m_threadStates.end())
+		{
+			rt = new ThreadState( this, g_threadIndex, threadLife());
+			try
+			{
+				m_threadStates[ g_threadIndex] = rt;
+			}
+			catch (...)
+			{
+				delete rt;
+				throw;
+			}
+		}
+		else
+		{
+			rt = ti->second;
+		}
+	}
+	RingThreadCacheSlot& slot = g_threadCache[ g_threadCacheNext++ % ThreadCacheSize];
+	slot.loggerId = m_id;
+	slot.state = rt;
+	return rt;
+}
+
+unsigned int RingTraceLogger::nameId( const char* name, std::size_t namesize)
+{
+	strus::scoped_lock lock( m_mutex);
+	std::string key( name, namesize);
+	std::map<std::string,unsigned int>::const_iterator ni = m_nameMap.find( key);
+	if (ni != m_nameMap.end()) return ni->second;
+
+	unsigned int rt = m_nameMap.size();
+	std::string definition;
+	packByte( definition, RecordName);
+	packVarint( definition, rt);
+	packString( definition, name, namesize);
+	std::string nameRecord;
+	packRecord( nameRecord, definition);
+	if (m_header->nameAreaUsed + nameRecord.size() > NameAreaSize)
+	{
+		// ... a record referring to names that are not defined cannot be decoded, so nothing is written anymore
+		m_namesFull.set( true);
+		return rt;
+	}
+	std::memcpy( m_nameArea + m_header->nameAreaUsed, nameRecord.c_str(), nameRecord.size());
+	// ... the contents have to be stored before the positions referring to them for the file being consistent at any time
+	__sync_synchronize();
+	m_header->nameAreaUsed += nameRecord.size();
+	m_nameMap[ key] = rt;
+	return rt;
+}
+
+void RingTraceLogger::dropRecord()
+{
+	__sync_fetch_and_add( &m_header->nofDropped, 1);
+}
+
+bool RingTraceLogger::claimBlock( ThreadState* state)
+{
+	if (state->block)
+	{
+		m_blockOwned[ state->blockIndex].set( 0);
+		state->block = 0;
+	}
+	// ... the blocks are claimed in the order of the ring, the ones still owned by other threads running are skipped
+	for (unsigned int ti=0; ti < m_header->nofBlocks; ++ti)
+	{
+		unsigned long long sequence = __sync_add_and_fetch( &m_header->nofBlocksStarted, 1);
+		unsigned int blockIndex = (unsigned int)((sequence - 1) % m_header->nofBlocks);
+		unsigned int owner = m_blockOwned[ blockIndex].value();
+		if (owner)
+		{
+			if (!takeOverBlock( blockIndex, owner, state)) continue;
+		}
+		else if (!m_blockOwned[ blockIndex].test_and_set( 0, state->threadIndex))
+		{
+			continue;
+		}
+
+		char* block = m_ring + (std::size_t)blockIndex * BlockSize;
+		RingBlockHeader* blockHeader = (RingBlockHeader*)block;
+		// ... the block is emptied before it gets its new sequence number, so that the records of its previous use are never decoded as the newest ones
+		blockHeader->fill = 0;
+		__sync_synchronize();
+		blockHeader->sequence = sequence;
+		state->block = block;
+		state->blockIndex = blockIndex;
+		return true;
+	}
+	return false;
+}
+
+bool RingTraceLogger::takeOverBlock( unsigned int blockIndex, unsigned int owner, ThreadState* state)
+{
+	strus::scoped_lock lock( m_mutex);
+	std::map<unsigned int,ThreadState*>::iterator ti = m_threadStates.find( owner);
+	if (ti == m_threadStates.end() || !ti->second->life->exited.test()) return false;
+	if (!m_blockOwned[ blockIndex].test_and_set( owner, state->threadIndex)) return false;
+	// ... the state of a thread exited is not referenced anymore, the thread local cache referring to it is gone with the thread
+	delete ti->second;
+	m_threadStates.erase( ti);
+	return true;
+}
+
+void RingTraceLogger::writeRecord( ThreadState* state)
+{
+	if (m_namesFull.test())
+	{
+		dropRecord();
+		return;
+	}
+	std::string sizePrefix;
+	packVarint( sizePrefix, state->record.size());
+	std::size_t recordSize = sizePrefix.size() + state->record.size();
+	if (recordSize > (std::size_t)(BlockSize - RingBlockHeaderSize))
+	{
+		dropRecord();
+		return;
+	}
+	if (!state->block || ((RingBlockHeader*)state->block)->fill + recordSize > (std::size_t)(BlockSize - RingBlockHeaderSize))
+	{
+		// ... records do not cross the end of a block, the fill of a block marks its end
+		if (!claimBlock( state))
+		{
+			dropRecord();
+			return;
+		}
+	}
+	RingBlockHeader* blockHeader = (RingBlockHeader*)state->block;
+	char* dest = state->block + RingBlockHeaderSize + blockHeader->fill;
+	std::memcpy( dest, sizePrefix.c_str(), sizePrefix.size());
+	std::memcpy( dest + sizePrefix.size(), state->record.c_str(), state->record.size());
+	// ... the contents have to be stored before the fill referring to them for the file being consistent at any time
+	__sync_synchronize();
+	blockHeader->fill += recordSize;
+}
+
+TraceLogRecordHandle RingTraceLogger::logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId)
+{
+	try
+	{
+		if (!m_map) return 0;
+		ThreadState* state = threadState();
+		TraceLogRecordHandle rt = m_handleCounter.allocIncrement() + 1;
+		state->encoder.packCall( state->record, state->definitions, rt, className, methodName, objId);
+		writeRecord( state);
+		return rt;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error logging method call in ring trace: %s"), *m_errorhnd, 0);
+}
+
+void RingTraceLogger::logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter)
+{
+	try
+	{
+		if (!m_map) return;
+		ThreadState* state = threadState();
+		state->encoder.packTermination( state->record, state->definitions, loghnd, parameter);
+		writeRecord( state);
+	}
+	CATCH_ERROR_MAP( _TXT("error logging method termination in ring trace: %s"), *m_errorhnd);
+}
+
+bool RingTraceLogger::close()
+{
+	try
+	{
+		strus::scoped_lock lock( m_mutex);
+		if (!unmap())
+		{
+			m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error writing ring trace file '%s': %s"), m_path.c_str(), ::strerror( errno ? errno : EIO));
+			return false;
+		}
+		return true;
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error closing ring trace logger: %s"), *m_errorhnd, false);
+}
+
+TraceLoggerInterface* strus::createTraceLogger_ring( const std::string& config_, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		std::string config( config_);
+		std::string path;
+		unsigned int ringSize = DefaultRingSize;
+		if (!extractStringFromConfigString( path, config, "file", errorhnd))
+		{
+			throw strus::runtime_error(_TXT("undefined '%s' in config of ring trace logger"), "file");
+		}
+		if (!extractUIntFromConfigString( ringSize, config, "size", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			ringSize = DefaultRingSize;
+		}
+		return new RingTraceLogger( path, ringSize, errorhnd);
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating ring trace logger: %s"), *errorhnd, 0);
+}
+
@@ -0,0 +1,128 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger writing the calls into a memory mapped file used as ring buffer, keeping the most recent calls also in case of a crash
+/// \file ringTraceLogger.hpp
+#ifndef _STRUS_MODULE_RING_TRACE_LOGGER_HPP_INCLUDED
+#define _STRUS_MODULE_RING_TRACE_LOGGER_HPP_INCLUDED
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include "binaryTraceLogger.hpp"
+#include "binaryTraceFormat.hpp"
+#include <string>
+#include <vector>
+#include <map>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+/// \brief Forward declaration
+struct RingThreadLife;
+
+/// \brief Trace logger writing the records of the binary trace format into a memory mapped file of fixed size described by binarytrace::RingHeader
+/// \note Logging a call costs the encoding and a copy into the mapped memory, there are no file writes and no locks. Every thread encodes its records with its own encoder
+///		into a block of the ring it owns, a new block is claimed with an atomic increment of the counter of the blocks started in the header.
+///		The mutex is only locked for the first call of a thread and for the first use of a name, that is defined in the name area once for all threads.
+///		The pages written are flushed to the file by the operating system, so the records written before a crash of the process can be decoded from the file with strusTraceConvert.
+///		The records older than the size of the ring are overwritten block by block, skipping the blocks owned by other threads.
+///		Records are dropped if all blocks are owned by other threads, so the ring should have more blocks than threads logging.
+///		The block of a thread that has exited is taken over by the next thread claiming it, together with the state of the thread exited.
+/// \remark close must not be called while other threads are still logging calls
+class RingTraceLogger
+	:public TraceLoggerInterface
+	,public BinaryTraceNameTable
+{
+public:
+	/// \brief Constructor
+	/// \param[in] path_ path of the file to create
+	/// \param[in] ringSize_ size of the ring in bytes, rounded up to a multiple of the block size
+	/// \param[in] errorhnd_ buffer for reporting errors
+	/// \remark Throws if the file cannot be created or mapped
+	RingTraceLogger( const std::string& path_, unsigned int ringSize_, ErrorBufferInterface* errorhnd_);
+	virtual ~RingTraceLogger();
+
+	virtual TraceLogRecordHandle logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId);
+	virtual void logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+	/// \brief Synchronize the file with the mapped memory and unmap it
+	virtual bool close();
+
+public/*BinaryTraceEncoder*/:
+	/// \brief Get the id of a name, writing its definition into the name area on its first use
+	virtual unsigned int nameId( const char* name, std::size_t namesize);
+
+public:
+	enum {
+		BlockSize=(1<<16),		///< size of a block of the ring including its header, records bigger than a block are dropped
+		MinNofBlocks=2,			///< minimum number of blocks of the ring
+		NameAreaSize=(1<<20)		///< size of the area with the name definitions, no records are written anymore after it is full
+	};
+
+	/// \brief Encoder and block of the ring of one thread
+	struct ThreadState
+	{
+		BinaryTraceEncoder encoder;	///< encoder of the thread, getting the ids of the names from the logger
+		std::string record;		///< record built
+		std::string definitions;	///< definitions of names, always empty because the names are defined by the logger
+		char* block;			///< block of the ring owned by the thread or NULL if none
+		unsigned int blockIndex;	///< index of the block owned
+		unsigned int threadIndex;	///< index of the thread, marking the block owned
+		RingThreadLife* life;		///< record telling if the thread has exited, shared with the thread
+
+		ThreadState( BinaryTraceNameTable* nameTable, unsigned int threadIndex_, RingThreadLife* life_);
+		~ThreadState();
+
+	private:
+		ThreadState( const ThreadState&){}	//< non copyable
+		void operator=( const ThreadState&){}	//< non copyable
+	};
+
+private:
+	/// \brief Get the state of the calling thread, created on its first call
+	ThreadState* threadState();
+	/// \brief Write the record built by a thread into its block, claiming a new block if the record does not fit
+	void writeRecord( ThreadState* state);
+	/// \brief Claim the next free block of the ring for a thread and release the one owned before
+	/// \return false if all blocks are owned by other threads
+	bool claimBlock( ThreadState* state);
+	/// \brief Take over a block owned by a thread that has exited and delete the state of that thread
+	/// \return false if the owner of the block has not exited or if another thread took the block over before
+	bool takeOverBlock( unsigned int blockIndex, unsigned int owner, ThreadState* state);
+	/// \brief Count a record dropped
+	void dropRecord();
+	/// \brief Unmap the file and close it
+	bool unmap();
+
+private:
+	RingTraceLogger( const RingTraceLogger&){}		//< non copyable
+	void operator=( const RingTraceLogger&){}		//< non copyable
+
+private:
+	unsigned int m_id;					///< unique id of this logger for the thread local cache of thread states
+	strus::mutex m_mutex;					///< mutex for creating thread states, defining names and closing
+	std::string m_path;					///< path of the file
+	int m_fd;						///< file descriptor of the file or -1 if closed
+	char* m_map;						///< memory mapped or NULL if closed
+	std::size_t m_mapSize;					///< size of the memory mapped
+	binarytrace::RingHeader* m_header;			///< header at the start of the memory mapped
+	char* m_nameArea;					///< area with the name definitions
+	char* m_ring;						///< ring of blocks with the calls and terminations
+	strus::AtomicCounter<unsigned int>* m_blockOwned;	///< index of the thread owning a block of the ring, 0 for the free ones
+	std::map<std::string,unsigned int> m_nameMap;		///< ids of the names defined in the name area, accessed with m_mutex locked
+	std::map<unsigned int,ThreadState*> m_threadStates;	///< thread states by thread index, accessed with m_mutex locked, the ones of threads exited are deleted when their block is taken over
+	strus::AtomicCounter<TraceLogRecordHandle> m_handleCounter;	///< counter for the handles returned by logMethodCall
+	strus::AtomicFlag m_namesFull;				///< set if the name area is full
+	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
+};
+
+/// \brief Create a memory mapped ring trace logger, configuration keys 'file' (path of the file to create) and 'size' (size of the ring in bytes, default 16M)
+TraceLoggerInterface* createTraceLogger_ring( const std::string& config, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
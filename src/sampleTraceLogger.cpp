@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger passing a sample of the top level calls with all calls nested in them to another trace logger
+/// \file sampleTraceLogger.cpp
+#include "sampleTraceLogger.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/configParser.hpp"
+#include "errorUtils.hpp"
+#include "internationalization.hpp"
+#include <stdexcept>
+
+using namespace strus;
+
+#define DefaultRate 0.01
+#define SampleAll 0xFFFFffffU
+
+SampleTraceLogger::SampleTraceLogger( TraceLoggerInterface* inner_, double rate_, ErrorBufferInterface* errorhnd_)
+	:m_inner(inner_),m_threshold(0),m_callCounter(0),m_errorhnd(errorhnd_)
+{
+	if (rate_ >= 1.0)
+	{
+		m_threshold = SampleAll;
+	}
+	else if (rate_ > 0.0)
+	{
+		m_threshold = (unsigned int)(rate_ * 4294967296.0);
+	}
+}
+
+SampleTraceLogger::~SampleTraceLogger()
+{
+	delete m_inner;
+}
+
+bool SampleTraceLogger::sample()
+{
+	if (m_threshold == SampleAll) return true;
+	// ... multiplicative hash of the number of the call, spreading consecutive numbers uniformly over the range of values
+	unsigned int hash = m_callCounter.allocIncrement() * 2654435761U;
+	return hash < m_threshold;
+}
+
+/// \brief State of the calls of a sampling trace logger running in a thread
+struct SampleThreadState
+{
+	const SampleTraceLogger* logger;	///< logger the state belongs to or NULL if the slot is free
+	unsigned int depth;			///< number of calls running
+	bool sampled;				///< true if the calls running are traced
+};
+
+// ... the state is POD for being thread local without C++11, a thread can have calls of this many sampling loggers running at the same time:
+#define MaxNestedSampleLoggers 4
+static __thread SampleThreadState g_threadStates[ MaxNestedSampleLoggers];
+
+static SampleThreadState* getThreadState( const SampleTraceLogger* logger, bool create)
+{
+	SampleThreadState* freeSlot = 0;
+	for (int si=0; si < MaxNestedSampleLoggers; ++si)
+	{
+		if (g_threadStates[ si].logger == logger) return &g_threadStates[ si];
+		if (!freeSlot && !g_threadStates[ si].logger) freeSlot = &g_threadStates[ si];
+	}
+	if (create && freeSlot)
+	{
+		freeSlot->logger = logger;
+		freeSlot->depth = 0;
+		freeSlot->sampled = false;
+		return freeSlot;
+	}
+	return 0;
+}
+
+TraceLogRecordHandle SampleTraceLogger::logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId)
+{
+	SampleThreadState* state = getThreadState( this, true);
+	if (!state) return 0;
+	if (state->depth++ == 0)
+	{
+		state->sampled = sample();
+	}
+	if (!state->sampled) return 0;
+	return m_inner->logMethodCall( className, methodName, objId);
+}
+
+void SampleTraceLogger::logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter)
+{
+	SampleThreadState* state = getThreadState( this, false);
+	if (!state || state->depth == 0) return;
+	bool sampled = state->sampled;
+	if (--state->depth == 0)
+	{
+		state->logger = 0;
+	}
+	if (sampled)
+	{
+		m_inner->logMethodTermination( loghnd, parameter);
+	}
+}
+
+bool SampleTraceLogger::close()
+{
+	return m_inner->close();
+}
+
+TraceLoggerInterface* strus::createTraceLogger_sample( std::string& config, const InnerTraceLoggerFactory& inner, ErrorBufferInterface* errorhnd)
+{
+	try
+	{
+		double rate = DefaultRate;
+		if (!extractFloatFromConfigString( rate, config, "rate", errorhnd))
+		{
+			if (errorhnd->hasError()) return 0;
+			rate = DefaultRate;
+		}
+		if (rate < 0.0 || rate > 1.0)
+		{
+			throw std::runtime_error( _TXT("sampling 'rate' of trace logger must be between 0.0 and 1.0"));
+		}
+		TraceLoggerInterface* innerLogger = inner.create( config);
+		if (!innerLogger) return 0;
+		try
+		{
+			return new SampleTraceLogger( innerLogger, rate, errorhnd);
+		}
+		catch (...)
+		{
+			delete innerLogger;
+			throw;
+		}
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error creating sampling trace logger: %s"), *errorhnd, 0);
+}
+
@@ -0,0 +1,61 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Trace logger passing a sample of the top level calls with all calls nested in them to another trace logger
+/// \file sampleTraceLogger.hpp
+#ifndef _STRUS_MODULE_SAMPLE_TRACE_LOGGER_HPP_INCLUDED
+#define _STRUS_MODULE_SAMPLE_TRACE_LOGGER_HPP_INCLUDED
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/base/atomic.hpp"
+#include "traceLoggerWrapper.hpp"
+#include <string>
+#include <vector>
+
+namespace strus
+{
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Trace logger deciding for every top level call of a thread if it is traced, the calls nested in a top level call are traced if it is
+/// \note A call is top level if no call logged by this logger is running in the same thread.
+///		The calls not sampled cost an increment and a decrement of the nesting depth of the thread.
+class SampleTraceLogger
+	:public TraceLoggerInterface
+{
+public:
+	/// \brief Constructor
+	/// \param[in] inner_ trace logger the calls sampled are passed to (ownership passed)
+	/// \param[in] rate_ fraction of top level calls traced, between 0.0 and 1.0
+	/// \param[in] errorhnd_ buffer for reporting errors
+	SampleTraceLogger( TraceLoggerInterface* inner_, double rate_, ErrorBufferInterface* errorhnd_);
+	virtual ~SampleTraceLogger();
+
+	virtual TraceLogRecordHandle logMethodCall( const char* className, const char* methodName, const TraceObjectId& objId);
+	virtual void logMethodTermination( const TraceLogRecordHandle& loghnd, const std::vector<TraceElement>& parameter);
+	virtual bool close();
+
+private:
+	/// \brief Decide if the next top level call is traced
+	bool sample();
+
+private:
+	SampleTraceLogger( const SampleTraceLogger&){}		//< non copyable
+	void operator=( const SampleTraceLogger&){}		//< non copyable
+
+private:
+	TraceLoggerInterface* m_inner;				///< logger the calls sampled are passed to
+	unsigned int m_threshold;				///< a top level call is traced if the hash of its number is below this value
+	strus::AtomicCounter<unsigned int> m_callCounter;	///< counter of the top level calls
+	ErrorBufferInterface* m_errorhnd;			///< buffer for reporting errors
+};
+
+/// \brief Create a sampling trace logger, configuration key 'rate' (fraction of top level calls traced, default 0.01)
+TraceLoggerInterface* createTraceLogger_sample( std::string& config, const InnerTraceLoggerFactory& inner, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
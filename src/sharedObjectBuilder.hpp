@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Object builders handed out by the module loader sharing one cached builder instance
+/// \file sharedObjectBuilder.hpp
+#ifndef _STRUS_MODULE_SHARED_OBJECT_BUILDER_HPP_INCLUDED
+#define _STRUS_MODULE_SHARED_OBJECT_BUILDER_HPP_INCLUDED
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/reference.hpp"
+#include <string>
+
+namespace strus
+{
+namespace module
+{
+
+/// \brief Storage object builder forwarding all calls to a builder shared with other instances
+/// \note The builder shared is deleted with the last instance referencing it
+class SharedStorageObjectBuilder
+	:public StorageObjectBuilderInterface
+{
+public:
+	explicit SharedStorageObjectBuilder( const Reference<StorageObjectBuilderInterface>& impl_)
+		:m_impl(impl_){}
+	virtual ~SharedStorageObjectBuilder(){}
+
+	virtual const StorageInterface* getStorage() const
+	{
+		return m_impl->getStorage();
+	}
+	virtual const DatabaseInterface* getDatabase( const std::string& config) const
+	{
+		return m_impl->getDatabase( config);
+	}
+	virtual const QueryProcessorInterface* getQueryProcessor() const
+	{
+		return m_impl->getQueryProcessor();
+	}
+	virtual const StatisticsProcessorInterface* getStatisticsProcessor( const std::string& name) const
+	{
+		return m_impl->getStatisticsProcessor( name);
+	}
+	virtual const VectorStorageInterface* getVectorStorage( const std::string& name) const
+	{
+		return m_impl->getVectorStorage( name);
+	}
+	virtual QueryEvalInterface* createQueryEval() const
+	{
+		return m_impl->createQueryEval();
+	}
+
+private:
+	Reference<StorageObjectBuilderInterface> m_impl;	///< builder shared
+};
+
+/// \brief Analyzer object builder forwarding all calls to a builder shared with other instances
+/// \note The builder shared is deleted with the last instance referencing it
+class SharedAnalyzerObjectBuilder
+	:public AnalyzerObjectBuilderInterface
+{
+public:
+	explicit SharedAnalyzerObjectBuilder( const Reference<AnalyzerObjectBuilderInterface>& impl_)
+		:m_impl(impl_){}
+	virtual ~SharedAnalyzerObjectBuilder(){}
+
+	virtual const TextProcessorInterface* getTextProcessor() const
+	{
+		return m_impl->getTextProcessor();
+	}
+	virtual DocumentAnalyzerInstanceInterface* createDocumentAnalyzer(
+			const SegmenterInterface* segmenter,
+			const analyzer::SegmenterOptions& opts) const
+	{
+		return m_impl->createDocumentAnalyzer( segmenter, opts);
+	}
+	virtual PosTaggerInstanceInterface* createPosTaggerInstance(
+			const SegmenterInterface* segmenter,
+			const analyzer::SegmenterOptions& opts) const
+	{
+		return m_impl->createPosTaggerInstance( segmenter, opts);
+	}
+	virtual QueryAnalyzerInstanceInterface* createQueryAnalyzer() const
+	{
+		return m_impl->createQueryAnalyzer();
+	}
+	virtual DocumentAnalyzerMapInterface* createDocumentAnalyzerMap() const
+	{
+		return m_impl->createDocumentAnalyzerMap();
+	}
+	virtual DocumentClassDetectorInterface* createDocumentClassDetector() const
+	{
+		return m_impl->createDocumentClassDetector();
+	}
+	virtual ContentStatisticsInterface* createContentStatistics() const
+	{
+		return m_impl->createContentStatistics();
+	}
+
+private:
+	Reference<AnalyzerObjectBuilderInterface> m_impl;	///< builder shared
+};
+
+}}//namespace
+#endif
+
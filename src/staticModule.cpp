@@ -0,0 +1,26 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/staticModule.hpp"
+#include "strus/base/dll_tags.hpp"
+
+using namespace strus;
+
+// ... zero initialized before any dynamic initialization, registrations are done single threaded in the static initialization
+static StaticModuleRegistration* g_staticModules = 0;
+
+DLL_PUBLIC void strus::registerStaticModule( StaticModuleRegistration* reg)
+{
+	reg->next = g_staticModules;
+	g_staticModules = reg;
+}
+
+DLL_PUBLIC const StaticModuleRegistration* strus::staticModules()
+{
+	return g_staticModules;
+}
+
@@ -25,8 +25,8 @@
 #include "strus/statisticsProcessorInterface.hpp"
 #include "strus/base/fileio.hpp"
 #include "strus/base/configParser.hpp"
-#include "strus/base/string_conv.hpp"
 #include "strus/constants.hpp"
+#include "loadMetrics.hpp"
 #include "errorUtils.hpp"
 #include "internationalization.hpp"
 #include <string>
@@ -36,25 +36,23 @@
 using namespace strus;
 using namespace strus::module;
 
-StorageObjectBuilder::StorageObjectBuilder( const FileLocatorInterface* filelocator_, ErrorBufferInterface* errorhnd_)
-	:m_filelocator(filelocator_)
-	,m_queryProcessor( strus::createQueryProcessor(filelocator_,errorhnd_))
-	,m_storage(strus::createStorageType_std(filelocator_,errorhnd_))
-	,m_statsprocmap()
-	,m_errorhnd(errorhnd_)
+StorageObjectBuilder::StorageObjectBuilder( const FileLocatorInterface* filelocator_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_)
+	:m_moduleHandles(),m_filelocator(filelocator_)
+	,m_queryProcessor()
+	,m_storage(),m_storagePublished(0)
+	,m_dbmap(),m_statsprocmap(),m_vsmodelmap(),m_mutex()
+	,m_metrics(metrics_),m_errorhnd(errorhnd_)
 {
-	if (!m_queryProcessor.get()) throw strus::runtime_error(_TXT("error creating '%s'"), "query processor");
-	if (!m_storage.get()) throw strus::runtime_error(_TXT("error creating '%s'"), "storage");
+	QueryProcessorInterface* qpi = strus::createQueryProcessor( filelocator_, errorhnd_);
+	if (!qpi) throw strus::runtime_error(_TXT("error creating '%s'"), "query processor");
+	m_queryProcessor.reset( new LazyQueryProcessor( qpi, metrics_, errorhnd_));
 
-	DatabaseReference dbref( strus::createDatabaseType_leveldb( m_filelocator, m_errorhnd));
-	if (!dbref.get()) throw strus::runtime_error( _TXT( "failed to create handle for default key value store database '%s'"), "leveldb");
-	m_dbmap[ strus::Constants::leveldb_database_name()] = dbref;
-	m_dbmap[ ""] = dbref;
+	m_dbmap.insert( strus::Constants::leveldb_database_name(), LazyDatabase( &strus::createDatabaseType_leveldb));
 
 	StatisticsProcessorReference spref( strus::createStatisticsProcessor_std( m_filelocator, m_errorhnd));
 	if (!spref.get()) throw std::runtime_error( _TXT( "failed to create handle for default statistics processor"));
-	m_statsprocmap[ strus::Constants::standard_statistics_processor()] = spref;
-	m_statsprocmap[ ""] = spref;
+	m_statsprocmap.insert( strus::Constants::standard_statistics_processor(), spref);
+	m_statsprocmap.insert( "", spref);
 }
 
 const QueryProcessorInterface* StorageObjectBuilder::getQueryProcessor() const
@@ -69,110 +67,45 @@ void StorageObjectBuilder::addStorageModule( const StorageModule* mod)
 		m_errorhnd->report( ErrorCodeOperationOrder, _TXT( "cannot add storage module with previous unhandled errors"));
 		return;
 	}
-	if (mod->postingIteratorJoinConstructor)
+	try
 	{
-		PostingIteratorJoinConstructor const* pi = mod->postingIteratorJoinConstructor;
-		for (; pi->create != 0; ++pi)
+		// ... functions are created by the query processor on the first lookup of their name:
+		if (mod->postingIteratorJoinConstructor)
 		{
-			PostingJoinOperatorInterface* func = pi->create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating posting join operator"));
-				return;
-			}
-			else
-			{
-				m_queryProcessor->definePostingJoinOperator( pi->name, func);
-				if (m_errorhnd->hasError())
-				{
-					delete func;
-					m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining posting join operator"));
-					return;
-				}
-			}
+			m_queryProcessor->registerPostingJoinOperators( mod->postingIteratorJoinConstructor);
 		}
-	}
-	if (mod->weightingFunctionConstructor)
-	{
-		WeightingFunctionConstructor const* wi = mod->weightingFunctionConstructor;
-		for (; wi->create != 0; ++wi)
+		if (mod->weightingFunctionConstructor)
 		{
-			WeightingFunctionInterface* func = wi->create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating weighting function"));
-				return;
-			}
-			m_queryProcessor->defineWeightingFunction( wi->name, func);
-			if (m_errorhnd->hasError())
-			{
-				delete func;
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining weighting function"));
-				return;
-			}
+			m_queryProcessor->registerWeightingFunctions( mod->weightingFunctionConstructor);
 		}
-	}
-	if (mod->summarizerFunctionConstructor)
-	{
-		SummarizerFunctionConstructor const* si = mod->summarizerFunctionConstructor;
-		for (; si->create != 0; ++si)
+		if (mod->summarizerFunctionConstructor)
 		{
-			SummarizerFunctionInterface* func = si->create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating summarizer function '%s'"), si->name);
-				return;
-			}
-			m_queryProcessor->defineSummarizerFunction( si->name, func);
-			if (m_errorhnd->hasError())
-			{
-				delete func;
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining summarizer function '%s'"), si->name);
-				return;
-			}
+			m_queryProcessor->registerSummarizerFunctions( mod->summarizerFunctionConstructor);
 		}
-	}
-	if (mod->scalarFunctionParserConstructor)
-	{
-		ScalarFunctionParserConstructor const* si = mod->scalarFunctionParserConstructor;
-		for (; si->create != 0; ++si)
+		if (mod->scalarFunctionParserConstructor)
 		{
-			ScalarFunctionParserInterface* func = si->create( m_errorhnd);
-			if (!func)
-			{
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error creating scalar function parser '%s'"), si->name);
-				return;
-			}
-			m_queryProcessor->defineScalarFunctionParser( si->name, func);
-			if (m_errorhnd->hasError())
-			{
-				delete func;
-				m_errorhnd->report( ErrorCodeRuntimeError, _TXT("error defining scalar function parser '%s'"), si->name);
-				return;
-			}
+			m_queryProcessor->registerScalarFunctionParsers( mod->scalarFunctionParserConstructor);
 		}
-	}
-	try
-	{
+
 		m_storageModules.push_back( mod);
 
 		if (mod->databaseConstructor.create && mod->databaseConstructor.name)
 		{
-			DatabaseReference dbref( mod->databaseConstructor.create( m_filelocator, m_errorhnd));
-			if (!dbref.get()) throw strus::runtime_error( _TXT( "failed to create data base Constructor loaded from module: '%s': %s"), mod->databaseConstructor.name, m_errorhnd->fetchError());
-			m_dbmap[ string_conv::tolower( mod->databaseConstructor.name)] = dbref;
+			strus::scoped_lock lock( m_mutex);
+			m_dbmap.insert( mod->databaseConstructor.name, LazyDatabase( mod->databaseConstructor.create));
 		}
 		if (mod->statisticsProcessorConstructor.create && mod->statisticsProcessorConstructor.name)
 		{
+			double starttime = getMonotonicTime();
 			StatisticsProcessorReference spref( mod->statisticsProcessorConstructor.create( m_errorhnd));
 			if (!spref.get()) throw strus::runtime_error( _TXT( "failed to create statistics processor Constructor loaded from module: '%s': %s"), mod->statisticsProcessorConstructor.name, m_errorhnd->fetchError());
-			m_statsprocmap[ string_conv::tolower( mod->statisticsProcessorConstructor.name)] = spref;
+			if (m_metrics) m_metrics->add( "statsproc", mod->statisticsProcessorConstructor.name, getMonotonicTime() - starttime);
+			m_statsprocmap.insert( mod->statisticsProcessorConstructor.name, spref);
 		}
 		if (mod->vectorStorageConstructor.create && mod->vectorStorageConstructor.name)
 		{
-			VectorStorageReference ref( mod->vectorStorageConstructor.create( m_filelocator, m_errorhnd));
-			if (!ref.get()) throw strus::runtime_error( _TXT( "failed to create vector storage interface loaded from module: '%s': %s"), mod->vectorStorageConstructor.name, m_errorhnd->fetchError());
-			m_vsmodelmap[ string_conv::tolower( mod->vectorStorageConstructor.name)] = ref;
+			strus::scoped_lock lock( m_mutex);
+			m_vsmodelmap.insert( mod->vectorStorageConstructor.name, LazyVectorStorage( mod->vectorStorageConstructor.create));
 		}
 	}
 	CATCH_ERROR_MAP( _TXT("failed to add storage module: %s"), *m_errorhnd);
@@ -182,16 +115,26 @@ const DatabaseInterface* StorageObjectBuilder::getDatabase( const std::string& n
 {
 	try
 	{
-		std::map<std::string,DatabaseReference>::const_iterator
-			di = m_dbmap.find( string_conv::tolower( name));
-		if (di == m_dbmap.end())
+		LazyDatabase* db = name.empty()
+				? m_dbmap.find( strus::Constants::leveldb_database_name(), std::strlen( strus::Constants::leveldb_database_name()))
+				: m_dbmap.find( name);
+		if (!db)
 		{
 			throw strus::runtime_error( _TXT( "undefined key value store database '%s'"), name.c_str());
 		}
-		else
+		const DatabaseInterface* rt = db->published.load();
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have created it meanwhile
+		if (!db->ref.get())
 		{
-			return di->second.get();
+			double starttime = getMonotonicTime();
+			db->ref.reset( db->create( m_filelocator, m_errorhnd));
+			if (!db->ref.get()) throw strus::runtime_error( _TXT( "failed to create key value store database '%s': %s"), name.c_str(), m_errorhnd->fetchError());
+			if (m_metrics) m_metrics->add( "database", name.empty() ? strus::Constants::leveldb_database_name() : name, getMonotonicTime() - starttime);
+			db->published.store( db->ref.get());
 		}
+		return db->ref.get();
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error getting database from storage object builder: %s"), *m_errorhnd, 0);
 }
@@ -200,15 +143,14 @@ const StatisticsProcessorInterface* StorageObjectBuilder::getStatisticsProcessor
 {
 	try
 	{
-		std::map<std::string,StatisticsProcessorReference>::const_iterator
-			si = m_statsprocmap.find( string_conv::tolower( name));
-		if (si == m_statsprocmap.end())
+		const StatisticsProcessorReference* sp = m_statsprocmap.find( name);
+		if (!sp)
 		{
 			throw strus::runtime_error( _TXT( "undefined statistics processor '%s'"), name.c_str());
 		}
 		else
 		{
-			return si->second.get();
+			return sp->get();
 		}
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error getting statistics processor from storage object builder: %s"), *m_errorhnd, 0);
@@ -218,23 +160,66 @@ const VectorStorageInterface* StorageObjectBuilder::getVectorStorage( const std:
 {
 	try
 	{
-		std::map<std::string,VectorStorageReference>::const_iterator
-			si = m_vsmodelmap.find( string_conv::tolower( name));
-		if (si == m_vsmodelmap.end())
+		LazyVectorStorage* vs = m_vsmodelmap.find( name);
+		if (!vs)
 		{
 			throw strus::runtime_error( _TXT( "undefined vector storage interface '%s'"), name.c_str());
 		}
-		else
+		const VectorStorageInterface* rt = vs->published.load();
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have created it meanwhile
+		if (!vs->ref.get())
 		{
-			return si->second.get();
+			double starttime = getMonotonicTime();
+			vs->ref.reset( vs->create( m_filelocator, m_errorhnd));
+			if (!vs->ref.get()) throw strus::runtime_error( _TXT( "failed to create vector storage interface '%s': %s"), name.c_str(), m_errorhnd->fetchError());
+			if (m_metrics) m_metrics->add( "vectorstorage", name, getMonotonicTime() - starttime);
+			vs->published.store( vs->ref.get());
 		}
+		return vs->ref.get();
 	}
 	CATCH_ERROR_MAP_RETURN( _TXT("error getting vector storage interface from storage object builder: %s"), *m_errorhnd, 0);
 }
 
 const StorageInterface* StorageObjectBuilder::getStorage() const
 {
-	return m_storage.get();
+	try
+	{
+		const StorageInterface* rt = m_storagePublished.load();
+		if (rt) return rt;
+		strus::scoped_lock lock( m_mutex);
+		// ... check again with the lock held, another thread might have created it meanwhile
+		if (!m_storage.get())
+		{
+			double starttime = getMonotonicTime();
+			m_storage.reset( strus::createStorageType_std( m_filelocator, m_errorhnd));
+			if (!m_storage.get()) throw strus::runtime_error(_TXT("error creating '%s'"), "storage");
+			if (m_metrics) m_metrics->add( "storage", "std", getMonotonicTime() - starttime);
+			m_storagePublished.store( m_storage.get());
+		}
+		return m_storage.get();
+	}
+	CATCH_ERROR_MAP_RETURN( _TXT("error getting storage from storage object builder: %s"), *m_errorhnd, 0);
+}
+
+void StorageObjectBuilder::resetProcessHandles()
+{
+	strus::scoped_lock lock( m_mutex);
+	m_storagePublished.store( 0);
+	m_storage.reset();
+	std::size_t di = 0, de = m_dbmap.size();
+	for (; di != de; ++di)
+	{
+		m_dbmap.valueAt( di).published.store( 0);
+		m_dbmap.valueAt( di).ref.reset();
+	}
+	std::size_t vi = 0, ve = m_vsmodelmap.size();
+	for (; vi != ve; ++vi)
+	{
+		m_vsmodelmap.valueAt( vi).published.store( 0);
+		m_vsmodelmap.valueAt( vi).ref.reset();
+	}
 }
 
 QueryEvalInterface* StorageObjectBuilder::createQueryEval() const
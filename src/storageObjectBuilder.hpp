@@ -15,20 +15,26 @@
 #include "strus/segmenterInterface.hpp"
 #include "strus/statisticsProcessorInterface.hpp"
 #include "strus/vectorStorageInterface.hpp"
+#include "strus/storageModule.hpp"
+#include "strus/base/thread.hpp"
+#include "strus/base/atomic.hpp"
+#include "lazyQueryProcessor.hpp"
+#include "caseInsensitiveHashMap.hpp"
+#include "moduleHandle.hpp"
 #include <string>
 #include <vector>
-#include <map>
 
 namespace strus
 {
 /// \brief Forward declaration
-struct StorageModule;
 /// \brief Forward declaration
 class QueryEvalInterface;
 /// \brief Forward declaration
 class ErrorBufferInterface;
 /// \brief Forward declaration
 class FileLocatorInterface;
+/// \brief Forward declaration
+class ConstructorMetricsCollector;
 
 namespace module
 {
@@ -38,7 +44,7 @@ class StorageObjectBuilder
 	:public StorageObjectBuilderInterface
 {
 public:
-	StorageObjectBuilder( const FileLocatorInterface* filelocator_, ErrorBufferInterface* errorhnd_);
+	StorageObjectBuilder( const FileLocatorInterface* filelocator_, ConstructorMetricsCollector* metrics_, ErrorBufferInterface* errorhnd_);
 	virtual ~StorageObjectBuilder(){}
 
 	virtual const StorageInterface* getStorage() const;
@@ -50,18 +56,51 @@ public:
 
 public/*ModuleLoader*/:
 	void addStorageModule( const StorageModule* mod);
+	/// \brief Keep a module used alive as long as this builder exists
+	void addModuleHandle( const ModuleHandleReference& hnd)
+	{
+		m_moduleHandles.push_back( hnd);
+	}
+	/// \brief Drop the storage, databases and vector storages created, so that they are created again in the calling process on their next request
+	/// \note Called in a worker process forked, objects returned by the getters before must not be used anymore
+	void resetProcessHandles();
+
+private:
+	/// \brief Object created on the first request with the constructor registered
+	template <class Interface, typename Create>
+	struct LazyObject
+	{
+		Reference<Interface> ref;		///< object created or NULL if not created yet, owned, set with the mutex locked
+		strus::atomic<Interface*> published;	///< object created published for the lookup without lock or NULL
+		Create create;				///< constructor of the object
+
+		LazyObject()
+			:ref(),published(0),create(0){}
+		explicit LazyObject( Create create_)
+			:ref(),published(0),create(create_){}
+		LazyObject( const LazyObject& o)
+			:ref(o.ref),published(o.published.load()),create(o.create){}
+		LazyObject& operator=( const LazyObject& o)
+			{ref=o.ref; published.store( o.published.load()); create=o.create; return *this;}
+	};
 
 private:
+	// ... declared first to be destroyed last, after all objects created with code of the modules:
+	std::vector<ModuleHandleReference> m_moduleHandles;			///< handles of the modules used
 	const FileLocatorInterface* m_filelocator;				///< interface to locate files to read or the working directory where to write files to
 	std::vector<const StorageModule*> m_storageModules;			///< loaded modules
-	Reference<QueryProcessorInterface> m_queryProcessor;			///< query processor handle
-	Reference<StorageInterface> m_storage;					///< storage handle
-	typedef Reference<DatabaseInterface> DatabaseReference;
-	std::map<std::string,DatabaseReference> m_dbmap;			///< cached database handles
+	Reference<LazyQueryProcessor> m_queryProcessor;				///< query processor handle, functions are created on first use
+	mutable Reference<StorageInterface> m_storage;				///< storage handle, created on first use with the mutex locked
+	mutable strus::atomic<StorageInterface*> m_storagePublished;		///< storage handle published for the lookup without lock or NULL
+	typedef LazyObject<DatabaseInterface,DatabaseConstructor::Create> LazyDatabase;
+	mutable CaseInsensitiveHashMap<LazyDatabase> m_dbmap;			///< database handles, created on first use
 	typedef Reference<StatisticsProcessorInterface> StatisticsProcessorReference;
-	std::map<std::string,StatisticsProcessorReference> m_statsprocmap;	///< statistics processor interface map
-	typedef Reference<VectorStorageInterface> VectorStorageReference;
-	std::map<std::string,VectorStorageReference> m_vsmodelmap;		///< vector storage interface handle map
+	CaseInsensitiveHashMap<StatisticsProcessorReference> m_statsprocmap;	///< statistics processor interface map
+	typedef LazyObject<VectorStorageInterface,VectorStorageConstructor::Create> LazyVectorStorage;
+	mutable CaseInsensitiveHashMap<LazyVectorStorage> m_vsmodelmap;	///< vector storage interface handles, created on first use
+	// ... the maps are filled by addStorageModule before the builder is used, the objects created are published atomically, so only their creation takes the mutex:
+	mutable strus::mutex m_mutex;						///< mutex for creating m_storage and the objects in m_dbmap and m_vsmodelmap on first use
+	ConstructorMetricsCollector* m_metrics;					///< collector of the time spent in constructors or NULL
 	ErrorBufferInterface* m_errorhnd;					///< buffer for reporting errors
 };
 
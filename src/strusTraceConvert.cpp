@@ -0,0 +1,288 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "binaryTraceFormat.hpp"
+#include "internationalization.hpp"
+#include "strus/versionModule.hpp"
+#include "strus/base/string_format.hpp"
+#include "strus/base/fileio.hpp"
+#include <stdexcept>
+#include <string>
+#include <cstring>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+
+#undef STRUS_LOWLEVEL_DEBUG
+
+using namespace strus::binarytrace;
+
+static void printUsage()
+{
+	std::cout << "strusTraceConvert [options] <tracefile>" << std::endl;
+	std::cout << "options:" << std::endl;
+	std::cout << "-h|--help" << std::endl;
+	std::cout << "    " << _TXT("Print this usage and do nothing else") << std::endl;
+	std::cout << "-v|--version" << std::endl;
+	std::cout << "    " << _TXT("Print the program version and do nothing else") << std::endl;
+	std::cout << "-f|--format <FMT>" << std::endl;
+	std::cout << "    " << _TXT("Print the trace in format <FMT> ('json' or 'dump', default 'dump')") << std::endl;
+	std::cout << "<tracefile>  : " << _TXT("path of a trace written by the trace logger 'binary' or 'ring'") << std::endl;
+}
+
+static std::string jsonString( const std::string& str)
+{
+	std::string rt( "\"");
+	std::string::const_iterator si = str.begin(), se = str.end();
+	for (; si != se; ++si)
+	{
+		unsigned char ch = (unsigned char)*si;
+		switch (ch)
+		{
+			case '"': rt.append( "\\\""); break;
+			case '\\': rt.append( "\\\\"); break;
+			case '\n': rt.append( "\\n"); break;
+			case '\r': rt.append( "\\r"); break;
+			case '\t': rt.append( "\\t"); break;
+			default:
+				if (ch < 32)
+				{
+					char buf[ 8];
+					std::snprintf( buf, sizeof(buf), "\\u%04x", (unsigned int)ch);
+					rt.append( buf);
+				}
+				else
+				{
+					rt.push_back( (char)ch);
+				}
+		}
+	}
+	rt.push_back( '"');
+	return rt;
+}
+
+static std::string elementValue( const Element& elem)
+{
+	switch (elem.type)
+	{
+		case ElementVoid: return "null";
+		case ElementBool: return elem.uintval ? "true" : "false";
+		case ElementInt: return strus::string_format( "%lld", elem.intval);
+		case ElementUInt: return strus::string_format( "%llu", elem.uintval);
+		case ElementDouble: return strus::string_format( "%g", elem.doubleval);
+		case ElementString: return jsonString( elem.strval);
+		case ElementObject: return strus::string_format( "\"#%llu\"", elem.uintval);
+		case ElementOpenIndex:
+		case ElementOpenTag:
+		case ElementClose:
+			break;
+	}
+	return std::string();
+}
+
+static std::string elementKey( const Element& elem)
+{
+	return elem.type == ElementOpenTag ? elem.strval : strus::string_format( "%llu", elem.uintval);
+}
+
+/// \brief Print the parameters as JSON, a substructure is an object with the tag or index as key and an array of its elements as value
+static void printJsonParameter( std::ostream& out, const std::vector<Element>& parameter)
+{
+	out << "[";
+	std::vector<bool> first( 1, true);
+	std::vector<Element>::const_iterator pi = parameter.begin(), pe = parameter.end();
+	for (; pi != pe; ++pi)
+	{
+		if (pi->type == ElementClose)
+		{
+			if (first.size() > 1)
+			{
+				out << "]}";
+				first.pop_back();
+			}
+			continue;
+		}
+		if (!first.back()) out << ",";
+		first.back() = false;
+		if (pi->type == ElementOpenTag || pi->type == ElementOpenIndex)
+		{
+			out << "{" << jsonString( elementKey( *pi)) << ":[";
+			first.push_back( true);
+		}
+		else
+		{
+			out << elementValue( *pi);
+		}
+	}
+	for (; first.size() > 1; first.pop_back()) out << "]}";
+	out << "]";
+}
+
+/// \brief Print the parameters as indented lines
+static void printDumpParameter( std::ostream& out, const std::vector<Element>& parameter)
+{
+	std::size_t depth = 1;
+	std::vector<Element>::const_iterator pi = parameter.begin(), pe = parameter.end();
+	for (; pi != pe; ++pi)
+	{
+		if (pi->type == ElementClose)
+		{
+			if (depth > 1) --depth;
+			continue;
+		}
+		out << std::string( depth, '\t');
+		if (pi->type == ElementOpenTag)
+		{
+			out << pi->strval << ":" << std::endl;
+			++depth;
+		}
+		else if (pi->type == ElementOpenIndex)
+		{
+			out << "[" << pi->uintval << "]:" << std::endl;
+			++depth;
+		}
+		else
+		{
+			out << elementValue( *pi) << std::endl;
+		}
+	}
+}
+
+static void convertTrace( std::ostream& out, const std::string& content, bool json)
+{
+	Reader reader( content);
+	Record record;
+	bool first = true;
+	if (json) out << "[" << std::endl;
+	while (reader.next( record))
+	{
+		if (json)
+		{
+			out << (first ? "" : ",\n");
+			if (record.type == RecordCall)
+			{
+				out << "{\"call\":" << record.handle
+					<< ",\"class\":" << jsonString( record.className)
+					<< ",\"method\":" << jsonString( record.methodName)
+					<< ",\"object\":" << record.objId << "}";
+			}
+			else
+			{
+				out << "{\"return\":" << record.handle << ",\"parameter\":";
+				printJsonParameter( out, record.parameter);
+				out << "}";
+			}
+		}
+		else
+		{
+			if (record.type == RecordCall)
+			{
+				out << "call " << record.handle << " " << record.className << "::" << record.methodName << " object " << record.objId << std::endl;
+			}
+			else
+			{
+				out << "return " << record.handle << std::endl;
+				printDumpParameter( out, record.parameter);
+			}
+		}
+		first = false;
+	}
+	if (json) out << (first ? "" : "\n") << "]" << std::endl;
+	if (reader.truncated())
+	{
+		std::cerr << _TXT("the last record of the trace is incomplete and has been ignored") << std::endl;
+	}
+}
+
+int main( int argc, const char* argv[])
+{
+	try
+	{
+		bool doExit = false;
+		bool json = false;
+
+		// Parsing arguments:
+		int argi = 1;
+		for (; argi < argc; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "-h") || 0==std::strcmp( argv[argi], "--help"))
+			{
+				printUsage();
+				doExit = true;
+			}
+			else if (0==std::strcmp( argv[argi], "-v") || 0==std::strcmp( argv[argi], "--version"))
+			{
+				std::cerr << strus::string_format( _TXT("strus module version %s"), STRUS_MODULE_VERSION_STRING) << std::endl;
+				doExit = true;
+			}
+			else if (0==std::strcmp( argv[argi], "-f") || 0==std::strcmp( argv[argi], "--format"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( _TXT("missing argument for option --format / -f"));
+				if (0==std::strcmp( argv[argi], "json"))
+				{
+					json = true;
+				}
+				else if (0==std::strcmp( argv[argi], "dump"))
+				{
+					json = false;
+				}
+				else
+				{
+					throw strus::runtime_error(_TXT("unknown format '%s', expected 'json' or 'dump'"), argv[ argi]);
+				}
+			}
+			else if (argv[argi][0] == '-')
+			{
+				if (argv[argi][1] == '-')
+				{
+					++argi;
+					break;
+				}
+				else
+				{
+					throw strus::runtime_error(_TXT("unknown option %s"), argv[ argi]);
+				}
+			}
+			else
+			{
+				break;
+			}
+		}
+		if (doExit)
+		{
+			return 0;
+		}
+		if (argi + 1 != argc)
+		{
+			std::cerr << _TXT("expected trace file as single argument") << std::endl;
+			printUsage();
+			return -1;
+		}
+		std::string content;
+		int ec = strus::readFile( argv[ argi], content);
+		if (ec) throw strus::runtime_error(_TXT("failed to read trace file '%s': %s"), argv[ argi], ::strerror( ec));
+		if (isRingTrace( content))
+		{
+			// ... a ring trace is converted to a binary trace with the records from the oldest to the newest still in the ring
+			unsigned long long nofDropped = 0;
+			content = linearizeRingTrace( content, nofDropped);
+			if (nofDropped)
+			{
+				std::cerr << strus::string_format( _TXT("%llu records have been dropped by the trace logger"), nofDropped) << std::endl;
+			}
+		}
+		convertTrace( std::cout, content, json);
+		return 0;
+	}
+	catch (const std::exception& e)
+	{
+		std::cerr << e.what() << std::endl;
+	}
+	std::cerr << _TXT("terminated") << std::endl;
+	return -1;
+}
+
@@ -0,0 +1,41 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Declarations for built-in trace loggers forwarding the events to another trace logger
+/// \file traceLoggerWrapper.hpp
+#ifndef _STRUS_MODULE_TRACE_LOGGER_WRAPPER_HPP_INCLUDED
+#define _STRUS_MODULE_TRACE_LOGGER_WRAPPER_HPP_INCLUDED
+#include <string>
+
+namespace strus
+{
+/// \brief Forward declaration
+class TraceLoggerInterface;
+/// \brief Forward declaration
+class ErrorBufferInterface;
+
+/// \brief Factory for the trace logger a wrapper forwards its events to, named with 'inner' in the configuration of the wrapper
+class InnerTraceLoggerFactory
+{
+public:
+	virtual ~InnerTraceLoggerFactory(){}
+
+	/// \brief Create the inner trace logger
+	/// \param[in] config configuration left after the wrapper has extracted its own keys
+	/// \return the logger created (ownership passed) or NULL on error
+	virtual TraceLoggerInterface* create( const std::string& config) const=0;
+};
+
+/// \brief Constructor of a trace logger wrapping another trace logger
+/// \param[in,out] config configuration of the wrapper, the keys of the wrapper are extracted from it before creating the inner logger
+/// \param[in] inner factory for the inner logger
+/// \param[in] errorhnd buffer for reporting errors
+typedef TraceLoggerInterface* (*WrapTraceLogger)( std::string& config, const InnerTraceLoggerFactory& inner, ErrorBufferInterface* errorhnd);
+
+}//namespace
+#endif
+
@@ -0,0 +1,167 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "benchmarkUtils.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage()
+{
+	std::cerr << "benchmarkBuilderLookup [options]" << std::endl;
+	std::cerr << "Measures the lookup of the storage, databases, statistics processors and vector storages by name in the storage object builder." << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--count <N>     :number of lookups per measurement (default 10000000)" << std::endl;
+	std::cerr << "       -m|--module <MOD>  :load the module <MOD> before creating the storage object builder" << std::endl;
+	std::cerr << "       -V|--vector <NAME> :measure the lookup of the vector storage <NAME> defined by a module loaded" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+}
+
+enum LookupType {DatabaseLookup, StatisticsProcessorLookup, VectorStorageLookup, StorageLookup};
+
+static const char* lookupTypeName( LookupType type)
+{
+	switch (type)
+	{
+		case DatabaseLookup: return "database";
+		case StatisticsProcessorLookup: return "statsproc";
+		case VectorStorageLookup: return "vectorstorage";
+		case StorageLookup: return "storage";
+	}
+	return "unknown";
+}
+
+static const void* lookup( const strus::StorageObjectBuilderInterface* builder, LookupType type, const std::string& name)
+{
+	switch (type)
+	{
+		case DatabaseLookup: return builder->getDatabase( name);
+		case StatisticsProcessorLookup: return builder->getStatisticsProcessor( name);
+		case VectorStorageLookup: return builder->getVectorStorage( name);
+		case StorageLookup: return builder->getStorage();
+	}
+	return 0;
+}
+
+static double measureLookup( const strus::StorageObjectBuilderInterface* builder, LookupType type, const std::string& name, int count)
+{
+	double start = strus::benchmark::getTimeSeconds();
+	for (int ii=0; ii < count; ++ii)
+	{
+		const void* obj = lookup( builder, type, name);
+		if (!obj) throw std::runtime_error( std::string("lookup failed for ") + lookupTypeName( type) + " '" + name + "'");
+	}
+	return strus::benchmark::getTimeSeconds() - start;
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		int count = 10000000;
+		std::vector<std::string> modules;
+		std::vector<std::string> vectorStorages;
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--count") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --count / -n");
+				count = std::atoi( argv[argi]);
+				if (count <= 0) throw std::runtime_error( "positive number expected as argument of option --count / -n");
+			}
+			else if (0==std::strcmp( argv[argi], "--module") || 0==std::strcmp( argv[argi], "-m"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --module / -m");
+				modules.push_back( argv[argi]);
+			}
+			else if (0==std::strcmp( argv[argi], "--vector") || 0==std::strcmp( argv[argi], "-V"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --vector / -V");
+				vectorStorages.push_back( argv[argi]);
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				return 0;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				return 1;
+			}
+		}
+		strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, NULL));
+		if (!errorbuf.get()) throw std::runtime_error( "failed to create error buffer");
+		strus::local_ptr<strus::ModuleLoaderInterface> modloader( strus::createModuleLoader( errorbuf.get()));
+		if (!modloader.get()) throw std::runtime_error( "failed to create module loader");
+		std::vector<std::string>::const_iterator mi = modules.begin(), me = modules.end();
+		for (; mi != me; ++mi)
+		{
+			if (!modloader->loadModule( *mi)) throw std::runtime_error( errorbuf->fetchError());
+		}
+		strus::local_ptr<strus::StorageObjectBuilderInterface> builder( modloader->createStorageObjectBuilder());
+		if (!builder.get()) throw std::runtime_error( errorbuf->fetchError());
+
+		struct Measurement
+		{
+			LookupType type;
+			std::string name;
+
+			Measurement( LookupType type_, const std::string& name_)
+				:type(type_),name(name_){}
+			Measurement( const Measurement& o)
+				:type(o.type),name(o.name){}
+		};
+		std::vector<Measurement> measurements;
+		measurements.push_back( Measurement( StorageLookup, "std"));
+		measurements.push_back( Measurement( DatabaseLookup, "leveldb"));
+		measurements.push_back( Measurement( DatabaseLookup, "LevelDB"));
+		measurements.push_back( Measurement( DatabaseLookup, ""));
+		measurements.push_back( Measurement( StatisticsProcessorLookup, "std"));
+		measurements.push_back( Measurement( StatisticsProcessorLookup, "STD"));
+		std::vector<std::string>::const_iterator vi = vectorStorages.begin(), ve = vectorStorages.end();
+		for (; vi != ve; ++vi)
+		{
+			measurements.push_back( Measurement( VectorStorageLookup, *vi));
+		}
+		std::cout << "lookup\tname\tcount\tseconds\tcalls per second" << std::endl;
+		std::vector<Measurement>::const_iterator xi = measurements.begin(), xe = measurements.end();
+		for (; xi != xe; ++xi)
+		{
+			double duration = measureLookup( builder.get(), xi->type, xi->name, count);
+			char line[ 256];
+			std::snprintf( line, sizeof(line), "%s\t%s\t%d\t%.3f\t%.0f",
+					lookupTypeName( xi->type), xi->name.c_str(), count,
+					duration, duration > 0.0 ? count / duration : 0.0);
+			std::cout << line << std::endl;
+		}
+		if (errorbuf->hasError())
+		{
+			throw std::runtime_error( errorbuf->fetchError());
+		}
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error in benchmark: " << err.what() << std::endl;
+		return -1;
+	}
+}
+
@@ -0,0 +1,171 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "testModuleDirectory.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "benchmarkUtils.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage()
+{
+	std::cerr << "benchmarkCatalog [options] { <size> }" << std::endl;
+	std::cerr << "Measures the registration of the synthetic catalog modules 'catalog_storage_<size>' and 'catalog_analyzer_<size>'" << std::endl;
+	std::cerr << "in the object builders and the creation and lookup of the normalizers they define." << std::endl;
+	std::cerr << "Without sizes specified, all catalog sizes generated (STRUS_SYNTHETIC_CATALOG_SIZES) are measured." << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--count <N>     :number of builders created per measurement (default 10)" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+}
+
+static std::string catalogModuleName( const char* type, int size)
+{
+	char buf[ 64];
+	std::snprintf( buf, sizeof(buf), "catalog_%s_%d", type, size);
+	return buf;
+}
+
+static std::string catalogNormalizerName( int size, int idx)
+{
+	char buf[ 128];
+	std::snprintf( buf, sizeof(buf), "catalog_analyzer_%d_normalizer%d", size, idx);
+	return buf;
+}
+
+static void printLine( const char* operation, int size, int count, double seconds)
+{
+	char line[ 256];
+	std::snprintf( line, sizeof(line), "%s\t%d\t%d\t%.4f", operation, size, count, seconds * 1000);
+	std::cout << line << std::endl;
+}
+
+static void measureCatalog( int size, int count)
+{
+	strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, NULL));
+	if (!errorbuf.get()) throw std::runtime_error( "failed to create error buffer");
+	strus::local_ptr<strus::ModuleLoaderInterface> modloader( strus::createModuleLoader( errorbuf.get()));
+	if (!modloader.get()) throw std::runtime_error( "failed to create module loader");
+	modloader->addModulePath( STRUS_TEST_MODULE_DIRECTORY);
+
+	double start = strus::benchmark::getTimeSeconds();
+	if (!modloader->loadModule( catalogModuleName( "storage", size))
+	||  !modloader->loadModule( catalogModuleName( "analyzer", size)))
+	{
+		throw std::runtime_error( errorbuf->fetchError());
+	}
+	printLine( "loadModule", size, 1, strus::benchmark::getTimeSeconds() - start);
+
+	// ... registration of the functions declared in the modules:
+	start = strus::benchmark::getTimeSeconds();
+	for (int ii=0; ii < count; ++ii)
+	{
+		strus::local_ptr<strus::StorageObjectBuilderInterface> builder( modloader->createStorageObjectBuilder());
+		if (!builder.get()) throw std::runtime_error( "failed to create storage object builder");
+	}
+	printLine( "registerStorage", size, count, (strus::benchmark::getTimeSeconds() - start) / count);
+
+	start = strus::benchmark::getTimeSeconds();
+	for (int ii=0; ii < count; ++ii)
+	{
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+		if (!builder.get()) throw std::runtime_error( "failed to create analyzer object builder");
+	}
+	printLine( "registerAnalyzer", size, count, (strus::benchmark::getTimeSeconds() - start) / count);
+
+	// ... creation of the functions on their first lookup and lookup of the functions created:
+	strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+	const strus::TextProcessorInterface* textproc = builder.get() ? builder->getTextProcessor() : NULL;
+	if (!textproc) throw std::runtime_error( "failed to get text processor");
+	for (int pass=0; pass < 2; ++pass)
+	{
+		start = strus::benchmark::getTimeSeconds();
+		for (int ni=1; ni <= size; ++ni)
+		{
+			if (!textproc->getNormalizer( catalogNormalizerName( size, ni)))
+			{
+				throw std::runtime_error( errorbuf->fetchError());
+			}
+		}
+		printLine( pass == 0 ? "createNormalizer" : "lookupNormalizer", size, size, (strus::benchmark::getTimeSeconds() - start) / size);
+	}
+	if (errorbuf->hasError())
+	{
+		throw std::runtime_error( errorbuf->fetchError());
+	}
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		int count = 10;
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--count") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --count / -n");
+				count = std::atoi( argv[argi]);
+				if (count <= 0) throw std::runtime_error( "positive number expected as argument of option --count / -n");
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				return 0;
+			}
+			else if (0==std::strcmp( argv[argi], "--"))
+			{
+				argi++;
+				break;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				return 1;
+			}
+		}
+		std::vector<int> sizes;
+		for (; argi < argc; ++argi)
+		{
+			int size = std::atoi( argv[argi]);
+			if (size <= 0) throw std::runtime_error( "positive number expected as catalog size");
+			sizes.push_back( size);
+		}
+		if (sizes.empty())
+		{
+			static const int generated[] = {STRUS_SYNTHETIC_CATALOG_SIZES};
+			sizes.insert( sizes.end(), generated, generated + sizeof(generated)/sizeof(generated[0]));
+		}
+		std::cout << "operation\tsize\tcount\tms" << std::endl;
+		std::vector<int>::const_iterator si = sizes.begin(), se = sizes.end();
+		for (; si != se; ++si)
+		{
+			measureCatalog( *si, count);
+		}
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error in benchmark: " << err.what() << std::endl;
+		return -1;
+	}
+}
+
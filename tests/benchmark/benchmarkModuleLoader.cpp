@@ -0,0 +1,196 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "testModuleDirectory.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "benchmarkUtils.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage()
+{
+	std::cerr << "benchmarkModuleLoader [options] <modulename> { <modulename> }" << std::endl;
+	std::cerr << "Measures the startup time of a process loading modules in the different load modes." << std::endl;
+	std::cerr << "Every run is done in a new process, because a module stays mapped in the process once it is loaded." << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--runs <N>      :number of runs per load mode (default 20)" << std::endl;
+	std::cerr << "       -m|--mode <MODE>   :only measure load mode <MODE> (eager,lazy,deferred)" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+}
+
+struct RunResult
+{
+	double loadTime;	///< time for creating the module loader and loading the modules
+	double builderTime;	///< time for creating the analyzer object builder afterwards
+
+	RunResult()
+		:loadTime(0.0),builderTime(0.0){}
+};
+
+static bool runLoad( RunResult& result, strus::ModuleLoaderInterface::LoadMode mode, const std::vector<std::string>& modnames)
+{
+	strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, NULL));
+	if (!errorbuf.get()) return false;
+
+	double start = strus::benchmark::getTimeSeconds();
+	strus::local_ptr<strus::ModuleLoaderInterface> modloader( strus::createModuleLoader( errorbuf.get()));
+	if (!modloader.get()) return false;
+	modloader->addModulePath( STRUS_TEST_MODULE_DIRECTORY);
+	modloader->defineLoadMode( mode);
+	std::vector<std::string>::const_iterator mi = modnames.begin(), me = modnames.end();
+	for (; mi != me; ++mi)
+	{
+		if (!modloader->loadModule( *mi)) return false;
+	}
+	double loaded = strus::benchmark::getTimeSeconds();
+	strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+	if (!builder.get()) return false;
+	double built = strus::benchmark::getTimeSeconds();
+
+	result.loadTime = loaded - start;
+	result.builderTime = built - loaded;
+	return !errorbuf->hasError();
+}
+
+/// \brief Run of runLoad in a child process
+struct LoadRun
+{
+	strus::ModuleLoaderInterface::LoadMode mode;
+	const std::vector<std::string>* modnames;
+
+	LoadRun( strus::ModuleLoaderInterface::LoadMode mode_, const std::vector<std::string>& modnames_)
+		:mode(mode_),modnames(&modnames_){}
+	LoadRun( const LoadRun& o)
+		:mode(o.mode),modnames(o.modnames){}
+
+	bool operator()( RunResult& result) const
+	{
+		return runLoad( result, mode, *modnames);
+	}
+};
+
+static double median( std::vector<double> ar)
+{
+	if (ar.empty()) return 0.0;
+	std::sort( ar.begin(), ar.end());
+	return ar[ ar.size() / 2];
+}
+
+static double minimum( const std::vector<double>& ar)
+{
+	return ar.empty() ? 0.0 : *std::min_element( ar.begin(), ar.end());
+}
+
+static const char* modeName( strus::ModuleLoaderInterface::LoadMode mode)
+{
+	switch (mode)
+	{
+		case strus::ModuleLoaderInterface::LoadEager: return "eager";
+		case strus::ModuleLoaderInterface::LoadLazy: return "lazy";
+		case strus::ModuleLoaderInterface::LoadDeferred: return "deferred";
+	}
+	return "";
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		int nofRuns = 20;
+		std::vector<strus::ModuleLoaderInterface::LoadMode> modes;
+
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--runs") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --runs / -n");
+				nofRuns = std::atoi( argv[argi]);
+				if (nofRuns <= 0) throw std::runtime_error( "positive number expected as argument of option --runs / -n");
+			}
+			else if (0==std::strcmp( argv[argi], "--mode") || 0==std::strcmp( argv[argi], "-m"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --mode / -m");
+				if (0==std::strcmp( argv[argi], "eager")) modes.push_back( strus::ModuleLoaderInterface::LoadEager);
+				else if (0==std::strcmp( argv[argi], "lazy")) modes.push_back( strus::ModuleLoaderInterface::LoadLazy);
+				else if (0==std::strcmp( argv[argi], "deferred")) modes.push_back( strus::ModuleLoaderInterface::LoadDeferred);
+				else throw std::runtime_error( "unknown load mode (expected one of eager,lazy,deferred)");
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				return 0;
+			}
+			else if (0==std::strcmp( argv[argi], "--"))
+			{
+				argi++;
+				break;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				return 1;
+			}
+		}
+		if (argi == argc)
+		{
+			std::cerr << "Too few arguments" << std::endl;
+			printUsage();
+			return 1;
+		}
+		std::vector<std::string> modnames( argv+argi, argv+argc);
+		if (modes.empty())
+		{
+			modes.push_back( strus::ModuleLoaderInterface::LoadEager);
+			modes.push_back( strus::ModuleLoaderInterface::LoadLazy);
+			modes.push_back( strus::ModuleLoaderInterface::LoadDeferred);
+		}
+		std::cout << "mode\truns\tload min ms\tload median ms\tbuilder min ms\tbuilder median ms" << std::endl;
+		std::vector<strus::ModuleLoaderInterface::LoadMode>::const_iterator oi = modes.begin(), oe = modes.end();
+		for (; oi != oe; ++oi)
+		{
+			std::vector<double> loadTimes;
+			std::vector<double> builderTimes;
+			for (int ri=0; ri < nofRuns; ++ri)
+			{
+				RunResult result;
+				if (!strus::benchmark::runInChildProcess( result, LoadRun( *oi, modnames)))
+				{
+					throw std::runtime_error( std::string("run failed in load mode ") + modeName( *oi));
+				}
+				loadTimes.push_back( result.loadTime);
+				builderTimes.push_back( result.builderTime);
+			}
+			char line[ 256];
+			std::snprintf( line, sizeof(line), "%s\t%d\t%.3f\t%.3f\t%.3f\t%.3f",
+					modeName( *oi), nofRuns,
+					minimum( loadTimes) * 1000, median( loadTimes) * 1000,
+					minimum( builderTimes) * 1000, median( builderTimes) * 1000);
+			std::cout << line << std::endl;
+		}
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error in benchmark: " << err.what() << std::endl;
+		return -1;
+	}
+}
+
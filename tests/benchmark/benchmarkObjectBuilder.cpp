@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "testModuleDirectory.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "benchmarkUtils.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+
+static void printUsage()
+{
+	std::cerr << "benchmarkObjectBuilder [options] <modulename> { <modulename> }" << std::endl;
+	std::cerr << "Measures the time for creating storage and analyzer object builders with the modules listed loaded," << std::endl;
+	std::cerr << "with and without builder caching enabled in the module loader." << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--count <N>     :number of builders created per measurement (default 100)" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+}
+
+enum BuilderType {StorageBuilder, AnalyzerBuilder};
+
+static const char* builderTypeName( BuilderType type)
+{
+	return type == StorageBuilder ? "storage" : "analyzer";
+}
+
+static double measureBuilderCreation( strus::ModuleLoaderInterface* modloader, BuilderType type, int count)
+{
+	double start = strus::benchmark::getTimeSeconds();
+	for (int ii=0; ii < count; ++ii)
+	{
+		if (type == StorageBuilder)
+		{
+			strus::local_ptr<strus::StorageObjectBuilderInterface> builder( modloader->createStorageObjectBuilder());
+			if (!builder.get()) throw std::runtime_error( "failed to create storage object builder");
+		}
+		else
+		{
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+			if (!builder.get()) throw std::runtime_error( "failed to create analyzer object builder");
+		}
+	}
+	return (strus::benchmark::getTimeSeconds() - start) / count;
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		int count = 100;
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--count") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --count / -n");
+				count = std::atoi( argv[argi]);
+				if (count <= 0) throw std::runtime_error( "positive number expected as argument of option --count / -n");
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				return 0;
+			}
+			else if (0==std::strcmp( argv[argi], "--"))
+			{
+				argi++;
+				break;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				return 1;
+			}
+		}
+		strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, NULL));
+		if (!errorbuf.get()) throw std::runtime_error( "failed to create error buffer");
+		strus::local_ptr<strus::ModuleLoaderInterface> modloader( strus::createModuleLoader( errorbuf.get()));
+		if (!modloader.get()) throw std::runtime_error( "failed to create module loader");
+		modloader->addModulePath( STRUS_TEST_MODULE_DIRECTORY);
+
+		std::vector<std::string> modnames( argv+argi, argv+argc);
+		if (!modnames.empty() && !modloader->loadModules( modnames))
+		{
+			throw std::runtime_error( errorbuf->fetchError());
+		}
+		std::cout << "modules\tbuilder\tcount\tuncached ms\tcached ms" << std::endl;
+		BuilderType types[2] = {StorageBuilder, AnalyzerBuilder};
+		for (int ti=0; ti < 2; ++ti)
+		{
+			modloader->defineBuilderCaching( false);
+			double uncached = measureBuilderCreation( modloader.get(), types[ti], count);
+			modloader->defineBuilderCaching( true);
+			double cached = measureBuilderCreation( modloader.get(), types[ti], count);
+
+			char line[ 256];
+			std::snprintf( line, sizeof(line), "%d\t%s\t%d\t%.4f\t%.4f",
+					(int)modnames.size(), builderTypeName( types[ti]), count,
+					uncached * 1000, cached * 1000);
+			std::cout << line << std::endl;
+		}
+		if (errorbuf->hasError())
+		{
+			throw std::runtime_error( errorbuf->fetchError());
+		}
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error in benchmark: " << err.what() << std::endl;
+		return -1;
+	}
+}
+
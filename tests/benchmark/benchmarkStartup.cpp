@@ -0,0 +1,282 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+#include "strus/lib/module.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/moduleLoaderInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/traceObjectBuilderInterface.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "testModuleDirectory.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "benchmarkUtils.hpp"
+#include <memory>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <cmath>
+
+static void printUsage()
+{
+	std::cerr << "benchmarkStartup [options]" << std::endl;
+	std::cerr << "Measures the startup of a process creating a module loader, loading synthetic modules" << std::endl;
+	std::cerr << "found in one of a list of search paths and creating the object builders." << std::endl;
+	std::cerr << "Every run is done in a new process, because a module stays mapped in the process once it is loaded." << std::endl;
+	std::cerr << "Prints one tab separated line with the statistics in milliseconds per operation, number of modules and number of paths." << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--runs <N>      :number of runs per measurement (default 10)" << std::endl;
+	std::cerr << "       -N|--modules <N>   :maximum number of modules loaded (default " << STRUS_SYNTHETIC_MODULE_COUNT << ")" << std::endl;
+	std::cerr << "       -M|--paths <N>     :maximum number of search paths (default " << STRUS_SYNTHETIC_PATH_COUNT << ")" << std::endl;
+	std::cerr << "       -t|--trace <CFG>   :configuration of the trace object builder created (default \"log=count\")" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+}
+
+enum Operation
+{
+	CreateModuleLoader,
+	LoadModules,
+	CreateStorageObjectBuilder,
+	CreateAnalyzerObjectBuilder,
+	CreateTraceObjectBuilder,
+	NofOperations
+};
+
+static const char* operationName( int op)
+{
+	static const char* ar[ NofOperations] = {"createModuleLoader","loadModule","createStorageObjectBuilder","createAnalyzerObjectBuilder","createTraceObjectBuilder"};
+	return ar[ op];
+}
+
+struct RunResult
+{
+	double time[ NofOperations];	///< seconds spent per operation
+
+	RunResult()
+	{
+		std::fill( time, time + NofOperations, 0.0);
+	}
+};
+
+static std::string syntheticPath( int pathidx, int nofPaths)
+{
+	// ... the modules are only in the last path, the paths before are empty
+	char buf[ 64];
+	if (pathidx == nofPaths-1)
+	{
+		std::snprintf( buf, sizeof(buf), "/modules");
+	}
+	else
+	{
+		std::snprintf( buf, sizeof(buf), "/path%d", pathidx+1);
+	}
+	return std::string( STRUS_SYNTHETIC_MODULE_DIRECTORY) + buf;
+}
+
+static bool runStartup( RunResult& result, int nofModules, int nofPaths, const std::string& traceConfig)
+{
+	strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, NULL));
+	if (!errorbuf.get()) return false;
+
+	double start = strus::benchmark::getTimeSeconds();
+	strus::local_ptr<strus::ModuleLoaderInterface> modloader( strus::createModuleLoader( errorbuf.get()));
+	if (!modloader.get()) return false;
+	double end = strus::benchmark::getTimeSeconds();
+	result.time[ CreateModuleLoader] = end - start;
+
+	for (int pi=0; pi < nofPaths; ++pi)
+	{
+		modloader->addModulePath( syntheticPath( pi, nofPaths));
+	}
+	start = strus::benchmark::getTimeSeconds();
+	for (int mi=0; mi < nofModules; ++mi)
+	{
+		char modname[ 64];
+		std::snprintf( modname, sizeof(modname), "synthetic_%d", mi+1);
+		if (!modloader->loadModule( modname)) return false;
+	}
+	end = strus::benchmark::getTimeSeconds();
+	result.time[ LoadModules] = end - start;
+
+	start = end;
+	strus::local_ptr<strus::StorageObjectBuilderInterface> storageBuilder( modloader->createStorageObjectBuilder());
+	if (!storageBuilder.get()) return false;
+	end = strus::benchmark::getTimeSeconds();
+	result.time[ CreateStorageObjectBuilder] = end - start;
+
+	start = end;
+	strus::local_ptr<strus::AnalyzerObjectBuilderInterface> analyzerBuilder( modloader->createAnalyzerObjectBuilder());
+	if (!analyzerBuilder.get()) return false;
+	end = strus::benchmark::getTimeSeconds();
+	result.time[ CreateAnalyzerObjectBuilder] = end - start;
+
+	start = end;
+	strus::local_ptr<strus::TraceObjectBuilderInterface> traceBuilder( modloader->createTraceObjectBuilder( traceConfig));
+	if (!traceBuilder.get()) return false;
+	end = strus::benchmark::getTimeSeconds();
+	result.time[ CreateTraceObjectBuilder] = end - start;
+
+	return !errorbuf->hasError();
+}
+
+/// \brief Run of runStartup in a child process
+struct StartupRun
+{
+	int nofModules;
+	int nofPaths;
+	const std::string* traceConfig;
+
+	StartupRun( int nofModules_, int nofPaths_, const std::string& traceConfig_)
+		:nofModules(nofModules_),nofPaths(nofPaths_),traceConfig(&traceConfig_){}
+	StartupRun( const StartupRun& o)
+		:nofModules(o.nofModules),nofPaths(o.nofPaths),traceConfig(o.traceConfig){}
+
+	bool operator()( RunResult& result) const
+	{
+		return runStartup( result, nofModules, nofPaths, *traceConfig);
+	}
+};
+
+/// \brief Statistics of a series of measurements in milliseconds
+struct Statistics
+{
+	double min;
+	double median;
+	double mean;
+	double stddev;
+
+	explicit Statistics( std::vector<double> ar)
+		:min(0.0),median(0.0),mean(0.0),stddev(0.0)
+	{
+		if (ar.empty()) return;
+		std::sort( ar.begin(), ar.end());
+		min = ar[0] * 1000;
+		median = ar[ ar.size() / 2] * 1000;
+		double sum = 0.0;
+		std::vector<double>::const_iterator ai = ar.begin(), ae = ar.end();
+		for (; ai != ae; ++ai) sum += *ai * 1000;
+		mean = sum / ar.size();
+		double sqsum = 0.0;
+		for (ai = ar.begin(); ai != ae; ++ai) sqsum += (*ai * 1000 - mean) * (*ai * 1000 - mean);
+		stddev = ar.size() > 1 ? std::sqrt( sqsum / (ar.size()-1)) : 0.0;
+	}
+};
+
+static std::vector<int> measurementSteps( int maximum)
+{
+	// ... 1,2,4,8,.. and the maximum
+	std::vector<int> rt;
+	int step = 1;
+	for (; step < maximum; step *= 2) rt.push_back( step);
+	rt.push_back( maximum);
+	return rt;
+}
+
+static int parsePositiveNumber( const char* arg, const char* optname)
+{
+	if (!arg) throw std::runtime_error( std::string("missing argument for option ") + optname);
+	int rt = std::atoi( arg);
+	if (rt <= 0) throw std::runtime_error( std::string("positive number expected as argument of option ") + optname);
+	return rt;
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		int nofRuns = 10;
+		int maxModules = STRUS_SYNTHETIC_MODULE_COUNT;
+		int maxPaths = STRUS_SYNTHETIC_PATH_COUNT;
+		std::string traceConfig = "log=count";
+
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--runs") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				nofRuns = parsePositiveNumber( argv[++argi], "--runs / -n");
+			}
+			else if (0==std::strcmp( argv[argi], "--modules") || 0==std::strcmp( argv[argi], "-N"))
+			{
+				maxModules = parsePositiveNumber( argv[++argi], "--modules / -N");
+				if (maxModules > STRUS_SYNTHETIC_MODULE_COUNT) throw std::runtime_error( "more modules requested than synthetic modules generated (STRUS_SYNTHETIC_MODULE_COUNT)");
+			}
+			else if (0==std::strcmp( argv[argi], "--paths") || 0==std::strcmp( argv[argi], "-M"))
+			{
+				maxPaths = parsePositiveNumber( argv[++argi], "--paths / -M");
+				if (maxPaths > STRUS_SYNTHETIC_PATH_COUNT) throw std::runtime_error( "more paths requested than synthetic paths generated (STRUS_SYNTHETIC_PATH_COUNT)");
+			}
+			else if (0==std::strcmp( argv[argi], "--trace") || 0==std::strcmp( argv[argi], "-t"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --trace / -t");
+				traceConfig = argv[argi];
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				return 0;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				return 1;
+			}
+		}
+		if (argi != argc)
+		{
+			std::cerr << "Too many arguments" << std::endl;
+			printUsage();
+			return 1;
+		}
+		std::cout << "operation\tmodules\tpaths\truns\tmin ms\tmedian ms\tmean ms\tstddev ms" << std::endl;
+		std::vector<int> moduleSteps = measurementSteps( maxModules);
+		std::vector<int> pathSteps = measurementSteps( maxPaths);
+		std::vector<int>::const_iterator mi = moduleSteps.begin(), me = moduleSteps.end();
+		for (; mi != me; ++mi)
+		{
+			std::vector<int>::const_iterator pi = pathSteps.begin(), pe = pathSteps.end();
+			for (; pi != pe; ++pi)
+			{
+				std::vector<double> times[ NofOperations];
+				for (int ri=0; ri < nofRuns; ++ri)
+				{
+					RunResult result;
+					if (!strus::benchmark::runInChildProcess( result, StartupRun( *mi, *pi, traceConfig)))
+					{
+						throw std::runtime_error( "run failed, see the errors reported by the child process");
+					}
+					for (int oi=0; oi < NofOperations; ++oi)
+					{
+						times[ oi].push_back( result.time[ oi]);
+					}
+				}
+				for (int oi=0; oi < NofOperations; ++oi)
+				{
+					Statistics stats( times[ oi]);
+					char line[ 256];
+					std::snprintf( line, sizeof(line), "%s\t%d\t%d\t%d\t%.4f\t%.4f\t%.4f\t%.4f",
+							operationName( oi), *mi, *pi, nofRuns,
+							stats.min, stats.median, stats.mean, stats.stddev);
+					std::cout << line << std::endl;
+				}
+			}
+		}
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error in benchmark: " << err.what() << std::endl;
+		return -1;
+	}
+}
+
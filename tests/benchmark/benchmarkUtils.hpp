@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+/// \brief Helpers shared by the benchmark programs
+/// \file benchmarkUtils.hpp
+#ifndef _STRUS_MODULE_BENCHMARK_UTILS_HPP_INCLUDED
+#define _STRUS_MODULE_BENCHMARK_UTILS_HPP_INCLUDED
+#include <stdexcept>
+#include <ctime>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+namespace strus {
+namespace benchmark {
+
+/// \brief Get a monotonic time stamp in seconds
+inline double getTimeSeconds()
+{
+	struct timespec ts;
+	::clock_gettime( CLOCK_MONOTONIC, &ts);
+	return (double)ts.tv_sec + (double)ts.tv_nsec / 1e9;
+}
+
+/// \brief Do a run in a forked child process, so that every run starts with a fresh process without modules loaded
+/// \param[out] result result of the run, passed from the child process through a pipe as plain memory
+/// \param[in] run function object with a method 'bool operator()( Result& result) const' doing the run
+/// \return true if the run succeeded in the child process and its result has been received
+template <class Result, class Run>
+bool runInChildProcess( Result& result, const Run& run)
+{
+	int fd[2];
+	if (0!=::pipe( fd)) throw std::runtime_error( "failed to create pipe");
+	pid_t pid = ::fork();
+	if (pid < 0) throw std::runtime_error( "failed to fork");
+	if (pid == 0)
+	{
+		::close( fd[0]);
+		Result childResult;
+		bool success = run( childResult);
+		if (success && (ssize_t)sizeof(childResult) != ::write( fd[1], &childResult, sizeof(childResult)))
+		{
+			success = false;
+		}
+		::close( fd[1]);
+		::_exit( success ? 0 : 1);
+	}
+	::close( fd[1]);
+	bool rt = ((ssize_t)sizeof(result) == ::read( fd[0], &result, sizeof(result)));
+	::close( fd[0]);
+	int status = 0;
+	::waitpid( pid, &status, 0);
+	return rt && WIFEXITED( status) && WEXITSTATUS( status) == 0;
+}
+
+}}//namespace
+#endif
+
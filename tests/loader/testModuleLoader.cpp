@@ -8,30 +8,217 @@
 #include "strus/lib/module.hpp"
 #include "strus/lib/error.hpp"
 #include "strus/moduleLoaderInterface.hpp"
+#include "strus/analyzerObjectBuilderInterface.hpp"
+#include "strus/storageObjectBuilderInterface.hpp"
+#include "strus/traceObjectBuilderInterface.hpp"
+#include "strus/textProcessorInterface.hpp"
+#include "strus/normalizerFunctionInterface.hpp"
+#include "strus/normalizerFunctionInstanceInterface.hpp"
 #include "strus/errorBufferInterface.hpp"
 #include "strus/debugTraceInterface.hpp"
 #include "testModuleDirectory.hpp"
 #include "strus/base/local_ptr.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/thread.hpp"
 #include <memory>
 #include <string>
+#include <vector>
 #include <stdexcept>
 #include <iostream>
 #include <cstdio>
 #include <cstring>
 #include <cstdlib>
+#include <unistd.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <dlfcn.h>
+#include <link.h>
 
 static void printUsage()
 {
 	std::cerr << "testModuleLoader [options] <modulename>" << std::endl;
 	std::cerr << "Options:" << std::endl;
 	std::cerr << "       -G|--debug <ID>    :enable debug for <ID>" << std::endl;
+	std::cerr << "       -I|--index <FILE>  :use module index file <FILE> and check that it is written" << std::endl;
+	std::cerr << "       -X|--fromindex     :check that the modules loaded have been located by the module index read" << std::endl;
+	std::cerr << "       -D|--discovery     :discover the modules by reading the module directories" << std::endl;
+	std::cerr << "       -B|--batch         :load all modules with one call of loadModules" << std::endl;
+	std::cerr << "       -N|--normalizer <NAME> :check that normalizer <NAME> can be created after loading" << std::endl;
+	std::cerr << "       -L|--tracelogger <NAME> :check that trace logger <NAME> can be created after loading" << std::endl;
+	std::cerr << "       -Z|--tracecalls    :create the normalizers through an analyzer object builder traced with every trace logger and normalize a word" << std::endl;
+	std::cerr << "       -E|--conflict <MODULE> :check that loading module <MODULE> after the others fails" << std::endl;
+	std::cerr << "       -A|--absent <NAME> :check that normalizer <NAME> cannot be created after loading" << std::endl;
+	std::cerr << "       -C|--cache         :enable caching of object builders" << std::endl;
+	std::cerr << "       -P|--preload <FILE> :load the modules listed in the preload manifest <FILE> first" << std::endl;
+	std::cerr << "       -W|--manifest <FILE> :write the preload manifest <FILE> after loading" << std::endl;
+	std::cerr << "       -M|--metrics       :print and check the module load and constructor metrics at the end" << std::endl;
+	std::cerr << "       -m|--mode <MODE>   :load the modules in mode <MODE> (eager,lazy,deferred)" << std::endl;
+	std::cerr << "       -F|--fork          :prepare the loader, fork and do the lookups in the worker process activated" << std::endl;
+	std::cerr << "       -V|--resolved      :check that the function symbols of the modules are resolved before the lookups (in the worker with -F)" << std::endl;
+	std::cerr << "       -R|--reload <DIR>  :enable module reload with copies in <DIR>, replace the module files loaded and reload them" << std::endl;
+	std::cerr << "       -S|--static        :check that the modules loaded are linked statically into the executable" << std::endl;
+	std::cerr << "       -T|--threads <N>   :create object builders in <N> threads concurrently while loading the modules" << std::endl;
+	std::cerr << "       -U|--unload        :enable module unloading, unload the modules after the lookups and check that the builders created before still work" << std::endl;
 	std::cerr << "       -h|--help          :print this usage" << std::endl;
 }
 
+/// \brief Create normalizers through an analyzer object builder traced by a trace object builder and normalize a word with them
+static bool makeTracedCalls( const strus::ModuleLoaderInterface* modloader, const strus::TraceObjectBuilderInterface* traceBuilder, const std::vector<std::string>& normalizers)
+{
+	strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+	if (!builder.get()) return false;
+	strus::local_ptr<strus::AnalyzerObjectBuilderInterface> tracedBuilder( traceBuilder->createAnalyzerObjectBuilder( builder.get()));
+	if (!tracedBuilder.get()) return false;
+	// ... the builder traced is owned by the traced builder
+	(void)builder.release();
+	const strus::TextProcessorInterface* textproc = tracedBuilder->getTextProcessor();
+	if (!textproc) return false;
+	std::vector<std::string> args;
+	args.push_back( "en");
+	std::vector<std::string>::const_iterator ni = normalizers.begin(), ne = normalizers.end();
+	for (; ni != ne; ++ni)
+	{
+		const strus::NormalizerFunctionInterface* normalizer = textproc->getNormalizer( *ni);
+		if (!normalizer) return false;
+		strus::local_ptr<strus::NormalizerFunctionInstanceInterface> instance( normalizer->createInstance( args, textproc));
+		if (!instance.get()) return false;
+		std::string result = instance->normalize( "running", 7);
+		std::cerr << "traced normalizer '" << *ni << "' returned '" << result << "'" << std::endl;
+	}
+	return true;
+}
+
+// ... the load address of the module implementing the normalizer, found by the address of its virtual function table
+static const void* normalizerModuleBase( const strus::TextProcessorInterface* textproc, const std::string& name)
+{
+	const strus::NormalizerFunctionInterface* normalizer = textproc ? textproc->getNormalizer( name) : NULL;
+	if (!normalizer) return NULL;
+	Dl_info info;
+	if (!::dladdr( *reinterpret_cast<void* const*>( normalizer), &info)) return NULL;
+	std::vector<std::string> args;
+	args.push_back( "en");
+	strus::local_ptr<strus::NormalizerFunctionInstanceInterface> instance( normalizer->createInstance( args, textproc));
+	if (!instance.get() || instance->normalize( "running", 7).empty()) return NULL;
+	return info.dli_fbase;
+}
+
+// ... replace a file by a copy of itself with a new inode, like a deployment does
+static bool replaceFileByCopy( const std::string& path)
+{
+	std::string content;
+	std::string tmppath = path + ".tmp";
+	if (0!=strus::readFile( path, content)) return false;
+	if (0!=strus::writeFile( tmppath, content)) return false;
+	return 0==std::rename( tmppath.c_str(), path.c_str());
+}
+
+/// \brief Counter of the PLT slots of the modules opened that the dynamic linker has not resolved yet
+struct UnresolvedSymbolCount
+{
+	int nofModules;
+	int nofSlots;
+	int nofUnresolved;
+
+	UnresolvedSymbolCount()
+		:nofModules(0),nofSlots(0),nofUnresolved(0){}
+};
+
+// ... a slot not resolved yet points to the lazy binding stub in the PLT of the module itself, not to the start of a function
+static int countUnresolvedSymbols( struct dl_phdr_info* info, size_t, void* data)
+{
+	UnresolvedSymbolCount* cnt = (UnresolvedSymbolCount*)data;
+	if (!info->dlpi_name || !std::strstr( info->dlpi_name, "modstrus_")) return 0;
+	const ElfW(Dyn)* dyn = NULL;
+	for (int pi=0; pi < info->dlpi_phnum; ++pi)
+	{
+		if (info->dlpi_phdr[ pi].p_type == PT_DYNAMIC) dyn = (const ElfW(Dyn)*)(info->dlpi_addr + info->dlpi_phdr[ pi].p_vaddr);
+	}
+	Dl_info modinfo;
+	if (!dyn || !::dladdr( dyn, &modinfo)) return 0;
+	ElfW(Addr) jmprel = 0;
+	ElfW(Xword) pltrelsz = 0;
+	ElfW(Sxword) pltrel = DT_RELA;
+	for (; dyn->d_tag != DT_NULL; ++dyn)
+	{
+		if (dyn->d_tag == DT_JMPREL) jmprel = dyn->d_un.d_ptr;
+		else if (dyn->d_tag == DT_PLTRELSZ) pltrelsz = dyn->d_un.d_val;
+		else if (dyn->d_tag == DT_PLTREL) pltrel = dyn->d_un.d_val;
+	}
+	++cnt->nofModules;
+	if (!jmprel) return 0;
+	// ... the dynamic linker relocates the addresses in the dynamic section on most platforms
+	if (jmprel < info->dlpi_addr) jmprel += info->dlpi_addr;
+	std::size_t relsize = (pltrel == DT_RELA) ? sizeof(ElfW(Rela)) : sizeof(ElfW(Rel));
+	for (std::size_t ofs = 0; ofs < pltrelsz; ofs += relsize)
+	{
+		// ... r_offset is the first member of both, ElfW(Rel) and ElfW(Rela)
+		const ElfW(Rel)* rel = (const ElfW(Rel)*)(jmprel + ofs);
+		void* target = *(void**)(info->dlpi_addr + rel->r_offset);
+		Dl_info targetinfo;
+		++cnt->nofSlots;
+		if (::dladdr( target, &targetinfo) && targetinfo.dli_fbase == modinfo.dli_fbase && targetinfo.dli_saddr != target)
+		{
+			++cnt->nofUnresolved;
+		}
+	}
+	return 0;
+}
+
+static bool checkSymbolsResolved()
+{
+	UnresolvedSymbolCount cnt;
+	::dl_iterate_phdr( &countUnresolvedSymbols, &cnt);
+	std::cerr << "modules opened " << cnt.nofModules << ", PLT slots " << cnt.nofSlots << ", not resolved " << cnt.nofUnresolved << std::endl;
+	return cnt.nofModules > 0 && cnt.nofUnresolved == 0;
+}
+
+#define MaxNofThreads 8
+
+/// \brief Object builders created concurrently to the loading of modules
+struct ConcurrentBuilderCreation
+{
+	const strus::ModuleLoaderInterface* loader;
+	strus::mutex mutex;
+	bool stop;
+	int nofCreated;
+	int nofFailed;
+
+	explicit ConcurrentBuilderCreation( const strus::ModuleLoaderInterface* loader_)
+		:loader(loader_),mutex(),stop(false),nofCreated(0),nofFailed(0){}
+
+	void run()
+	{
+		for (;;)
+		{
+			strus::local_ptr<strus::StorageObjectBuilderInterface> storageBuilder( loader->createStorageObjectBuilder());
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> analyzerBuilder( loader->createAnalyzerObjectBuilder());
+			strus::scoped_lock lock( mutex);
+			if (storageBuilder.get() && analyzerBuilder.get()) ++nofCreated; else ++nofFailed;
+			if (stop) return;
+		}
+	}
+};
+
+/// \brief Thread function object of a builder creation worker
+struct BuilderCreationWorker
+{
+	explicit BuilderCreationWorker( ConcurrentBuilderCreation* ctx_)
+		:ctx(ctx_){}
+	BuilderCreationWorker( const BuilderCreationWorker& o)
+		:ctx(o.ctx){}
+
+	void operator()()
+	{
+		ctx->run();
+	}
+
+	ConcurrentBuilderCreation* ctx;
+};
+
 int main( int argc, const char** argv)
 {
 	strus::DebugTraceInterface* dbgtrace = strus::createDebugTrace_standard( 2);
-	strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, 1, dbgtrace));
+	strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, MaxNofThreads, dbgtrace));
 	if (!errorbuf.get())
 	{
 		std::cerr << "error creating error buffer" << std::endl;
@@ -46,6 +233,24 @@ int main( int argc, const char** argv)
 	std::cerr << "setting load module path to '" << STRUS_TEST_MODULE_DIRECTORY << "'" << std::endl;
 	modloader->addModulePath( STRUS_TEST_MODULE_DIRECTORY);
 
+	bool batch = false;
+	const char* preloadManifest = NULL;
+	const char* writeManifest = NULL;
+	bool forkWorker = false;
+	bool cacheBuilders = false;
+	bool checkResolved = false;
+	const char* reloadCopyDirectory = NULL;
+	bool printMetrics = false;
+	bool unload = false;
+	int nofThreads = 0;
+	bool checkStatic = false;
+	const char* indexFile = NULL;
+	bool checkFromIndex = false;
+	std::vector<std::string> normalizers;
+	std::vector<std::string> traceLoggers;
+	bool traceCalls = false;
+	std::vector<std::string> conflictModules;
+	std::vector<std::string> absentNormalizers;
 	int argi = 1;
 	for (; argi < argc && argv[argi][0] == '-'; ++argi)
 	{
@@ -54,6 +259,103 @@ int main( int argc, const char** argv)
 			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --debug / -G");
 			if (!dbgtrace->enable( argv[argi])) throw std::runtime_error( "failed to enable debug");
 		}
+		else if (0==std::strcmp( argv[argi], "--index") || 0==std::strcmp( argv[argi], "-I"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --index / -I");
+			indexFile = argv[argi];
+			modloader->defineModuleIndexFile( indexFile);
+		}
+		else if (0==std::strcmp( argv[argi], "--fromindex") || 0==std::strcmp( argv[argi], "-X"))
+		{
+			checkFromIndex = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--discovery") || 0==std::strcmp( argv[argi], "-D"))
+		{
+			modloader->defineModuleDiscovery( true);
+		}
+		else if (0==std::strcmp( argv[argi], "--batch") || 0==std::strcmp( argv[argi], "-B"))
+		{
+			batch = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--normalizer") || 0==std::strcmp( argv[argi], "-N"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --normalizer / -N");
+			normalizers.push_back( argv[argi]);
+		}
+		else if (0==std::strcmp( argv[argi], "--tracelogger") || 0==std::strcmp( argv[argi], "-L"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --tracelogger / -L");
+			traceLoggers.push_back( argv[argi]);
+		}
+		else if (0==std::strcmp( argv[argi], "--tracecalls") || 0==std::strcmp( argv[argi], "-Z"))
+		{
+			traceCalls = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--conflict") || 0==std::strcmp( argv[argi], "-E"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --conflict / -E");
+			conflictModules.push_back( argv[argi]);
+		}
+		else if (0==std::strcmp( argv[argi], "--absent") || 0==std::strcmp( argv[argi], "-A"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --absent / -A");
+			absentNormalizers.push_back( argv[argi]);
+		}
+		else if (0==std::strcmp( argv[argi], "--cache") || 0==std::strcmp( argv[argi], "-C"))
+		{
+			modloader->defineBuilderCaching( true);
+			cacheBuilders = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--preload") || 0==std::strcmp( argv[argi], "-P"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --preload / -P");
+			preloadManifest = argv[argi];
+		}
+		else if (0==std::strcmp( argv[argi], "--manifest") || 0==std::strcmp( argv[argi], "-W"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --manifest / -W");
+			writeManifest = argv[argi];
+		}
+		else if (0==std::strcmp( argv[argi], "--metrics") || 0==std::strcmp( argv[argi], "-M"))
+		{
+			printMetrics = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--mode") || 0==std::strcmp( argv[argi], "-m"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --mode / -m");
+			if (0==std::strcmp( argv[argi], "eager")) modloader->defineLoadMode( strus::ModuleLoaderInterface::LoadEager);
+			else if (0==std::strcmp( argv[argi], "lazy")) modloader->defineLoadMode( strus::ModuleLoaderInterface::LoadLazy);
+			else if (0==std::strcmp( argv[argi], "deferred")) modloader->defineLoadMode( strus::ModuleLoaderInterface::LoadDeferred);
+			else throw std::runtime_error( "unknown load mode in option --mode / -m");
+		}
+		else if (0==std::strcmp( argv[argi], "--fork") || 0==std::strcmp( argv[argi], "-F"))
+		{
+			forkWorker = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--resolved") || 0==std::strcmp( argv[argi], "-V"))
+		{
+			checkResolved = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--reload") || 0==std::strcmp( argv[argi], "-R"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --reload / -R");
+			reloadCopyDirectory = argv[argi];
+		}
+		else if (0==std::strcmp( argv[argi], "--static") || 0==std::strcmp( argv[argi], "-S"))
+		{
+			checkStatic = true;
+		}
+		else if (0==std::strcmp( argv[argi], "--threads") || 0==std::strcmp( argv[argi], "-T"))
+		{
+			if (!argv[++argi]) throw std::runtime_error( "missing argument for option --threads / -T");
+			nofThreads = std::atoi( argv[argi]);
+			if (nofThreads <= 0 || nofThreads >= MaxNofThreads) throw std::runtime_error( "number of threads out of range in option --threads / -T");
+		}
+		else if (0==std::strcmp( argv[argi], "--unload") || 0==std::strcmp( argv[argi], "-U"))
+		{
+			modloader->defineModuleUnloading( true);
+			unload = true;
+		}
 		else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
 		{
 			printUsage();
@@ -71,13 +373,44 @@ int main( int argc, const char** argv)
 			exit( 1);
 		}
 	}
-	if (argi == argc)
+	if (argi == argc && !preloadManifest)
 	{
 		std::cerr << "Too few arguments" << std::endl;
 		printUsage();
 		exit( 1);
 	}
-	int ai = argi, ae = argc;
+	if (preloadManifest)
+	{
+		std::cerr << "loading modules of preload manifest '" << preloadManifest << "'" << std::endl;
+		if (modloader->loadPreloadManifest( preloadManifest))
+		{
+			std::cerr << "ok." << std::endl;
+		}
+		else
+		{
+			std::cerr << "failed." << std::endl;
+		}
+	}
+	ConcurrentBuilderCreation concurrentCreation( modloader.get());
+	std::vector<strus::thread*> threads;
+	for (int ti=0; ti < nofThreads; ++ti)
+	{
+		threads.push_back( new strus::thread( BuilderCreationWorker( &concurrentCreation)));
+	}
+	if (batch)
+	{
+		std::vector<std::string> modnames( argv+argi, argv+argc);
+		std::cerr << "loading " << modnames.size() << " modules in batch" << std::endl;
+		if (modloader->loadModules( modnames))
+		{
+			std::cerr << "ok." << std::endl;
+		}
+		else
+		{
+			std::cerr << "failed." << std::endl;
+		}
+	}
+	int ai = argi, ae = batch ? argi : argc;
 	for (; ai != ae; ++ai)
 	{
 		std::cerr << "loading module '" << argv[ai] << "'" << std::endl;
@@ -100,6 +433,347 @@ int main( int argc, const char** argv)
 	{
 		std::cerr << "no modules loaded." << std::endl;
 	}
+	std::vector<std::string>::const_iterator ci = conflictModules.begin(), ce = conflictModules.end();
+	for (; ci != ce; ++ci)
+	{
+		std::cerr << "loading conflicting module '" << *ci << "'" << std::endl;
+		if (modloader->loadModule( *ci))
+		{
+			std::cerr << "failed, module loaded." << std::endl;
+			return -1;
+		}
+		std::cerr << "rejected: " << errorbuf->fetchError() << std::endl;
+	}
+	if (nofThreads)
+	{
+		{
+			strus::scoped_lock lock( concurrentCreation.mutex);
+			concurrentCreation.stop = true;
+		}
+		std::vector<strus::thread*>::iterator ti = threads.begin(), te = threads.end();
+		for (; ti != te; ++ti)
+		{
+			(*ti)->join();
+			delete *ti;
+		}
+		std::cerr << "created " << concurrentCreation.nofCreated << " object builders in " << nofThreads << " threads concurrently" << std::endl;
+		if (concurrentCreation.nofFailed)
+		{
+			std::cerr << "failed to create " << concurrentCreation.nofFailed << " object builders concurrently" << std::endl;
+			return -1;
+		}
+	}
+	if (checkStatic)
+	{
+		std::vector<strus::ModuleLoadMetrics> loaded = modloader->moduleLoadMetrics();
+		std::vector<strus::ModuleLoadMetrics>::const_iterator li = loaded.begin(), le = loaded.end();
+		for (; li != le; ++li)
+		{
+			std::cerr << "module '" << li->name << "' loaded from '" << li->path << "'" << std::endl;
+			if (0!=std::strncmp( li->path.c_str(), "static:", 7))
+			{
+				std::cerr << "module not linked statically" << std::endl;
+				return -1;
+			}
+		}
+	}
+	if (indexFile && !strus::isFile( indexFile))
+	{
+		std::cerr << "module index file '" << indexFile << "' has not been written" << std::endl;
+		return -1;
+	}
+	if (checkFromIndex)
+	{
+		std::vector<strus::ModuleLoadMetrics> loaded = modloader->moduleLoadMetrics();
+		std::vector<strus::ModuleLoadMetrics>::const_iterator li = loaded.begin(), le = loaded.end();
+		for (; li != le; ++li)
+		{
+			std::cerr << "module '" << li->name << "' loaded from '" << li->path << "'" << (li->fromIndex ? " located by the module index" : "") << std::endl;
+			if (!li->fromIndex)
+			{
+				std::cerr << "module not located by the module index" << std::endl;
+				return -1;
+			}
+		}
+		if (loaded.empty())
+		{
+			std::cerr << "no modules loaded" << std::endl;
+			return -1;
+		}
+	}
+	if (writeManifest)
+	{
+		std::cerr << "writing preload manifest '" << writeManifest << "'" << std::endl;
+		if (!modloader->writePreloadManifest( writeManifest))
+		{
+			std::cerr << "failed." << std::endl;
+		}
+	}
+	if (reloadCopyDirectory)
+	{
+		std::cerr << "enable module reload with copies in '" << reloadCopyDirectory << "'" << std::endl;
+		if (!modloader->enableModuleReload( reloadCopyDirectory))
+		{
+			std::cerr << "failed." << std::endl;
+		}
+		else
+		{
+			// ... a builder created before the reload keeps the version it was created with, also for the functions it creates after the reload
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builderResolvedBefore( modloader->createAnalyzerObjectBuilder());
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builderCreatedBefore( modloader->createAnalyzerObjectBuilder());
+			if (!builderResolvedBefore.get() || !builderCreatedBefore.get())
+			{
+				std::cerr << "failed to create the builders before the reload" << std::endl;
+				return -1;
+			}
+			std::vector<const void*> oldModuleBases;
+			std::vector<std::string>::const_iterator ri = normalizers.begin(), re = normalizers.end();
+			for (; ri != re; ++ri)
+			{
+				oldModuleBases.push_back( normalizerModuleBase( builderResolvedBefore->getTextProcessor(), *ri));
+				if (!oldModuleBases.back())
+				{
+					std::cerr << "failed to get normalizer '" << *ri << "' before the reload" << std::endl;
+					return -1;
+				}
+			}
+			std::vector<strus::ModuleLoadMetrics> loaded = modloader->moduleLoadMetrics();
+			std::vector<strus::ModuleLoadMetrics>::const_iterator li = loaded.begin(), le = loaded.end();
+			for (; li != le; ++li)
+			{
+				std::cerr << "replace module file '" << li->path << "'" << std::endl;
+				if (!replaceFileByCopy( li->path))
+				{
+					std::cerr << "failed." << std::endl;
+					return -1;
+				}
+			}
+			int nofReloaded = modloader->reloadChangedModules();
+			std::cerr << "reloaded " << nofReloaded << " modules" << std::endl;
+			if (nofReloaded <= 0)
+			{
+				std::cerr << "failed." << std::endl;
+				return -1;
+			}
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builderCreatedAfter( modloader->createAnalyzerObjectBuilder());
+			if (!builderCreatedAfter.get())
+			{
+				std::cerr << "failed to create a builder after the reload" << std::endl;
+				return -1;
+			}
+			std::vector<const void*>::const_iterator bi = oldModuleBases.begin();
+			for (ri = normalizers.begin(); ri != re; ++ri,++bi)
+			{
+				std::cerr << "get normalizer '" << *ri << "' with builders created before and after the reload" << std::endl;
+				if (normalizerModuleBase( builderResolvedBefore->getTextProcessor(), *ri) != *bi
+					|| normalizerModuleBase( builderCreatedBefore->getTextProcessor(), *ri) != *bi)
+				{
+					std::cerr << "failed, builder created before the reload does not use the version replaced." << std::endl;
+					return -1;
+				}
+				const void* newModuleBase = normalizerModuleBase( builderCreatedAfter->getTextProcessor(), *ri);
+				if (!newModuleBase || newModuleBase == *bi)
+				{
+					std::cerr << "failed, builder created after the reload does not use the version reloaded." << std::endl;
+					return -1;
+				}
+			}
+		}
+	}
+	if (forkWorker)
+	{
+		std::cerr << "prepare module loader for fork" << std::endl;
+		if (!modloader->prepare())
+		{
+			std::cerr << "failed." << std::endl;
+		}
+		else
+		{
+			// ... with caching, the builder used by the worker has to be the one built by prepare in the parent process
+			const strus::TextProcessorInterface* preparedTextProcessor = NULL;
+			strus::local_ptr<strus::AnalyzerObjectBuilderInterface> preparedBuilder;
+			if (cacheBuilders)
+			{
+				preparedBuilder.reset( modloader->createAnalyzerObjectBuilder());
+				preparedTextProcessor = preparedBuilder.get() ? preparedBuilder->getTextProcessor() : NULL;
+				if (!preparedTextProcessor)
+				{
+					std::cerr << "failed to get the text processor of the builder prepared" << std::endl;
+					return -1;
+				}
+			}
+			pid_t pid = ::fork();
+			if (pid < 0)
+			{
+				std::cerr << "error forking worker process" << std::endl;
+				return -1;
+			}
+			if (pid > 0)
+			{
+				int status = 0;
+				if (::waitpid( pid, &status, 0) < 0 || !WIFEXITED( status) || WEXITSTATUS( status) != 0)
+				{
+					std::cerr << "worker process failed" << std::endl;
+					return -1;
+				}
+				return 0;
+			}
+			std::cerr << "activate module loader in worker process" << std::endl;
+			if (!modloader->activate())
+			{
+				std::cerr << "failed." << std::endl;
+			}
+			else if (cacheBuilders)
+			{
+				strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+				if (!builder.get() || builder->getTextProcessor() != preparedTextProcessor)
+				{
+					std::cerr << "the worker does not use the builder prepared in the parent process" << std::endl;
+					return -1;
+				}
+			}
+		}
+	}
+	if (checkResolved)
+	{
+		std::cerr << "check that the function symbols of the modules are resolved" << std::endl;
+		if (!checkSymbolsResolved())
+		{
+			std::cerr << "failed." << std::endl;
+			return -1;
+		}
+	}
+	std::vector<std::string>::const_iterator ni = normalizers.begin(), ne = normalizers.end();
+	for (; ni != ne; ++ni)
+	{
+		// ... every lookup with its own builder to check a cached builder too
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+		const strus::TextProcessorInterface* textproc = builder.get() ? builder->getTextProcessor() : NULL;
+		std::cerr << "get normalizer '" << *ni << "'" << std::endl;
+		if (!textproc || !textproc->getNormalizer( *ni))
+		{
+			std::cerr << "failed." << std::endl;
+		}
+	}
+	std::vector<std::string>::const_iterator xi = absentNormalizers.begin(), xe = absentNormalizers.end();
+	for (; xi != xe; ++xi)
+	{
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+		const strus::TextProcessorInterface* textproc = builder.get() ? builder->getTextProcessor() : NULL;
+		std::cerr << "get normalizer '" << *xi << "' not defined" << std::endl;
+		if (!textproc || textproc->getNormalizer( *xi))
+		{
+			std::cerr << "failed, normalizer defined." << std::endl;
+			return -1;
+		}
+		(void)errorbuf->fetchError();
+	}
+	std::vector<std::string>::const_iterator ti = traceLoggers.begin(), te = traceLoggers.end();
+	for (; ti != te; ++ti)
+	{
+		std::cerr << "create trace object builder with logger '" << *ti << "'" << std::endl;
+		strus::local_ptr<strus::TraceObjectBuilderInterface> builder( modloader->createTraceObjectBuilder( std::string("log=") + *ti));
+		if (!builder.get())
+		{
+			std::cerr << "failed." << std::endl;
+		}
+		else if (traceCalls)
+		{
+			std::cerr << "make traced calls with logger '" << *ti << "'" << std::endl;
+			if (!makeTracedCalls( modloader.get(), builder.get(), normalizers))
+			{
+				std::cerr << "failed." << std::endl;
+				return -1;
+			}
+		}
+	}
+	if (unload)
+	{
+		// ... a builder created before unloading keeps the modules it uses loaded until it is deleted
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builder( modloader->createAnalyzerObjectBuilder());
+		const strus::TextProcessorInterface* textproc = builder.get() ? builder->getTextProcessor() : NULL;
+		if (!textproc)
+		{
+			std::cerr << "failed." << std::endl;
+			return -1;
+		}
+		for (int mi=argi; mi < argc; ++mi)
+		{
+			std::cerr << "unload module '" << argv[mi] << "'" << std::endl;
+			if (!modloader->unloadModule( argv[mi]))
+			{
+				std::cerr << "failed." << std::endl;
+			}
+		}
+		if (!modloader->modules().empty())
+		{
+			std::cerr << "modules still loaded after unloading them" << std::endl;
+			return -1;
+		}
+		for (ni = normalizers.begin(); ni != ne; ++ni)
+		{
+			std::cerr << "get normalizer '" << *ni << "' of module unloaded with builder created before" << std::endl;
+			if (!textproc->getNormalizer( *ni))
+			{
+				std::cerr << "failed." << std::endl;
+			}
+		}
+		strus::local_ptr<strus::AnalyzerObjectBuilderInterface> builderAfter( modloader->createAnalyzerObjectBuilder());
+		const strus::TextProcessorInterface* textprocAfter = builderAfter.get() ? builderAfter->getTextProcessor() : NULL;
+		for (ni = normalizers.begin(); textprocAfter && ni != ne; ++ni)
+		{
+			std::cerr << "get normalizer '" << *ni << "' of module unloaded with builder created after" << std::endl;
+			if (textprocAfter->getNormalizer( *ni))
+			{
+				std::cerr << "failed, normalizer still defined." << std::endl;
+				return -1;
+			}
+			(void)errorbuf->fetchError();
+		}
+	}
+	if (printMetrics)
+	{
+		std::vector<strus::ModuleLoadMetrics> loadMetrics = modloader->moduleLoadMetrics();
+		std::vector<strus::ModuleLoadMetrics>::const_iterator li = loadMetrics.begin(), le = loadMetrics.end();
+		for (; li != le; ++li)
+		{
+			std::fprintf( stderr, "module %s path '%s' probed %d stat %.6f open %.6f check %.6f memory %ld\n",
+					li->name.c_str(), li->path.c_str(), li->nofPathsProbed,
+					li->statTime, li->openTime, li->versionCheckTime, li->memoryDelta);
+			if (li->path.empty())
+			{
+				std::cerr << "no path in the load metrics of module '" << li->name << "'" << std::endl;
+				return -1;
+			}
+			if (li->openTime < 0.0 || li->versionCheckTime < 0.0)
+			{
+				std::cerr << "negative open or version check time in the load metrics of module '" << li->name << "'" << std::endl;
+				return -1;
+			}
+		}
+		if (loadMetrics.size() != modloader->modules().size())
+		{
+			std::cerr << "number of module load metrics does not match the number of modules loaded" << std::endl;
+			return -1;
+		}
+		std::vector<strus::ModuleConstructorMetrics> constructorMetrics = modloader->constructorMetrics();
+		std::vector<strus::ModuleConstructorMetrics>::const_iterator ci = constructorMetrics.begin(), ce = constructorMetrics.end();
+		for (; ci != ce; ++ci)
+		{
+			std::fprintf( stderr, "constructor %s %s created %d total %.6f max %.6f\n",
+					ci->kind.c_str(), ci->name.c_str(), ci->nofCreated, ci->createTime, ci->maxCreateTime);
+		}
+		// ... every normalizer requested has been created by the builder used to get it
+		for (ni = normalizers.begin(); ni != ne; ++ni)
+		{
+			for (ci = constructorMetrics.begin(); ci != ce && (ci->kind != "normalizer" || ci->name != *ni); ++ci){}
+			if (ci == ce || ci->nofCreated < 1)
+			{
+				std::cerr << "no constructor metrics of the normalizer '" << *ni << "' created" << std::endl;
+				return -1;
+			}
+		}
+	}
 	if (errorbuf->hasError())
 	{
 		std::cerr << "error testing module loader: " << errorbuf->fetchError() << std::endl;
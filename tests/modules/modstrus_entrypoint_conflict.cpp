@@ -0,0 +1,33 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+// Module with a table of entry points, the last one defining a trace logger of the module entrypoint_table with another implementation
+#include "strus/base/dll_tags.hpp"
+#include "strus/analyzerModule.hpp"
+#include "strus/traceModule.hpp"
+#include "strus/lib/normalizer_snowball.hpp"
+#include "strus/lib/traceproc_std.hpp"
+#include "strus/strus.hpp"
+
+static const strus::NormalizerConstructor normalizers[] =
+{
+	{"conflictstem", &strus::createNormalizer_snowball},
+	{0,0}
+};
+
+static const strus::TraceLoggerConstructor traceLoggers[] =
+{
+	{"tablecount", &strus::createTraceLogger_dump},
+	{0,0}
+};
+
+static strus::AnalyzerModule analyzerEntryPoint( 0, normalizers, 0);
+static strus::TraceModule traceEntryPoint( traceLoggers);
+
+extern "C" DLL_PUBLIC const strus::ModuleEntryPoint* entryPoints[];
+
+const strus::ModuleEntryPoint* entryPoints[] = {&analyzerEntryPoint, &traceEntryPoint, 0};
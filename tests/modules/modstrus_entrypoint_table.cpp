@@ -0,0 +1,37 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+// Module with a table of entry points of different types
+#include "strus/base/dll_tags.hpp"
+#include "strus/analyzerModule.hpp"
+#include "strus/traceModule.hpp"
+#include "strus/constructorTable.hpp"
+#include "strus/lib/normalizer_snowball.hpp"
+#include "strus/lib/traceproc_std.hpp"
+#include "strus/strus.hpp"
+
+static STRUS_CONSTRUCTOR_TABLE strus::NormalizerConstructor normalizers[] =
+{
+	{"tablestem", &strus::createNormalizer_snowball},
+	{"tablestem_snowball", &strus::createNormalizer_snowball},
+	{0,0}
+};
+STRUS_CONSTRUCTOR_TABLE_CHECK( normalizers);
+
+static const strus::TraceLoggerConstructor traceLoggers[] =
+{
+	{"tablecount", &strus::createTraceLogger_count},
+	{0,0}
+};
+
+static strus::AnalyzerModule analyzerEntryPoint( 0, normalizers, 0, strus::ModuleEntryPoint::FlagSortedConstructorTables);
+static strus::TraceModule traceEntryPoint( traceLoggers);
+
+extern "C" DLL_PUBLIC const strus::ModuleEntryPoint* entryPoints[];
+
+const strus::ModuleEntryPoint* entryPoints[] = {&analyzerEntryPoint, &traceEntryPoint, 0};
+
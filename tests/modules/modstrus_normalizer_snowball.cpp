@@ -7,18 +7,19 @@
  */
 #include "strus/base/dll_tags.hpp"
 #include "strus/analyzerModule.hpp"
+#include "strus/staticModule.hpp"
+#include "strus/constructorTable.hpp"
 #include "strus/lib/normalizer_snowball.hpp"
 #include "strus/strus.hpp"
 
-static const strus::NormalizerConstructor normalizers[] =
+static STRUS_CONSTRUCTOR_TABLE strus::NormalizerConstructor normalizers[] =
 {
 	{"stem", &strus::createNormalizer_snowball},
 	{0,0}	
 };
+STRUS_CONSTRUCTOR_TABLE_CHECK( normalizers);
 
-extern "C" DLL_PUBLIC strus::AnalyzerModule entryPoint;
-
-strus::AnalyzerModule entryPoint( 0, normalizers, 0);
+STRUS_MODULE_ENTRY_POINT( strus::AnalyzerModule, normalizer_snowball)( 0, normalizers, 0, strus::ModuleEntryPoint::FlagSortedConstructorTables);
 
 
 
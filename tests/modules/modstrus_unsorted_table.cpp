@@ -0,0 +1,23 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+// Module with a constructor table flagged as sorted that is not, as it can be declared without C++11 where the table is not validated at compile time
+#include "strus/base/dll_tags.hpp"
+#include "strus/analyzerModule.hpp"
+#include "strus/staticModule.hpp"
+#include "strus/lib/normalizer_snowball.hpp"
+#include "strus/strus.hpp"
+
+static const strus::NormalizerConstructor normalizers[] =
+{
+	{"unsortedstem", &strus::createNormalizer_snowball},
+	{"UnsortedLc", &strus::createNormalizer_snowball},
+	{"astem", &strus::createNormalizer_snowball},
+	{0,0}
+};
+
+STRUS_MODULE_ENTRY_POINT( strus::AnalyzerModule, unsorted_table)( 0, normalizers, 0, strus::ModuleEntryPoint::FlagSortedConstructorTables);
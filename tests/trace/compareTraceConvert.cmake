@@ -0,0 +1,14 @@
+# Convert a trace with strusTraceConvert and compare the output with the expected one
+# Variables: CONVERT (path of strusTraceConvert), FORMAT (output format), TRACE (trace file), EXPECTED (file with the expected output)
+execute_process(
+	COMMAND ${CONVERT} -f ${FORMAT} ${TRACE}
+	OUTPUT_VARIABLE output
+	RESULT_VARIABLE result
+)
+if( NOT result EQUAL 0 )
+	message( FATAL_ERROR "strusTraceConvert failed converting '${TRACE}': ${result}" )
+endif( NOT result EQUAL 0 )
+file( READ ${EXPECTED} expected )
+if( NOT output STREQUAL expected )
+	message( FATAL_ERROR "output of strusTraceConvert for '${TRACE}' differs from '${EXPECTED}':\n${output}" )
+endif( NOT output STREQUAL expected )
@@ -0,0 +1,621 @@
+/*
+ * Copyright (c) 2014 Patrick P. Frey
+ *
+ * This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+// Test of the built-in trace loggers with traced calls logged directly, checking the trace decoded
+#include "binaryTraceFormat.hpp"
+#include "binaryTraceLogger.hpp"
+#include "ringTraceLogger.hpp"
+#include "histogramTraceLogger.hpp"
+#include "asyncTraceLogger.hpp"
+#include "sampleTraceLogger.hpp"
+#include "traceLoggerWrapper.hpp"
+#include "strus/lib/error.hpp"
+#include "strus/errorBufferInterface.hpp"
+#include "strus/traceLoggerInterface.hpp"
+#include "strus/traceElement.hpp"
+#include "strus/base/configParser.hpp"
+#include "strus/base/local_ptr.hpp"
+#include "strus/base/fileio.hpp"
+#include "strus/base/thread.hpp"
+#include <string>
+#include <vector>
+#include <map>
+#include <stdexcept>
+#include <iostream>
+#include <cstdio>
+#include <cstring>
+#include <cstdlib>
+#include <unistd.h>
+
+#define MaxNofThreads 32
+
+static void printUsage()
+{
+	std::cerr << "testTraceLogger [options] <logger> [<config>]" << std::endl;
+	std::cerr << "Options:" << std::endl;
+	std::cerr << "       -n|--calls <N>     :make <N> rounds of traced calls in every thread (default 1)" << std::endl;
+	std::cerr << "       -T|--threads <N>   :make the traced calls in <N> threads concurrently (default 1)" << std::endl;
+	std::cerr << "       -C|--check <FILE>  :decode the binary or ring trace <FILE> written and check the calls and terminations" << std::endl;
+	std::cerr << "       -R|--rotate <N>    :make the traced calls <N> times in threads started anew, that exit after their calls (default 1)" << std::endl;
+	std::cerr << "       -d|--dropped       :calls may have been dropped by the logger, check only that the calls decoded are complete" << std::endl;
+	std::cerr << "       -w|--wrapped       :the ring trace logger overwrote the oldest records, check that the newest calls decoded are complete" << std::endl;
+	std::cerr << "       -s|--sleep <US>    :let every call of 'normalize' last at least <US> microseconds" << std::endl;
+	std::cerr << "       -B|--buckets       :check the mapping of latencies to the buckets of the histogram trace logger" << std::endl;
+	std::cerr << "       -P|--percentiles <FILE> :check the percentiles printed by the histogram trace logger to <FILE>" << std::endl;
+	std::cerr << "       -h|--help          :print this usage" << std::endl;
+	std::cerr << "<logger> is one of binary,ring,histogram,async,sample, wrappers get the logger they forward to with 'inner' in <config>" << std::endl;
+}
+
+static strus::TraceLoggerInterface* createTraceLogger( const std::string& name, const std::string& config, strus::ErrorBufferInterface* errorhnd);
+
+/// \brief Factory for the logger a wrapper forwards to, like the one of the module loader
+class TestInnerTraceLoggerFactory
+	:public strus::InnerTraceLoggerFactory
+{
+public:
+	TestInnerTraceLoggerFactory( const std::string& name_, strus::ErrorBufferInterface* errorhnd_)
+		:m_name(name_),m_errorhnd(errorhnd_){}
+
+	virtual strus::TraceLoggerInterface* create( const std::string& config) const
+	{
+		return createTraceLogger( m_name, config, m_errorhnd);
+	}
+
+private:
+	std::string m_name;
+	strus::ErrorBufferInterface* m_errorhnd;
+};
+
+static strus::TraceLoggerInterface* createTraceLogger( const std::string& name, const std::string& config, strus::ErrorBufferInterface* errorhnd)
+{
+	if (name == "binary") return strus::createTraceLogger_binary( config, errorhnd);
+	if (name == "ring") return strus::createTraceLogger_ring( config, errorhnd);
+	if (name == "histogram") return strus::createTraceLogger_histogram( config, errorhnd);
+	if (name == "async" || name == "sample")
+	{
+		std::string wrapperConfig( config);
+		std::string innerName;
+		if (!strus::extractStringFromConfigString( innerName, wrapperConfig, "inner", errorhnd))
+		{
+			throw std::runtime_error( "undefined 'inner' in config of trace logger wrapper");
+		}
+		TestInnerTraceLoggerFactory inner( innerName, errorhnd);
+		if (name == "async") return strus::createTraceLogger_async( wrapperConfig, inner, errorhnd);
+		return strus::createTraceLogger_sample( wrapperConfig, inner, errorhnd);
+	}
+	throw std::runtime_error( std::string( "unknown trace logger '") + name + "'");
+}
+
+// ... the names of a call are static strings like the ones of the trace objects:
+static const char* const g_className[] = {"TextProcessor", "NormalizerFunction", "NormalizerFunctionInstance"};
+static const char* const g_methodName[] = {"getNormalizer", "createInstance", "normalize"};
+enum {NofMethods=3, NofParameters=22};
+
+/// \brief Builder of the parameters of a termination
+struct ParameterBuilder
+{
+	std::vector<strus::TraceElement> ar;
+
+	void addVoid()
+	{
+		ar.push_back( strus::TraceElement());
+	}
+	void addBool( bool val)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeBool, val));
+	}
+	void addInt( long long val)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeInt, (strus::TraceElement::IntType)val));
+	}
+	void addUInt( unsigned long long val)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeUInt, (strus::TraceElement::UIntType)val));
+	}
+	void addDouble( double val)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeDouble, val));
+	}
+	void addString( const char* val)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeString, val, std::strlen( val)));
+	}
+	void addObject( unsigned long long objId)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeObject, (strus::TraceElement::UIntType)objId));
+	}
+	void openIndex( unsigned long long idx)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeOpenIndex, (strus::TraceElement::UIntType)idx));
+	}
+	void openTag( const char* name)
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeOpenTag, name, std::strlen( name)));
+	}
+	void close()
+	{
+		ar.push_back( strus::TraceElement( strus::TraceElement::TypeClose));
+	}
+};
+
+/// \brief Make the traced calls of one round: a call with a nested call and a call with parameters of every type of element
+/// \param[in] sleepMicroseconds minimum duration of the call with parameters of every type
+static void makeTracedCalls( strus::TraceLoggerInterface* logger, unsigned int round, unsigned int sleepMicroseconds)
+{
+	strus::TraceLogRecordHandle outer = logger->logMethodCall( g_className[0], g_methodName[0], 1);
+	strus::TraceLogRecordHandle inner = logger->logMethodCall( g_className[1], g_methodName[1], 2);
+	ParameterBuilder innerParam;
+	innerParam.addObject( 3);
+	logger->logMethodTermination( inner, innerParam.ar);
+	ParameterBuilder outerParam;
+	outerParam.addString( "stem");
+	outerParam.addObject( 2);
+	logger->logMethodTermination( outer, outerParam.ar);
+
+	strus::TraceLogRecordHandle call = logger->logMethodCall( g_className[2], g_methodName[2], 3);
+	ParameterBuilder param;
+	param.addVoid();
+	param.addBool( true);
+	param.addInt( -1);
+	param.addInt( -300);
+	param.addInt( 9223372036854775807LL);
+	param.addUInt( round);
+	param.addUInt( 18446744073709551615ULL);
+	param.addDouble( -0.125);
+	param.addDouble( 2.5e+20);
+	param.addString( "run \"quoted\"\ttab\nline");
+	param.openTag( "args");
+	param.openIndex( 0);
+	param.addString( "en");
+	param.close();
+	param.openIndex( 1);
+	param.openTag( "depth");
+	param.addInt( -64);
+	param.addDouble( 0.5);
+	param.close();
+	param.close();
+	param.close();
+	param.addObject( 3);
+	if (sleepMicroseconds) ::usleep( sleepMicroseconds);
+	logger->logMethodTermination( call, param.ar);
+}
+
+/// \brief Thread making traced calls
+struct TracedCallWorker
+{
+	strus::TraceLoggerInterface* logger;
+	unsigned int nofRounds;
+	unsigned int sleepMicroseconds;
+
+	TracedCallWorker( strus::TraceLoggerInterface* logger_, unsigned int nofRounds_, unsigned int sleepMicroseconds_)
+		:logger(logger_),nofRounds(nofRounds_),sleepMicroseconds(sleepMicroseconds_){}
+	TracedCallWorker( const TracedCallWorker& o)
+		:logger(o.logger),nofRounds(o.nofRounds),sleepMicroseconds(o.sleepMicroseconds){}
+
+	void operator()()
+	{
+		for (unsigned int ri=0; ri < nofRounds; ++ri)
+		{
+			makeTracedCalls( logger, ri, sleepMicroseconds);
+		}
+	}
+};
+
+/// \brief Get the index of the method of a call decoded or NofMethods if unknown
+static unsigned int methodIndex( const strus::binarytrace::Record& record)
+{
+	for (unsigned int mi=0; mi < NofMethods; ++mi)
+	{
+		if (record.className == g_className[ mi] && record.methodName == g_methodName[ mi]) return mi;
+	}
+	return NofMethods;
+}
+
+/// \brief Decode a trace written and check that the calls and terminations decoded match the ones logged
+/// \param[in] nofRounds number of rounds of traced calls made
+/// \param[in] dropped true if calls may have been dropped
+/// \param[in] wrapped true if the oldest records have been overwritten by a ring trace logger
+static bool checkTrace( const std::string& path, unsigned int nofRounds, bool dropped, bool wrapped)
+{
+	std::string content;
+	int ec = strus::readFile( path, content);
+	if (ec)
+	{
+		std::cerr << "failed to read trace file '" << path << "': " << std::strerror( ec) << std::endl;
+		return false;
+	}
+	if (strus::binarytrace::isRingTrace( content))
+	{
+		unsigned long long nofDropped = 0;
+		content = strus::binarytrace::linearizeRingTrace( content, nofDropped);
+		if (nofDropped)
+		{
+			std::cerr << "ring trace logger dropped " << nofDropped << " records" << std::endl;
+			return false;
+		}
+	}
+	strus::binarytrace::Reader reader( content);
+	strus::binarytrace::Record record;
+	std::map<unsigned long long,unsigned int> running;
+	unsigned int nofCalls = 0;
+	unsigned int nofTerminations = 0;
+	unsigned long long maxHandle = 0;
+	while (reader.next( record))
+	{
+		if (record.type == strus::binarytrace::RecordCall)
+		{
+			unsigned int mi = methodIndex( record);
+			if (mi == NofMethods || record.objId != mi+1)
+			{
+				std::cerr << "unexpected call " << record.className << "::" << record.methodName << " of object " << record.objId << std::endl;
+				return false;
+			}
+			if (!running.insert( std::pair<unsigned long long,unsigned int>( record.handle, mi)).second)
+			{
+				std::cerr << "duplicate handle " << record.handle << " of call" << std::endl;
+				return false;
+			}
+			if (record.handle > maxHandle) maxHandle = record.handle;
+			++nofCalls;
+		}
+		else
+		{
+			std::map<unsigned long long,unsigned int>::iterator ri = running.find( record.handle);
+			if (ri == running.end())
+			{
+				// ... the call of a termination may have been overwritten, but the terminations of the calls decoded are never
+				if (wrapped) continue;
+				std::cerr << "termination with handle " << record.handle << " without call" << std::endl;
+				return false;
+			}
+			static const std::size_t nofParameters[ NofMethods] = {2, 1, NofParameters};
+			if (record.parameter.size() != nofParameters[ ri->second])
+			{
+				std::cerr << "termination of " << g_methodName[ ri->second] << " with " << record.parameter.size() << " parameters instead of " << nofParameters[ ri->second] << std::endl;
+				return false;
+			}
+			running.erase( ri);
+			++nofTerminations;
+		}
+	}
+	if (reader.truncated())
+	{
+		std::cerr << "last record of the trace is truncated" << std::endl;
+		return false;
+	}
+	if (!running.empty())
+	{
+		std::cerr << running.size() << " calls decoded without termination" << std::endl;
+		return false;
+	}
+	std::cerr << "decoded " << nofCalls << " calls and " << nofTerminations << " terminations" << std::endl;
+	if (!dropped && !wrapped && nofCalls != nofRounds * NofMethods)
+	{
+		std::cerr << "expected " << (nofRounds * NofMethods) << " calls" << std::endl;
+		return false;
+	}
+	if (wrapped)
+	{
+		if (nofCalls >= nofRounds * NofMethods)
+		{
+			std::cerr << "expected the oldest of " << (nofRounds * NofMethods) << " calls to be overwritten" << std::endl;
+			return false;
+		}
+		if (maxHandle != nofRounds * NofMethods)
+		{
+			std::cerr << "expected the newest call with handle " << (nofRounds * NofMethods) << " to be decoded instead of " << maxHandle << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+/// \brief Check that every latency is mapped to a bucket whose value exceeds it by at most 6.25% (exact below 16) and that the buckets are ordered like the latencies
+static bool checkHistogramBuckets()
+{
+	enum {SubBuckets = (1 << strus::HistogramTraceLogger::SubBucketBits)};
+	const unsigned long long maxValue = (1ULL << strus::HistogramTraceLogger::MaxValueBits) - 1;
+	std::vector<unsigned long long> values;
+	for (unsigned long long value=0; value < 4096; ++value)
+	{
+		values.push_back( value);
+	}
+	for (unsigned int bi=12; bi < strus::HistogramTraceLogger::MaxValueBits; ++bi)
+	{
+		values.push_back( (1ULL << bi) - 1);
+		values.push_back( 1ULL << bi);
+		values.push_back( (1ULL << bi) + 1);
+	}
+	// ... pseudo random latencies spread over all magnitudes in ascending order
+	unsigned long long seed = 1;
+	for (unsigned int ri=0; ri < 100000; ++ri)
+	{
+		seed = seed * 6364136223846793005ULL + 1442695040888963407ULL;
+		unsigned int magnitude = 12 + ri * (strus::HistogramTraceLogger::MaxValueBits - 12) / 100000;
+		values.push_back( (1ULL << magnitude) + (seed >> 24) % (1ULL << magnitude));
+	}
+	unsigned int prevBucket = 0;
+	unsigned long long prevValue = 0;
+	std::vector<unsigned long long>::const_iterator vi = values.begin(), ve = values.end();
+	for (; vi != ve; ++vi)
+	{
+		unsigned long long value = *vi < maxValue ? *vi : maxValue;
+		unsigned int bucket = strus::HistogramTraceLogger::bucketIndex( value);
+		if (bucket >= strus::HistogramTraceLogger::NofBuckets)
+		{
+			std::cerr << "latency " << value << " mapped to bucket " << bucket << " out of range" << std::endl;
+			return false;
+		}
+		unsigned long long bucketValue = strus::HistogramTraceLogger::bucketValue( bucket);
+		if (bucketValue < value || (bucketValue - value) * SubBuckets > value)
+		{
+			std::cerr << "latency " << value << " mapped to bucket " << bucket << " with value " << bucketValue << ", relative error above 6.25%" << std::endl;
+			return false;
+		}
+		if (value < (unsigned long long)SubBuckets && bucketValue != value)
+		{
+			std::cerr << "latency " << value << " not recorded exactly" << std::endl;
+			return false;
+		}
+		if (value >= prevValue && bucket < prevBucket)
+		{
+			std::cerr << "latency " << value << " mapped to bucket " << bucket << " before the bucket " << prevBucket << " of the smaller latency " << prevValue << std::endl;
+			return false;
+		}
+		prevBucket = bucket;
+		prevValue = value;
+	}
+	if (strus::HistogramTraceLogger::bucketIndex( maxValue + 1) != strus::HistogramTraceLogger::NofBuckets-1
+	||	strus::HistogramTraceLogger::bucketValue( strus::HistogramTraceLogger::NofBuckets-1) != maxValue)
+	{
+		std::cerr << "latencies above the maximum not recorded in the last bucket" << std::endl;
+		return false;
+	}
+	std::cerr << "checked " << values.size() << " latencies" << std::endl;
+	return true;
+}
+
+/// \brief Check the last percentiles printed by a histogram trace logger to a file
+/// \param[in] nofCalls number of calls made per method
+/// \param[in] sleepMicroseconds minimum duration of the calls of 'normalize'
+static bool checkPercentiles( const std::string& path, unsigned int nofCalls, unsigned int sleepMicroseconds)
+{
+	std::string content;
+	int ec = strus::readFile( path, content);
+	if (ec)
+	{
+		std::cerr << "failed to read percentiles file '" << path << "': " << std::strerror( ec) << std::endl;
+		return false;
+	}
+	// ... the percentiles are printed several times with an interval, the last print covers all calls
+	std::size_t start = content.rfind( "# latency");
+	if (start == std::string::npos)
+	{
+		std::cerr << "no percentiles printed to '" << path << "'" << std::endl;
+		return false;
+	}
+	std::map<std::string,std::vector<double> > lines;
+	char const* li = content.c_str() + start;
+	while (*li)
+	{
+		const char* le = std::strchr( li, '\n');
+		std::string line( li, le ? le - li : std::strlen( li));
+		li += line.size() + (le ? 1 : 0);
+		if (line.empty() || line[0] == '#') continue;
+		std::size_t tab = line.find( '\t');
+		if (tab == std::string::npos)
+		{
+			std::cerr << "bad line in percentiles: " << line << std::endl;
+			return false;
+		}
+		std::vector<double>& values = lines[ line.substr( 0, tab)];
+		const char* vi = line.c_str() + tab;
+		while (*vi == '\t')
+		{
+			char* ve;
+			values.push_back( std::strtod( vi+1, &ve));
+			vi = ve;
+		}
+		// ... calls, mean, p50, p90, p99, p99.9, max
+		if (*vi || values.size() != 7)
+		{
+			std::cerr << "bad line in percentiles: " << line << std::endl;
+			return false;
+		}
+	}
+	for (unsigned int mi=0; mi < NofMethods; ++mi)
+	{
+		std::string name = std::string( g_className[ mi]) + "::" + g_methodName[ mi];
+		std::map<std::string,std::vector<double> >::const_iterator pi = lines.find( name);
+		if (pi == lines.end())
+		{
+			std::cerr << "no percentiles printed for " << name << std::endl;
+			return false;
+		}
+		const std::vector<double>& values = pi->second;
+		std::cerr << name << " calls " << values[0] << " mean " << values[1] << " p50 " << values[2] << " max " << values[6] << std::endl;
+		if (values[0] != (double)nofCalls)
+		{
+			std::cerr << "expected " << nofCalls << " calls of " << name << std::endl;
+			return false;
+		}
+		for (unsigned int vi=3; vi < 7; ++vi)
+		{
+			if (values[ vi] < values[ vi-1])
+			{
+				std::cerr << "percentiles of " << name << " not ascending" << std::endl;
+				return false;
+			}
+		}
+		if (values[1] > values[6])
+		{
+			std::cerr << "mean latency of " << name << " above the maximum" << std::endl;
+			return false;
+		}
+		// ... the value of a bucket is its highest latency, so no percentile is below the latency of the fastest call
+		if (mi == NofMethods-1 && values[2] < (double)sleepMicroseconds)
+		{
+			std::cerr << "median latency of " << name << " below the duration of the calls of " << sleepMicroseconds << " microseconds" << std::endl;
+			return false;
+		}
+	}
+	return true;
+}
+
+int main( int argc, const char** argv)
+{
+	try
+	{
+		strus::local_ptr<strus::ErrorBufferInterface> errorbuf( strus::createErrorBuffer_standard( stderr, MaxNofThreads+1, NULL));
+		if (!errorbuf.get())
+		{
+			std::cerr << "error creating error buffer" << std::endl;
+			return -1;
+		}
+		unsigned int nofRounds = 1;
+		int nofThreads = 1;
+		int nofRotations = 1;
+		const char* checkFile = NULL;
+		bool dropped = false;
+		bool wrapped = false;
+		unsigned int sleepMicroseconds = 0;
+		bool checkBuckets = false;
+		const char* percentilesFile = NULL;
+		int argi = 1;
+		for (; argi < argc && argv[argi][0] == '-'; ++argi)
+		{
+			if (0==std::strcmp( argv[argi], "--calls") || 0==std::strcmp( argv[argi], "-n"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --calls / -n");
+				nofRounds = std::atoi( argv[argi]);
+			}
+			else if (0==std::strcmp( argv[argi], "--threads") || 0==std::strcmp( argv[argi], "-T"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --threads / -T");
+				nofThreads = std::atoi( argv[argi]);
+				if (nofThreads <= 0 || nofThreads > MaxNofThreads) throw std::runtime_error( "number of threads out of range in option --threads / -T");
+			}
+			else if (0==std::strcmp( argv[argi], "--rotate") || 0==std::strcmp( argv[argi], "-R"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --rotate / -R");
+				nofRotations = std::atoi( argv[argi]);
+				if (nofRotations <= 0) throw std::runtime_error( "number of rotations out of range in option --rotate / -R");
+			}
+			else if (0==std::strcmp( argv[argi], "--check") || 0==std::strcmp( argv[argi], "-C"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --check / -C");
+				checkFile = argv[argi];
+			}
+			else if (0==std::strcmp( argv[argi], "--dropped") || 0==std::strcmp( argv[argi], "-d"))
+			{
+				dropped = true;
+			}
+			else if (0==std::strcmp( argv[argi], "--wrapped") || 0==std::strcmp( argv[argi], "-w"))
+			{
+				wrapped = true;
+			}
+			else if (0==std::strcmp( argv[argi], "--sleep") || 0==std::strcmp( argv[argi], "-s"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --sleep / -s");
+				sleepMicroseconds = std::atoi( argv[argi]);
+			}
+			else if (0==std::strcmp( argv[argi], "--buckets") || 0==std::strcmp( argv[argi], "-B"))
+			{
+				checkBuckets = true;
+			}
+			else if (0==std::strcmp( argv[argi], "--percentiles") || 0==std::strcmp( argv[argi], "-P"))
+			{
+				if (!argv[++argi]) throw std::runtime_error( "missing argument for option --percentiles / -P");
+				percentilesFile = argv[argi];
+			}
+			else if (0==std::strcmp( argv[argi], "--help") || 0==std::strcmp( argv[argi], "-h"))
+			{
+				printUsage();
+				exit( 0);
+			}
+			else if (0==std::strcmp( argv[argi], "--"))
+			{
+				argi++;
+				break;
+			}
+			else
+			{
+				std::cerr << "Unknown option " << argv[argi] << std::endl;
+				printUsage();
+				exit( 1);
+			}
+		}
+		if (argi == argc || argi + 2 < argc)
+		{
+			std::cerr << "Expected logger name and optional configuration as arguments" << std::endl;
+			printUsage();
+			exit( 1);
+		}
+		if (checkBuckets)
+		{
+			std::cerr << "check the buckets of the histogram trace logger" << std::endl;
+			if (!checkHistogramBuckets()) return -1;
+		}
+		std::string loggerName( argv[ argi]);
+		std::string config( argi + 1 < argc ? argv[ argi+1] : "");
+		std::cerr << "create trace logger '" << loggerName << "' with config '" << config << "'" << std::endl;
+		strus::local_ptr<strus::TraceLoggerInterface> logger( createTraceLogger( loggerName, config, errorbuf.get()));
+		if (!logger.get())
+		{
+			std::cerr << "failed: " << errorbuf->fetchError() << std::endl;
+			return -1;
+		}
+		std::cerr << "make " << nofRounds << " rounds of traced calls in " << nofThreads << " threads " << nofRotations << " times" << std::endl;
+		if (nofThreads == 1 && nofRotations == 1)
+		{
+			TracedCallWorker( logger.get(), nofRounds, sleepMicroseconds)();
+		}
+		else for (int ri=0; ri < nofRotations; ++ri)
+		{
+			std::vector<strus::thread*> threads;
+			for (int ti=0; ti < nofThreads; ++ti)
+			{
+				threads.push_back( new strus::thread( TracedCallWorker( logger.get(), nofRounds, sleepMicroseconds)));
+			}
+			std::vector<strus::thread*>::iterator ti = threads.begin(), te = threads.end();
+			for (; ti != te; ++ti)
+			{
+				(*ti)->join();
+				delete *ti;
+			}
+		}
+		if (!logger->close())
+		{
+			std::cerr << "failed to close trace logger: " << errorbuf->fetchError() << std::endl;
+			return -1;
+		}
+		logger.reset();
+		if (checkFile)
+		{
+			std::cerr << "check trace file '" << checkFile << "'" << std::endl;
+			if (!checkTrace( checkFile, nofRounds * nofThreads * nofRotations, dropped, wrapped)) return -1;
+		}
+		if (percentilesFile)
+		{
+			std::cerr << "check percentiles file '" << percentilesFile << "'" << std::endl;
+			if (!checkPercentiles( percentilesFile, nofRounds * nofThreads * nofRotations, sleepMicroseconds)) return -1;
+		}
+		if (errorbuf->hasError())
+		{
+			std::cerr << "error testing trace logger: " << errorbuf->fetchError() << std::endl;
+			return -1;
+		}
+		std::cerr << "ok." << std::endl;
+		return 0;
+	}
+	catch (const std::exception& err)
+	{
+		std::cerr << "error testing trace logger: " << err.what() << std::endl;
+	}
+	return -1;
+}
+